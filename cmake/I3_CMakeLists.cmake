@@ -59,12 +59,19 @@ set (PROPOSAL_SRC_FILES
     ${PROJECT_SOURCE_DIR}/private/PROPOSAL/geometry/Cylinder.cxx
     ${PROJECT_SOURCE_DIR}/private/PROPOSAL/geometry/Geometry.cxx
     ${PROJECT_SOURCE_DIR}/private/PROPOSAL/geometry/GeometryFactory.cxx
+    ${PROJECT_SOURCE_DIR}/private/PROPOSAL/geometry/GeometryIndex.cxx
     ${PROJECT_SOURCE_DIR}/private/PROPOSAL/geometry/Sphere.cxx
+    ${PROJECT_SOURCE_DIR}/private/PROPOSAL/math/AliasTable.cxx
+    ${PROJECT_SOURCE_DIR}/private/PROPOSAL/math/FusedInterpolant.cxx
     ${PROJECT_SOURCE_DIR}/private/PROPOSAL/math/Integral.cxx
     ${PROJECT_SOURCE_DIR}/private/PROPOSAL/math/Interpolant.cxx
     ${PROJECT_SOURCE_DIR}/private/PROPOSAL/math/MathMethods.cxx
+    ${PROJECT_SOURCE_DIR}/private/PROPOSAL/math/QuantileTable.cxx
     ${PROJECT_SOURCE_DIR}/private/PROPOSAL/math/InterpolantBuilder.cxx
     ${PROJECT_SOURCE_DIR}/private/PROPOSAL/math/RandomGenerator.cxx
+    ${PROJECT_SOURCE_DIR}/private/PROPOSAL/math/TableFile.cxx
+    ${PROJECT_SOURCE_DIR}/private/PROPOSAL/math/TablePack.cxx
+    ${PROJECT_SOURCE_DIR}/private/PROPOSAL/math/TableScheduler.cxx
     ${PROJECT_SOURCE_DIR}/private/PROPOSAL/math/Vector3D.cxx
     ${PROJECT_SOURCE_DIR}/private/PROPOSAL/medium/Components.cxx
     ${PROJECT_SOURCE_DIR}/private/PROPOSAL/medium/Medium.cxx
@@ -37,6 +37,8 @@ OPTION(ADD_PYTHON "Choose to compile the python wrapper library" ON)
 OPTION(ADD_ROOT "Choose to compile ROOT examples." OFF)
 OPTION(ADD_PERFORMANCE_TEST "Choose to compile the performace test source." OFF)
 OPTION(ADD_CPPEXAMPLE "Choose to compile Cpp example." ON)
+OPTION(ADD_TABLE_PACK_TOOL "Choose to compile the tool to merge and prune table packs." ON)
+OPTION(ADD_TABLE_CREATION "Choose to compile the tool to build the interpolation tables in advance." ON)
 
 
 #################################################################
@@ -99,6 +101,14 @@ add_subdirectory("vendor/log4cplus/log4cplus")
 target_link_libraries(PROPOSAL PRIVATE log4cplus)
 target_compile_definitions(PROPOSAL PRIVATE -DLOG4CPLUS_SUPPORT=1)
 
+#################################################################
+#################           Threads       #######################
+#################################################################
+
+set(THREADS_PREFER_PTHREAD_FLAG ON)
+find_package(Threads REQUIRED)
+target_link_libraries(PROPOSAL PUBLIC Threads::Threads)
+
 #################################################################
 #################           Executables        ##################
 #################################################################
@@ -116,6 +126,20 @@ IF(ADD_PERFORMANCE_TEST)
     target_link_libraries(performance_test PRIVATE PROPOSAL)
 ENDIF(ADD_PERFORMANCE_TEST)
 
+IF(ADD_TABLE_PACK_TOOL)
+    add_executable(table_pack private/test/table_pack.cxx)
+    target_compile_options(table_pack PRIVATE -Wall -Wextra -Wnarrowing -Wpedantic -fdiagnostics-show-option)
+    target_link_libraries(table_pack PRIVATE PROPOSAL)
+    install(TARGETS table_pack RUNTIME DESTINATION ${CMAKE_INSTALL_BINDIR})
+ENDIF(ADD_TABLE_PACK_TOOL)
+
+IF(ADD_TABLE_CREATION)
+    add_executable(table_creation private/test/table_creation.cxx)
+    target_compile_options(table_creation PRIVATE -Wall -Wextra -Wnarrowing -Wpedantic -fdiagnostics-show-option)
+    target_link_libraries(table_creation PRIVATE PROPOSAL)
+    install(TARGETS table_creation RUNTIME DESTINATION ${CMAKE_INSTALL_BINDIR})
+ENDIF(ADD_TABLE_CREATION)
+
 #################################################################
 #################           Tests        ########################
 #################################################################
@@ -5,6 +5,8 @@
 #include "PROPOSAL/Secondaries.h"
 #include "pyBindings.h"
 
+#include <pybind11/numpy.h>
+
 #define PARTICLE_DEF(module, cls)                                                    \
     py::class_<cls##Def, ParticleDef, std::shared_ptr<cls##Def>>(module, #cls "Def") \
         .def(py::init<>());                                                          \
@@ -261,8 +263,38 @@ void init_particle(py::module& m) {
                 Propagated distance of primary particle.
             )pbdoc");
 
-    py::class_<Secondaries, std::shared_ptr<Secondaries>>(m_sub, "Secondaries",
-            R"pbdoc(List of secondaries)pbdoc")
+    py::class_<Secondaries, std::shared_ptr<Secondaries>> secondaries(m_sub, "Secondaries",
+            R"pbdoc(List of secondaries)pbdoc");
+
+    py::enum_<Secondaries::Column>(secondaries, "Column")
+        .value("x", Secondaries::X)
+        .value("y", Secondaries::Y)
+        .value("z", Secondaries::Z)
+        .value("direction_x", Secondaries::DirectionX)
+        .value("direction_y", Secondaries::DirectionY)
+        .value("direction_z", Secondaries::DirectionZ)
+        .value("energy", Secondaries::Energy)
+        .value("parent_particle_energy", Secondaries::ParentParticleEnergy)
+        .value("time", Secondaries::Time)
+        .value("propagated_distance", Secondaries::PropagatedDistance);
+
+    secondaries
+        .def("column", [](py::object self, Secondaries::Column column) {
+                ColumnView<double> view = self.cast<Secondaries&>().GetColumn(column);
+                py::array_t<double> array(view.size(), view.data(), self);
+                array.attr("setflags")(py::arg("write") = false);
+                return array;
+            }, py::arg("column"),
+            R"pbdoc(
+                Read only numpy view on one column without copying it. The
+                view keeps the secondaries alive.
+            )pbdoc")
+        .def_property_readonly("types", [](py::object self) {
+                ColumnView<int> view = self.cast<Secondaries&>().GetTypeColumn();
+                py::array_t<int> array(view.size(), view.data(), self);
+                array.attr("setflags")(py::arg("write") = false);
+                return array;
+            })
         .def("Query", overload_cast_<const int&>()(&Secondaries::Query, py::const_), py::arg("Interaction"))
         .def("Query", overload_cast_<const std::string&>()(&Secondaries::Query, py::const_), py::arg("Interaction"))
         .def("decay", &Secondaries::DoDecay)
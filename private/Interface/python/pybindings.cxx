@@ -177,11 +177,40 @@ PYBIND11_MODULE(proposal, m)
                 number of nodes used by evaluation of propagation
                 integrals. Default: xxx
             )pbdoc")
+        .def_readwrite("quantile_accuracy", &InterpolationDef::quantile_accuracy,
+            R"pbdoc(
+                accuracy of the tables used to sample the size of stochastic
+                losses and the Moliere scattering angles, as an error of
+                their cumulative distributions. The tables are built when the propagator is set up
+                and are not stored on disk. A value of 0 disables them, the
+                losses and angles are then sampled exactly. Default: 0
+            )pbdoc")
+        .def_readwrite("channel_accuracy", &InterpolationDef::channel_accuracy,
+            R"pbdoc(
+                relative accuracy of the probabilities of the interaction
+                types in the tables used to choose the interaction. Energy
+                bins, in which a probability differs more, are calculated
+                exactly. The tables are built when the propagator is set up.
+                A value of 0 disables them. Default: 0
+            )pbdoc")
+        .def_readwrite("number_of_threads", &InterpolationDef::number_of_threads,
+            R"pbdoc(
+                number of threads used to build the interpolation tables.
+                The tables do not depend on it. A value of 0 uses all
+                hardware threads. Default: 1
+            )pbdoc")
         .def_readwrite("do_binary_tables", &InterpolationDef::do_binary_tables,
             R"pbdoc(
                 Should binary tables be used to store the data.
                 This will increase performance, but are not readable for a
-                crosscheck by human. Default: xxx
+                crosscheck by human. Binary tables are mapped into memory
+                and shared by the processes reading them. Default: xxx
+            )pbdoc")
+        .def_readwrite("do_table_pack", &InterpolationDef::do_table_pack,
+            R"pbdoc(
+                Should the binary tables of a path be stored in one pack
+                file (tables.pack) instead of one file per table.
+                Default: False
             )pbdoc")
         .def_readwrite("just_use_readonly_path",
             &InterpolationDef::just_use_readonly_path,
@@ -452,7 +481,8 @@ PYBIND11_MODULE(proposal, m)
             py::arg("initial_energy"), py::arg("distance"))
         .def("make_stochastic_loss", &Sector::MakeStochasticLoss,
             py::arg("minimal_energy"))
-        .def("propagate", &Sector::Propagate,
+        .def("propagate",
+            (Secondaries (Sector::*)(const DynamicData&, double, double)) &Sector::Propagate,
             py::arg("particle_condition"), py::arg("max_distance"), py::arg("min_energy"));
 
     // ---------------------------------------------------------------------
@@ -469,6 +499,15 @@ PYBIND11_MODULE(proposal, m)
         .def_static(
             "get", &RandomGenerator::Get, py::return_value_policy::reference);
 
+    py::class_<RandomStream, std::shared_ptr<RandomStream>>(m, "RandomStream")
+        .def(py::init<uint64_t, uint64_t>(), py::arg("seed") = 0,
+            py::arg("event_id") = 0)
+        .def("random_double", &RandomStream::RandomDouble)
+        .def("reset", &RandomStream::Reset, py::arg("seed"),
+            py::arg("event_id"))
+        .def_property_readonly("seed", &RandomStream::GetSeed)
+        .def_property_readonly("event_id", &RandomStream::GetEventId);
+
     // --------------------------------------------------------------------- //
     // Propagator
     // --------------------------------------------------------------------- //
@@ -496,7 +535,7 @@ PYBIND11_MODULE(proposal, m)
             py::arg("detector"))
         .def(py::init<const ParticleDef&, const std::string&>(),
             py::arg("particle_def"), py::arg("config_file"))
-        .def("propagate", &Propagator::Propagate,
+        .def("propagate", (Secondaries (Propagator::*)(const DynamicData&, double, double)) &Propagator::Propagate,
             py::arg("particle_condition"),
             py::arg("max_distance_cm") = 1e20,
             py::arg("minimal_energy") = 0.,
@@ -552,6 +591,60 @@ PYBIND11_MODULE(proposal, m)
                     will be calculated and the produced secondary particles
                     returned.
                 )pbdoc")
+        .def("propagate",
+            (Secondaries (Propagator::*)(const DynamicData&, RandomStream&, double, double)) &Propagator::Propagate,
+            py::arg("particle_condition"),
+            py::arg("random_stream"),
+            py::arg("max_distance_cm") = 1e20,
+            py::arg("minimal_energy") = 0.,
+            R"pbdoc(
+                    Propagate a particle drawing all random numbers from the
+                    given stream. A stream keyed by (seed, event_id) makes the
+                    propagation of every event reproducible on its own.
+                )pbdoc")
+        .def("propagate",
+            (DynamicData (Propagator::*)(const DynamicData&, const LossFunctionSink::Function&, double, double)) &Propagator::Propagate,
+            py::arg("particle_condition"),
+            py::arg("loss_sink"),
+            py::arg("max_distance_cm") = 1e20,
+            py::arg("minimal_energy") = 0.,
+            R"pbdoc(
+                    Propagate a particle and call loss_sink with every loss
+                    instead of collecting them in a Secondaries object.
+
+                    Returns:
+                        DynamicData: the final state of the particle.
+                )pbdoc")
+        .def("propagate_batch", &Propagator::PropagateBatch,
+            py::arg("particle_conditions"),
+            py::arg("n_threads") = 0,
+            py::arg("seed") = 0,
+            py::arg("first_event_id") = 0,
+            py::arg("max_distance_cm") = 1e20,
+            py::arg("minimal_energy") = 0.,
+            py::call_guard<py::gil_scoped_release>(),
+            R"pbdoc(
+                    Propagate a list of particles on several threads. Event i
+                    uses the random stream (seed, first_event_id + i), so the
+                    results do not depend on the number of threads.
+
+                    Returns:
+                        list: the secondaries of every particle in input order.
+                )pbdoc")
+        .def("propagate_wavefront", &Propagator::PropagateWavefront,
+            py::arg("particle_conditions"),
+            py::arg("seed") = 0,
+            py::arg("first_event_id") = 0,
+            py::arg("max_distance_cm") = 1e20,
+            py::arg("minimal_energy") = 0.,
+            R"pbdoc(
+                    Propagate a list of particles together, one step at a time
+                    for all particles inside the same sector. The results are
+                    identical to propagate_batch with the same seed.
+
+                    Returns:
+                        list: the secondaries of every particle in input order.
+                )pbdoc")
         .def_property_readonly("particle_def", &Propagator::GetParticleDef,
             R"pbdoc(
                     Get the internal particle definition to use its properties.
@@ -572,6 +665,12 @@ PYBIND11_MODULE(proposal, m)
 
                     Returns:
                         Geometry: the geometry of the detector.
+                )pbdoc")
+        .def_property("crossing_plan", &Propagator::GetCrossingPlan, &Propagator::SetCrossingPlan,
+            R"pbdoc(
+                    Trace straight tracks once through all sectors instead of
+                    looking up the sector at every step. Tracks fall back to
+                    the lookup as soon as the particle is deflected.
                 )pbdoc");
 
     // ---------------------------------------------------------------------
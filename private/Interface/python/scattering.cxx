@@ -51,7 +51,8 @@ void init_scattering(py::module& m) {
 
     py::class_<ScatteringMoliere, std::shared_ptr<ScatteringMoliere>,
                Scattering>(m_sub, "Moliere")
-        .def(py::init<const ParticleDef&, std::shared_ptr<const Medium>>());
+        .def(py::init<const ParticleDef&, std::shared_ptr<const Medium>>())
+        .def(py::init<const ParticleDef&, std::shared_ptr<const Medium>, InterpolationDef>());
 
     py::class_<ScatteringHighlandIntegral,
                std::shared_ptr<ScatteringHighlandIntegral>, Scattering>(
@@ -6,8 +6,12 @@
 
 // #include <cmath>
 
+#include <algorithm>
+#include <exception>
 #include <fstream>
 #include <memory>
+#include <mutex>
+#include <thread>
 
 #include "PROPOSAL/Propagator.h"
 #include "PROPOSAL/medium/Medium.h"
@@ -24,6 +28,7 @@
 #include "PROPOSAL/Logging.h"
 #include "PROPOSAL/math/MathMethods.h"
 #include "PROPOSAL/math/RandomGenerator.h"
+#include "PROPOSAL/math/TableScheduler.h"
 
 using namespace PROPOSAL;
 
@@ -44,6 +49,117 @@ const double Propagator::global_cont_behind_ = false;
 const bool Propagator::do_interpolation_ = true;
 const bool Propagator::uniform_ = true;
 
+namespace {
+
+// ------------------------------------------------------------------------- //
+// Configuration of the propagator from a json file
+// ------------------------------------------------------------------------- //
+nlohmann::json ReadConfigFile(const std::string& config_file)
+{
+    nlohmann::json json_config;
+    try {
+        std::string expanded_config_file_path
+            = Helper::ResolvePath(config_file, true);
+        std::ifstream infilestream(expanded_config_file_path);
+        infilestream >> json_config;
+    } catch (const nlohmann::json::parse_error& e) {
+        log_fatal("Unable parse \"%s\" as json file", config_file.c_str());
+    }
+    return json_config;
+}
+
+// ------------------------------------------------------------------------- //
+// Range of event indices owned by one worker of PropagateBatch. The owner
+// takes events from the front, thieves take them from the back.
+// ------------------------------------------------------------------------- //
+struct EventRange
+{
+    std::mutex mutex;
+    size_t begin = 0;
+    size_t end = 0;
+};
+
+bool PopEvent(EventRange& range, size_t& event)
+{
+    std::lock_guard<std::mutex> lock(range.mutex);
+    if (range.begin >= range.end)
+        return false;
+
+    event = range.begin++;
+    return true;
+}
+
+// Move the back half of the largest foreign range to the own range
+bool StealEvents(std::vector<EventRange>& ranges, size_t thief)
+{
+    while (true) {
+        size_t victim = ranges.size();
+        size_t max_remaining = 0;
+        for (size_t i = 0; i < ranges.size(); ++i) {
+            if (i == thief)
+                continue;
+            std::lock_guard<std::mutex> lock(ranges[i].mutex);
+            size_t remaining = ranges[i].end - ranges[i].begin;
+            if (remaining > max_remaining) {
+                max_remaining = remaining;
+                victim = i;
+            }
+        }
+
+        if (victim == ranges.size())
+            return false;
+
+        size_t begin, end;
+        {
+            std::lock_guard<std::mutex> lock(ranges[victim].mutex);
+            size_t remaining = ranges[victim].end - ranges[victim].begin;
+            if (remaining == 0)
+                continue; // the victim finished meanwhile, look again
+
+            end = ranges[victim].end;
+            begin = end - (remaining + 1) / 2;
+            ranges[victim].end = begin;
+        }
+
+        std::lock_guard<std::mutex> lock(ranges[thief].mutex);
+        ranges[thief].begin = begin;
+        ranges[thief].end = end;
+        return true;
+    }
+}
+
+// ------------------------------------------------------------------------- //
+// The tables of different sectors are independent, so the sectors are built
+// in parallel. The order of the definitions is kept.
+// ------------------------------------------------------------------------- //
+void CreateSectors(std::vector<Sector*>& sectors,
+    const ParticleDef& particle_def,
+    const std::vector<Sector::Definition>& sector_defs,
+    const InterpolationDef& interpolation_def)
+{
+    size_t offset = sectors.size();
+    sectors.resize(offset + sector_defs.size(), NULL);
+
+    TableScheduler scheduler(interpolation_def.number_of_threads);
+    for (size_t i = 0; i < sector_defs.size(); ++i) {
+        scheduler.Add([&, i]() {
+            sectors[offset + i] = new Sector(particle_def, sector_defs[i], interpolation_def);
+        });
+    }
+
+    try {
+        scheduler.Run();
+    } catch (...) {
+        for (size_t i = offset; i < sectors.size(); ++i) {
+            delete sectors[i];
+        }
+        sectors.resize(offset);
+        throw;
+    }
+}
+
+} // namespace
+
 // ------------------------------------------------------------------------- //
 // Constructors & destructor
 // ------------------------------------------------------------------------- //
@@ -69,6 +185,7 @@ Propagator::Propagator(
     }
 
     current_sector_ = sectors_.at(0);
+    InitSectorIndex();
 } catch (const std::out_of_range& ex) {
     log_fatal("No Sectors are provided for the Propagator!");
 }
@@ -89,6 +206,8 @@ Propagator::Propagator(const ParticleDef& particle_def,
     } catch (const std::out_of_range& ex) {
         log_fatal("No Sectors are provided for the Propagator!");
     }
+
+    InitSectorIndex();
 }
 
 // ------------------------------------------------------------------------- //
@@ -98,23 +217,25 @@ Propagator::Propagator(const ParticleDef& particle_def,
     : particle_def_(particle_def)
     , detector_(geometry)
 {
-    for (auto def : sector_defs) {
-        sectors_.push_back(new Sector(particle_def, def, interpolation_def));
-    }
+    CreateSectors(sectors_, particle_def, sector_defs, interpolation_def);
 
     try {
         current_sector_ = sectors_.at(0);
     } catch (const std::out_of_range& ex) {
         log_fatal("No Sectors are provided for the Propagator!");
     }
+
+    InitSectorIndex();
 }
 
 // ------------------------------------------------------------------------- //
 Propagator::Propagator(const Propagator& propagator)
     : sectors_(propagator.sectors_.size(), NULL)
     , current_sector_(NULL)
+    , sector_index_(propagator.sector_index_)
     , particle_def_(propagator.particle_def_)
     , detector_(propagator.detector_)
+    , use_crossing_plan_(propagator.use_crossing_plan_)
 {
     for (unsigned int i = 0; i < propagator.sectors_.size(); ++i) {
         sectors_[i] = new Sector(*propagator.sectors_[i]);
@@ -128,6 +249,20 @@ Propagator::Propagator(const Propagator& propagator)
 // ------------------------------------------------------------------------- //
 Propagator::Propagator(
     const ParticleDef& particle_def, const std::string& config_file)
+    : Propagator(particle_def, ReadConfigFile(config_file))
+{
+}
+
+// ------------------------------------------------------------------------- //
+Propagator::Propagator(
+    const ParticleDef& particle_def, const char* config_file)
+    : Propagator(particle_def, std::string(config_file))
+{
+}
+
+// ------------------------------------------------------------------------- //
+Propagator::Propagator(
+    const ParticleDef& particle_def, const nlohmann::json& config)
     : current_sector_(NULL)
     , particle_def_(particle_def)
     , detector_(NULL)
@@ -139,16 +274,7 @@ Propagator::Propagator(
     InterpolationDef interpolation_def;
     std::unique_ptr<Sector::Definition> sec_def_global(new Sector::Definition());
 
-    // Create the json parser
-    nlohmann::json json_config;
-    try {
-        std::string expanded_config_file_path
-            = Helper::ResolvePath(config_file, true);
-        std::ifstream infilestream(expanded_config_file_path);
-        infilestream >> json_config;
-    } catch (const nlohmann::json::parse_error& e) {
-        log_fatal("Unable parse \"%s\" as json file", config_file.c_str());
-    }
+    nlohmann::json json_config = config;
 
     nlohmann::json json_global;
     if(json_config.contains("global")){
@@ -184,6 +310,7 @@ Propagator::Propagator(
 
     std::shared_ptr<const Medium> med;
     std::shared_ptr<const Geometry> geo;
+    std::vector<Sector::Definition> sector_defs;
     std::array<std::pair<std::string, Sector::ParticleLocation::Enum>, 3> cuts {
         std::make_pair("cuts_infront", Sector::ParticleLocation::InfrontDetector),
         std::make_pair("cuts_inside", Sector::ParticleLocation::InsideDetector),
@@ -229,13 +356,17 @@ Propagator::Propagator(
                     }
 
                     if (do_interpolation) {
-                        sectors_.push_back(new Sector(particle_def_, sec_def, interpolation_def));
+                        sector_defs.push_back(sec_def);
                     } else {
                         sectors_.push_back(new Sector(particle_def_, sec_def));
                     }
                 }
             }
     }
+
+    CreateSectors(sectors_, particle_def_, sector_defs, interpolation_def);
+
+    InitSectorIndex();
 }
 
 Propagator::~Propagator()
@@ -280,18 +411,319 @@ bool Propagator::operator!=(const Propagator& propagator) const
 // Public member functions
 // ------------------------------------------------------------------------- //
 
+// ------------------------------------------------------------------------- //
+Secondaries Propagator::Propagate(const DynamicData& initial_condition,
+    RandomStream& random_stream, double max_distance, double minimal_energy)
+{
+    RandomStreamScope scope(random_stream);
+    return Propagate(initial_condition, max_distance, minimal_energy);
+}
+
+// ------------------------------------------------------------------------- //
+std::vector<Secondaries> Propagator::PropagateBatch(
+    const std::vector<DynamicData>& initial_conditions, unsigned int n_threads,
+    uint64_t seed, uint64_t first_event_id, double max_distance, double minimal_energy)
+{
+    std::vector<Secondaries> results(initial_conditions.size());
+
+    if (n_threads == 0) {
+        n_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    n_threads = static_cast<unsigned int>(
+        std::min<size_t>(n_threads, initial_conditions.size()));
+
+    if (n_threads <= 1) {
+        for (size_t i = 0; i < initial_conditions.size(); ++i) {
+            RandomStream random_stream(seed, first_event_id + i);
+            results[i] = Propagate(
+                initial_conditions[i], random_stream, max_distance, minimal_energy);
+        }
+        return results;
+    }
+
+    // The first worker uses this propagator, the others get a copy. Copying
+    // is done before any worker starts, so no sector is read while another
+    // thread propagates through it.
+    std::vector<std::unique_ptr<Propagator>> copies;
+    for (unsigned int i = 1; i < n_threads; ++i) {
+        copies.emplace_back(new Propagator(*this));
+    }
+
+    std::vector<EventRange> ranges(n_threads);
+    for (unsigned int i = 0; i < n_threads; ++i) {
+        ranges[i].begin = i * initial_conditions.size() / n_threads;
+        ranges[i].end = (i + 1) * initial_conditions.size() / n_threads;
+    }
+
+    std::mutex exception_mutex;
+    std::exception_ptr exception;
+
+    auto worker = [&](unsigned int id) {
+        Propagator& propagator = (id == 0) ? *this : *copies[id - 1];
+        try {
+            size_t event;
+            while (true) {
+                if (!PopEvent(ranges[id], event)) {
+                    if (StealEvents(ranges, id))
+                        continue;
+                    break;
+                }
+                RandomStream random_stream(seed, first_event_id + event);
+                results[event] = propagator.Propagate(
+                    initial_conditions[event], random_stream, max_distance, minimal_energy);
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(exception_mutex);
+            if (!exception)
+                exception = std::current_exception();
+
+            // Stop the others as well
+            for (auto& range : ranges) {
+                std::lock_guard<std::mutex> range_lock(range.mutex);
+                range.end = range.begin;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned int i = 1; i < n_threads; ++i) {
+        threads.emplace_back(worker, i);
+    }
+    worker(0);
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    if (exception)
+        std::rethrow_exception(exception);
+
+    return results;
+}
+
+// ------------------------------------------------------------------------- //
+std::vector<Secondaries> Propagator::PropagateWavefront(
+    const std::vector<DynamicData>& initial_conditions, uint64_t seed,
+    uint64_t first_event_id, double max_distance, double minimal_energy)
+{
+    size_t n = initial_conditions.size();
+
+    std::vector<Secondaries> results;
+    std::vector<Track> tracks;
+    std::vector<RandomStream> random_streams;
+    results.reserve(n);
+    tracks.reserve(n);
+    random_streams.reserve(n);
+
+    std::vector<size_t> active;
+    active.reserve(n);
+
+    for (size_t i = 0; i < n; ++i) {
+        results.emplace_back(std::make_shared<ParticleDef>(particle_def_));
+        tracks.emplace_back(initial_conditions[i]);
+        random_streams.emplace_back(seed, first_event_id + i);
+
+        StartTrack(tracks[i], results[i]);
+        active.push_back(i);
+    }
+
+    Sector::Wavefront wavefront;
+    wavefront.reserve(n);
+    std::vector<size_t> lanes;
+    lanes.reserve(n);
+
+    while (!active.empty()) {
+        size_t n_active = 0;
+        for (auto i : active) {
+            if (PrepareStep(tracks[i], results[i], max_distance)) {
+                active[n_active++] = i;
+            } else {
+                FinishTrack(tracks[i], results[i]);
+                UpdateProducedParticleMoments(results[i]);
+            }
+        }
+        active.resize(n_active);
+
+        // Hand the particles over to their sectors, one wavefront per sector
+        for (auto sector : sectors_) {
+            wavefront.clear();
+            lanes.clear();
+            for (auto i : active) {
+                if (tracks[i].sector == sector) {
+                    wavefront.push_back(tracks[i].condition, tracks[i].distance,
+                        random_streams[i], results[i]);
+                    lanes.push_back(i);
+                }
+            }
+
+            if (wavefront.size() > 0) {
+                sector->Propagate(wavefront, minimal_energy);
+            }
+
+            for (size_t lane = 0; lane < lanes.size(); ++lane) {
+                tracks[lanes[lane]].condition = wavefront.GetParticleCondition(lane);
+            }
+        }
+
+        n_active = 0;
+        for (auto i : active) {
+            if (FinishStep(tracks[i], results[i], max_distance, minimal_energy)) {
+                FinishTrack(tracks[i], results[i]);
+                UpdateProducedParticleMoments(results[i]);
+            } else {
+                active[n_active++] = i;
+            }
+        }
+        active.resize(n_active);
+    }
+
+    return results;
+}
+
 // ------------------------------------------------------------------------- //
 Secondaries Propagator::Propagate(
     const DynamicData& initial_condition, double max_distance, double minimal_energy)
 {
-    double distance = 0;
-    double distance_to_closest_approach = 0;
-
     Secondaries secondaries_(std::make_shared<ParticleDef>(particle_def_));
     /* secondaries_.reserve(static_cast<size_t>(produced_particle_moments_.first
      */
     /*     + 2 * std::sqrt(produced_particle_moments_.second))); */
 
+    // TODO: what to do with the entry, exit closest approach point?
+    // DynamicData entry_condition;
+    // DynamicData exit_condition;
+    // DynamicData closest_approach_condition;
+
+    Propagate(initial_condition, static_cast<LossSink&>(secondaries_),
+        max_distance, minimal_energy);
+    UpdateProducedParticleMoments(secondaries_);
+
+    return secondaries_;
+}
+
+// ------------------------------------------------------------------------- //
+DynamicData Propagator::Propagate(const DynamicData& initial_condition,
+    const LossFunctionSink::Function& loss_function, double max_distance,
+    double minimal_energy)
+{
+    LossFunctionSink loss_sink(loss_function);
+    return Propagate(initial_condition, loss_sink, max_distance, minimal_energy);
+}
+
+// ------------------------------------------------------------------------- //
+DynamicData Propagator::Propagate(const DynamicData& initial_condition,
+    LossSink& loss_sink, double max_distance, double minimal_energy)
+{
+    Track track(initial_condition);
+    StartTrack(track, loss_sink);
+
+    while (PrepareStep(track, loss_sink, max_distance)) {
+        track.condition = track.sector->Propagate(
+            track.condition, track.distance, minimal_energy, loss_sink);
+
+        if (FinishStep(track, loss_sink, max_distance, minimal_energy))
+            break;
+    }
+
+    FinishTrack(track, loss_sink);
+
+    return track.condition;
+}
+
+// ------------------------------------------------------------------------- //
+Propagator::Track::Track(const DynamicData& initial_condition)
+    : condition(initial_condition)
+    , sector(NULL)
+    , distance(0)
+    , starts_in_detector(false)
+    , was_in_detector(false)
+    , propagationstep_till_closest_approach(false)
+    , already_reached_closest_approach(false)
+    , crossing_plan()
+    , plan_segment(0)
+    , plan_start(0)
+    , plan_closest_approach(0)
+    , plan_direction()
+{
+}
+
+// ------------------------------------------------------------------------- //
+void Propagator::PlanCrossings(Track& track)
+{
+    Vector3D origin(track.condition.GetPosition());
+    Vector3D direction(track.condition.GetDirection());
+
+    track.crossing_plan.clear();
+    track.plan_segment = 0;
+    track.plan_start = track.condition.GetPropagatedDistance();
+    track.plan_closest_approach = detector_->DistanceToClosestApproach(origin, direction);
+    track.plan_direction = direction;
+
+    // Every border of the detector and of the sectors along the line may end
+    // a step. The owner of a border is the index of its sector, -1 for the
+    // detector.
+    std::vector<std::pair<double, int>> borders;
+    auto add_borders = [&borders, &origin, &direction](const Geometry& geometry, int owner) {
+        std::pair<double, double> distance = geometry.DistanceToBorder(origin, direction);
+        if (distance.first > 0) borders.emplace_back(distance.first, owner);
+        if (distance.second > 0) borders.emplace_back(distance.second, owner);
+    };
+    add_borders(*detector_, -1);
+    for (size_t i = 0; i < sectors_.size(); ++i) {
+        add_borders(*sectors_[i]->GetSectorDef().GetGeometry(), i);
+    }
+    std::sort(borders.begin(), borders.end());
+
+    // A segment ends at the first border which ends the step of the
+    // geometric lookup as well, see CalculateEffectiveDistance: a border of
+    // the detector, of the sector itself or of a sector with the same
+    // detector location and at least the same hierarchy. So both take the
+    // same steps and draw the same random numbers.
+    double entry = 0;
+    size_t next = 0;
+    while (true) {
+        while (next < borders.size()
+            && borders[next].first < entry + PARTICLE_POSITION_RESOLUTION) {
+            ++next;
+        }
+        if (next == borders.size())
+            break;
+
+        Vector3D position = origin + 0.5 * (entry + borders[next].first) * direction;
+        ChooseCurrentSector(position, direction);
+        if (current_sector_ == nullptr)
+            break;
+
+        int location = static_cast<int>(detector_->GetLocation(position, direction));
+        unsigned int hierarchy = current_sector_->GetSectorDef().GetGeometry()->GetHierarchy();
+
+        size_t exit = next;
+        for (; exit < borders.size(); ++exit) {
+            int owner = borders[exit].second;
+            if (owner < 0 || sectors_[owner] == current_sector_)
+                break;
+            if (static_cast<int>(sectors_[owner]->GetLocation()) == location
+                && sectors_[owner]->GetSectorDef().GetGeometry()->GetHierarchy() >= hierarchy)
+                break;
+        }
+
+        // The line does not leave the sector, which the geometric lookup
+        // handles on its own
+        if (exit == borders.size()) {
+            track.crossing_plan.clear();
+            return;
+        }
+
+        track.crossing_plan.push_back(CrossingSegment{ current_sector_, entry,
+            borders[exit].first, detector_->IsInside(position, direction) });
+        entry = borders[exit].first;
+        next = exit;
+    }
+}
+
+// ------------------------------------------------------------------------- //
+void Propagator::StartTrack(Track& track, LossSink& secondaries_)
+{
     // These two variables are needed to calculate the energy loss inside the
     // detector energy_at_entry_point is initialized with the current energy
     // because this is a reasonable value for particle which starts inside the
@@ -301,144 +733,189 @@ Secondaries Propagator::Propagate(
     // particle_.SetEntryEnergy(particle_.GetEnergy());
     // particle_.SetExitEnergy(particle_.GetMass());
 
-    // TODO: what to do with the entry, exit closest approach point?
-    // DynamicData entry_condition;
-    // DynamicData exit_condition;
-    // DynamicData closest_approach_condition;
+    Vector3D position(track.condition.GetPosition());
+    Vector3D direction(track.condition.GetDirection());
 
-    Vector3D position(initial_condition.GetPosition());
-    Vector3D direction(initial_condition.GetDirection());
+    if (use_crossing_plan_) {
+        PlanCrossings(track);
+    }
 
-    /* bool starts_in_detector = detector_->IsInside( initial_condition.GetPosition(), initial_condition.GetDirection()); */
-    bool starts_in_detector = detector_->IsInside( position, direction);
-    if (starts_in_detector) {
-        secondaries_.SetEntryPoint(initial_condition);
-        distance_to_closest_approach = detector_->DistanceToClosestApproach(
-            initial_condition.GetPosition(), initial_condition.GetDirection());
+    track.starts_in_detector = detector_->IsInside(position, direction);
+    if (track.starts_in_detector) {
+        secondaries_.SetEntryPoint(track.condition);
+        double distance_to_closest_approach
+            = detector_->DistanceToClosestApproach(position, direction);
         if (distance_to_closest_approach < 0) {
-            secondaries_.SetClosestApproachPoint(initial_condition);
+            secondaries_.SetClosestApproachPoint(track.condition);
         }
     }
+}
+
+// ------------------------------------------------------------------------- //
+bool Propagator::PrepareStep(Track& track, LossSink& secondaries_, double max_distance)
+{
+    const DynamicData& p_condition = track.condition;
+
+    // the plan only holds as long as the particle is not deflected
+    if (!track.crossing_plan.empty()
+        && p_condition.GetDirection() != track.plan_direction) {
+        track.crossing_plan.clear();
+    }
+
+    double distance = 0;
+    double distance_to_closest_approach = 0;
     bool is_in_detector = false;
-    bool was_in_detector = false;
-    bool propagationstep_till_closest_approach = false;
-    bool already_reached_closest_approach = false;
-
-    std::unique_ptr<DynamicData> p_condition(
-        new DynamicData(initial_condition));
-    while (1) {
-        ChooseCurrentSector(
-            p_condition->GetPosition(), p_condition->GetDirection());
-
-        if (current_sector_ == nullptr) {
-            log_info("particle reached the border");
-            break;
+
+    if (!track.crossing_plan.empty()) {
+        double track_length = p_condition.GetPropagatedDistance() - track.plan_start;
+        while (track.plan_segment < track.crossing_plan.size()
+            && track_length > track.crossing_plan[track.plan_segment].exit
+                - PARTICLE_POSITION_RESOLUTION) {
+            ++track.plan_segment;
+        }
+
+        if (track.plan_segment == track.crossing_plan.size()) {
+            current_sector_ = nullptr;
+        } else {
+            const CrossingSegment& segment = track.crossing_plan[track.plan_segment];
+            current_sector_ = segment.sector;
+            distance = segment.exit - track_length;
+            is_in_detector = segment.in_detector;
         }
+        distance_to_closest_approach = track.plan_closest_approach - track_length;
+    } else {
+        ChooseCurrentSector(p_condition.GetPosition(), p_condition.GetDirection());
+    }
+
+    track.sector = current_sector_;
 
+    if (current_sector_ == nullptr) {
+        log_info("particle reached the border");
+        return false;
+    }
+
+    if (track.crossing_plan.empty()) {
         // Check if have to propagate the particle_ through the whole sector
         // or only to the sector border
         distance = CalculateEffectiveDistance(
-            p_condition->GetPosition(), p_condition->GetDirection());
-
-        if (already_reached_closest_approach == false) {
-            distance_to_closest_approach = detector_->DistanceToClosestApproach(
-                p_condition->GetPosition(), p_condition->GetDirection());
-            if (distance_to_closest_approach > 0) {
-                if (distance_to_closest_approach < distance) {
-                    already_reached_closest_approach = true;
-
-                    if (std::abs(distance_to_closest_approach)
-                        < GEOMETRY_PRECISION) {
-                        secondaries_.SetClosestApproachPoint(*p_condition);
-                    } else {
-                        distance = distance_to_closest_approach;
-                        propagationstep_till_closest_approach = true;
-                    }
+            p_condition.GetPosition(), p_condition.GetDirection());
+        distance_to_closest_approach = detector_->DistanceToClosestApproach(
+            p_condition.GetPosition(), p_condition.GetDirection());
+        is_in_detector = detector_->IsInside(
+            p_condition.GetPosition(), p_condition.GetDirection());
+    }
+
+    if (track.already_reached_closest_approach == false) {
+        if (distance_to_closest_approach > 0) {
+            if (distance_to_closest_approach < distance) {
+                track.already_reached_closest_approach = true;
+
+                if (std::abs(distance_to_closest_approach)
+                    < GEOMETRY_PRECISION) {
+                    secondaries_.SetClosestApproachPoint(p_condition);
+                } else {
+                    distance = distance_to_closest_approach;
+                    track.propagationstep_till_closest_approach = true;
                 }
             }
         }
+    }
 
-        is_in_detector = detector_->IsInside(
-            p_condition->GetPosition(), p_condition->GetDirection());
-        // entry point of the detector
-        if (!starts_in_detector && !was_in_detector && is_in_detector) {
-            secondaries_.SetEntryPoint(*p_condition);
+    // entry point of the detector
+    if (!track.starts_in_detector && !track.was_in_detector && is_in_detector) {
+        secondaries_.SetEntryPoint(p_condition);
 
-            was_in_detector = true;
-        }
-        // exit point of the detector
-        else if (was_in_detector && !is_in_detector) {
-            secondaries_.SetExitPoint(*p_condition);
-
-            // we don't want to run in this case a second time so we set
-            // was_in_detector to false
-            was_in_detector = false;
+        track.was_in_detector = true;
+    }
+    // exit point of the detector
+    else if (track.was_in_detector && !is_in_detector) {
+        secondaries_.SetExitPoint(p_condition);
 
-        }
-        // if particle_ starts inside the detector we only ant to fill the exit
-        // point
-        else if (starts_in_detector && !is_in_detector) {
-            secondaries_.SetExitPoint(*p_condition);
-
-            // we don't want to run in this case a second time so we set
-            // starts_in_detector to false
-            starts_in_detector = false;
-        }
-        if (max_distance <= p_condition->GetPropagatedDistance() + distance) {
-            distance = max_distance - p_condition->GetPropagatedDistance();
-        }
+        // we don't want to run in this case a second time so we set
+        // was_in_detector to false
+        track.was_in_detector = false;
 
-        Secondaries sector_secondaries = current_sector_->Propagate(
-            *p_condition, distance, minimal_energy);
-        secondaries_.append(sector_secondaries);
+    }
+    // if particle_ starts inside the detector we only ant to fill the exit
+    // point
+    else if (track.starts_in_detector && !is_in_detector) {
+        secondaries_.SetExitPoint(p_condition);
+
+        // we don't want to run in this case a second time so we set
+        // starts_in_detector to false
+        track.starts_in_detector = false;
+    }
+    if (max_distance <= p_condition.GetPropagatedDistance() + distance) {
+        distance = max_distance - p_condition.GetPropagatedDistance();
+    }
 
-        // TODO: this is not god, because the seconday can have other conditions
-        p_condition.reset(
-            new DynamicData(sector_secondaries.GetSecondaries().back()));
+    track.distance = distance;
+    return true;
+}
 
-        if (propagationstep_till_closest_approach) {
-            secondaries_.SetClosestApproachPoint(*p_condition);
+// ------------------------------------------------------------------------- //
+bool Propagator::FinishStep(
+    Track& track, LossSink& secondaries_, double max_distance, double minimal_energy)
+{
+    const DynamicData& p_condition = track.condition;
 
-            propagationstep_till_closest_approach = false;
-        }
+    if (track.propagationstep_till_closest_approach) {
+        secondaries_.SetClosestApproachPoint(p_condition);
 
-        if (std::abs(max_distance - p_condition->GetPropagatedDistance()) < PARTICLE_POSITION_RESOLUTION
-            || p_condition->GetEnergy() <= minimal_energy
-            || p_condition->GetType() == static_cast<int>(InteractionType::Decay))
-            break;
+        track.propagationstep_till_closest_approach = false;
     }
+
+    return std::abs(max_distance - p_condition.GetPropagatedDistance()) < PARTICLE_POSITION_RESOLUTION
+        || p_condition.GetEnergy() <= minimal_energy
+        || p_condition.GetType() == static_cast<int>(InteractionType::Decay);
+}
+
+// ------------------------------------------------------------------------- //
+void Propagator::FinishTrack(Track& track, LossSink& secondaries_)
+{
     if (detector_->IsInside(
-            p_condition->GetPosition(), p_condition->GetDirection())) {
-        secondaries_.SetExitPoint(*p_condition);
+            track.condition.GetPosition(), track.condition.GetDirection())) {
+        secondaries_.SetExitPoint(track.condition);
     }
 
     // secondaries_.DoDecay();
+}
 
+// ------------------------------------------------------------------------- //
+void Propagator::UpdateProducedParticleMoments(const Secondaries& secondaries_)
+{
     n_th_call_ += 1.;
     double produced_particles_
         = static_cast<double>(secondaries_.GetNumberOfParticles());
     produced_particle_moments_ = welfords_online_algorithm(produced_particles_,
         n_th_call_, produced_particle_moments_.first,
         produced_particle_moments_.second);
+}
 
-    return secondaries_;
+// ------------------------------------------------------------------------- //
+void Propagator::InitSectorIndex()
+{
+    std::vector<std::shared_ptr<const Geometry>> geometries;
+    std::vector<int> locations;
+    for (auto sector : sectors_) {
+        geometries.push_back(sector->GetSectorDef().GetGeometry());
+        locations.push_back(static_cast<int>(sector->GetLocation()));
+    }
+
+    sector_index_ = GeometryIndex(geometries, locations);
 }
 
 // ------------------------------------------------------------------------- //
 void Propagator::ChooseCurrentSector(
     const Vector3D& particle_position, const Vector3D& particle_direction)
 {
-    std::vector<int> crossed_sector;
+    std::vector<int>& crossed_sector = crossed_sector_;
 
     // Get Location of the detector (Inside/Infront/Behind)
     Geometry::ParticleLocation::Enum detector_location
         = detector_->GetLocation(particle_position, particle_direction);
-    for (unsigned int i = 0; i < sectors_.size(); ++i) {
-        if (sectors_[i]->GetSectorDef().GetGeometry()->IsInside(particle_position, particle_direction)) {
-            if (static_cast<int>(sectors_[i]->GetLocation()) == static_cast<int>(detector_location))
-                crossed_sector.push_back(i);
-        }
-    }
+    sector_index_.FindInside(particle_position, particle_direction,
+        static_cast<int>(detector_location), crossed_sector);
 
     // No sector was found
     if (crossed_sector.size() == 0) {
@@ -492,30 +969,17 @@ double Propagator::CalculateEffectiveDistance(
         = current_sector_->GetSectorDef().GetGeometry()
               ->DistanceToBorder(particle_position, particle_direction)
               .first;
-    double tmp_distance_to_border;
 
     Geometry::ParticleLocation::Enum detector_location
         = detector_->GetLocation(particle_position, particle_direction);
 
-    for (std::vector<Sector*>::iterator iter = sectors_.begin();
-         iter != sectors_.end(); ++iter) {
-
-        if (static_cast<int>((*iter)->GetLocation())
-            == static_cast<int>(detector_location)) {
-            if ((*iter)->GetSectorDef().GetGeometry()->GetHierarchy()
-                >= current_sector_->GetSectorDef().GetGeometry()->GetHierarchy()) {
-                tmp_distance_to_border
-                    = (*iter)
-                          ->GetSectorDef().GetGeometry()
-                          ->DistanceToBorder(
-                              particle_position, particle_direction)
-                          .first;
-                if (tmp_distance_to_border <= 0)
-                    continue;
-                distance_to_sector_border = std::min(
-                    tmp_distance_to_border, distance_to_sector_border);
-            }
-        }
+    // Only sectors with a higher or equal hierarchy can end the step
+    if (distance_to_sector_border > 0) {
+        distance_to_sector_border = sector_index_.DistanceToBorder(
+            particle_position, particle_direction,
+            static_cast<int>(detector_location),
+            current_sector_->GetSectorDef().GetGeometry()->GetHierarchy(),
+            distance_to_sector_border);
     }
 
     distance_to_detector
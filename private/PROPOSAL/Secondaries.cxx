@@ -4,29 +4,98 @@
 #include "PROPOSAL/geometry/Geometry.h"
 #include "PROPOSAL/math/RandomGenerator.h"
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
 using namespace PROPOSAL;
 
 Secondaries::Secondaries()
-    : primary_def_(nullptr)
+    : size_(0)
+    , capacity_(0)
+    , primary_def_(nullptr)
 {
 }
 
 Secondaries::Secondaries(std::shared_ptr<ParticleDef> p_def)
+    : size_(0)
+    , capacity_(0)
+    , primary_def_(p_def)
 {
-    primary_def_ = p_def;
 }
 
 void Secondaries::reserve(size_t number_secondaries)
 {
-    secondaries_.reserve(number_secondaries);
+    if (number_secondaries > capacity_)
+        Grow(number_secondaries);
+}
+
+void Secondaries::Grow(size_t capacity)
+{
+    std::vector<double> arena(NumberOfColumns * capacity);
+    for (int c = 0; c < NumberOfColumns; ++c) {
+        std::copy(arena_.begin() + c * capacity_,
+            arena_.begin() + c * capacity_ + size_,
+            arena.begin() + c * capacity);
+    }
+    arena_.swap(arena);
+    type_.resize(capacity);
+    capacity_ = capacity;
+}
+
+DynamicData Secondaries::operator[](std::size_t idx) const
+{
+    Vector3D direction(column(DirectionX)[idx], column(DirectionY)[idx],
+        column(DirectionZ)[idx]);
+    direction.SetSphericalCoordinates(column(DirectionRadius)[idx],
+        column(DirectionAzimuth)[idx], column(DirectionZenith)[idx]);
+
+    return DynamicData(type_[idx],
+        Vector3D(column(X)[idx], column(Y)[idx], column(Z)[idx]), direction,
+        column(Energy)[idx], column(ParentParticleEnergy)[idx],
+        column(Time)[idx], column(PropagatedDistance)[idx]);
+}
+
+void Secondaries::Set(std::size_t idx, const DynamicData& particle)
+{
+    Vector3D position = particle.GetPosition();
+    Vector3D direction = particle.GetDirection();
+
+    type_[idx] = particle.GetType();
+    column(X)[idx] = position.GetX();
+    column(Y)[idx] = position.GetY();
+    column(Z)[idx] = position.GetZ();
+    column(DirectionX)[idx] = direction.GetX();
+    column(DirectionY)[idx] = direction.GetY();
+    column(DirectionZ)[idx] = direction.GetZ();
+    column(DirectionRadius)[idx] = direction.GetRadius();
+    column(DirectionAzimuth)[idx] = direction.GetPhi();
+    column(DirectionZenith)[idx] = direction.GetTheta();
+    column(Energy)[idx] = particle.GetEnergy();
+    column(ParentParticleEnergy)[idx] = particle.GetParentParticleEnergy();
+    column(Time)[idx] = particle.GetTime();
+    column(PropagatedDistance)[idx] = particle.GetPropagatedDistance();
 }
 
 void Secondaries::push_back(const DynamicData& continuous_loss)
 {
-    secondaries_.push_back(continuous_loss);
+    if (size_ == capacity_)
+        Grow(std::max<size_t>(2 * capacity_, 16));
+
+    Set(size_++, continuous_loss);
+}
+
+void Secondaries::push_back(const Secondaries& secondaries, std::size_t idx)
+{
+    if (size_ == capacity_)
+        Grow(std::max<size_t>(2 * capacity_, 16));
+
+    type_[size_] = secondaries.type_[idx];
+    for (int c = 0; c < NumberOfColumns; ++c) {
+        column(static_cast<Column>(c))[size_]
+            = secondaries.column(static_cast<Column>(c))[idx];
+    }
+    ++size_;
 }
 
 void Secondaries::emplace_back(const int& type, const Vector3D& position,
@@ -34,12 +103,29 @@ void Secondaries::emplace_back(const int& type, const Vector3D& position,
     const double& parent_particle_energy, const double& time,
     const double& distance)
 {
-    secondaries_.emplace_back(type, position, direction, energy,
-        parent_particle_energy, time, distance);
+    if (size_ == capacity_)
+        Grow(std::max<size_t>(2 * capacity_, 16));
+
+    type_[size_] = type;
+    column(X)[size_] = position.GetX();
+    column(Y)[size_] = position.GetY();
+    column(Z)[size_] = position.GetZ();
+    column(DirectionX)[size_] = direction.GetX();
+    column(DirectionY)[size_] = direction.GetY();
+    column(DirectionZ)[size_] = direction.GetZ();
+    column(DirectionRadius)[size_] = direction.GetRadius();
+    column(DirectionAzimuth)[size_] = direction.GetPhi();
+    column(DirectionZenith)[size_] = direction.GetTheta();
+    column(Energy)[size_] = energy;
+    column(ParentParticleEnergy)[size_] = parent_particle_energy;
+    column(Time)[size_] = time;
+    column(PropagatedDistance)[size_] = distance;
+    ++size_;
 }
+
 void Secondaries::emplace_back(const int& type)
 {
-    secondaries_.emplace_back(type);
+    push_back(DynamicData(type));
 }
 
 // void Secondaries::push_back(const Particle& particle, const int&
@@ -57,18 +143,33 @@ void Secondaries::emplace_back(const int& type)
 //     secondaries_.push_back(data);
 // }
 
-void Secondaries::append(Secondaries& secondaries)
+void Secondaries::append(const Secondaries& secondaries)
 {
-    secondaries_.insert(secondaries_.end(), secondaries.secondaries_.begin(),
-        secondaries.secondaries_.end());
+    append(secondaries, 0, secondaries.size_);
+}
+
+void Secondaries::append(const Secondaries& secondaries, size_t begin, size_t end)
+{
+    size_t n = end - begin;
+    if (size_ + n > capacity_)
+        Grow(std::max(2 * capacity_, size_ + n));
+
+    std::copy(secondaries.type_.begin() + begin,
+        secondaries.type_.begin() + end, type_.begin() + size_);
+    for (int c = 0; c < NumberOfColumns; ++c) {
+        const double* source = secondaries.column(static_cast<Column>(c));
+        std::copy(source + begin, source + end,
+            column(static_cast<Column>(c)) + size_);
+    }
+    size_ += n;
 }
 
 Secondaries Secondaries::Query(const int& interaction_type) const
 {
     Secondaries sec;
-    for (auto i : secondaries_) {
-        if (interaction_type == i.GetType())
-            sec.push_back(i);
+    for (size_t i = 0; i < size_; ++i) {
+        if (interaction_type == type_[i])
+            sec.push_back(*this, i);
     }
     return sec;
 }
@@ -76,9 +177,9 @@ Secondaries Secondaries::Query(const int& interaction_type) const
 Secondaries Secondaries::Query(const std::string& interaction_type) const
 {
     Secondaries sec;
-    for (auto i : secondaries_) {
-        if (interaction_type == i.GetName())
-            sec.push_back(i);
+    for (size_t i = 0; i < size_; ++i) {
+        if (interaction_type == (*this)[i].GetName())
+            sec.push_back(*this, i);
     }
     return sec;
 }
@@ -86,82 +187,101 @@ Secondaries Secondaries::Query(const std::string& interaction_type) const
 Secondaries Secondaries::Query(const Geometry& geometry) const
 {
     Secondaries sec;
-    for (auto i : secondaries_) {
-        if (geometry.IsInside(i.GetPosition(), i.GetDirection()))
-            sec.push_back(i);
+    for (size_t i = 0; i < size_; ++i) {
+        DynamicData particle = (*this)[i];
+        if (geometry.IsInside(particle.GetPosition(), particle.GetDirection()))
+            sec.push_back(*this, i);
     }
     return sec;
 }
 
 void Secondaries::DoDecay()
 {
-    for (auto it = secondaries_.begin(); it != secondaries_.end();) {
-        if (it->GetType() == static_cast<int>(InteractionType::Decay)) {
-            DynamicData decaying_particle(primary_def_->particle_type,
-                it->GetPosition(), it->GetDirection(), it->GetEnergy(),
-                it->GetParentParticleEnergy(), it->GetTime(),
-                it->GetPropagatedDistance());
-            double random_ch = RandomGenerator::Get().RandomDouble();
-            Secondaries products
-                = primary_def_->decay_table.SelectChannel(random_ch).Decay(
-                    *primary_def_, decaying_particle);
-            it = secondaries_.erase(it); // delete old decay
-            for (auto p : products.GetSecondaries()) {
-                // and insert decayparticles inplace of old decay
-                it = secondaries_.insert(it, std::move(p));
-                it++;
-            }
-        } else {
-            it++;
-        }
+    const int decay = static_cast<int>(InteractionType::Decay);
+
+    size_t first = std::find(type_.begin(), type_.begin() + size_, decay) - type_.begin();
+    if (first == size_)
+        return;
+
+    // One pass over the particles, the runs between two decays are copied
+    // column by column and the products replace the decays in place
+    Secondaries decayed(primary_def_);
+    decayed.reserve(size_);
+
+    size_t begin = 0;
+    for (size_t i = first; i < size_; ++i) {
+        if (type_[i] != decay)
+            continue;
+
+        decayed.append(*this, begin, i);
+        begin = i + 1;
+
+        DynamicData decaying_particle = (*this)[i];
+        decaying_particle.SetType(primary_def_->particle_type);
+        double random_ch = RandomGenerator::Get().RandomDouble();
+        primary_def_->decay_table.BuildTables(*primary_def_);
+        Secondaries products
+            = primary_def_->decay_table.SelectChannel(random_ch).Decay(
+                *primary_def_, decaying_particle);
+        decayed.append(products);
     }
+    decayed.append(*this, begin, size_);
+
+    type_.swap(decayed.type_);
+    arena_.swap(decayed.arena_);
+    std::swap(size_, decayed.size_);
+    std::swap(capacity_, decayed.capacity_);
+}
+
+std::vector<double> Secondaries::GetColumnCopy(Column c) const
+{
+    return std::vector<double>(column(c), column(c) + size_);
 }
 
 std::vector<Vector3D> Secondaries::GetPosition() const
 {
     std::vector<Vector3D> vec;
-    for (auto i : secondaries_)
-        vec.emplace_back(i.GetPosition());
+    vec.reserve(size_);
+    for (size_t i = 0; i < size_; ++i)
+        vec.emplace_back(column(X)[i], column(Y)[i], column(Z)[i]);
     return vec;
 }
 
 std::vector<Vector3D> Secondaries::GetDirection() const
 {
     std::vector<Vector3D> vec;
-    for (auto i : secondaries_)
-        vec.emplace_back(i.GetDirection());
+    vec.reserve(size_);
+    for (size_t i = 0; i < size_; ++i)
+        vec.emplace_back((*this)[i].GetDirection());
     return vec;
 }
 
 std::vector<double> Secondaries::GetEnergy() const
 {
-    std::vector<double> vec;
-    for (auto i : secondaries_)
-        vec.emplace_back(i.GetEnergy());
-    return vec;
+    return GetColumnCopy(Energy);
 }
 
 std::vector<double> Secondaries::GetParentParticleEnergy() const
 {
-    std::vector<double> vec;
-    for (auto i : secondaries_)
-        vec.emplace_back(i.GetParentParticleEnergy());
-    return vec;
+    return GetColumnCopy(ParentParticleEnergy);
 }
 
 std::vector<double> Secondaries::GetTime() const
 {
-    std::vector<double> vec;
-    for (auto i : secondaries_)
-        vec.emplace_back(i.GetTime());
-    return vec;
+    return GetColumnCopy(Time);
 }
 
 std::vector<double> Secondaries::GetPropagatedDistance() const
 {
-    std::vector<double> vec;
-    for (auto i : secondaries_)
-        vec.emplace_back(i.GetPropagatedDistance());
+    return GetColumnCopy(PropagatedDistance);
+}
+
+std::vector<DynamicData> Secondaries::GetSecondaries() const
+{
+    std::vector<DynamicData> vec;
+    vec.reserve(size_);
+    for (size_t i = 0; i < size_; ++i)
+        vec.emplace_back((*this)[i]);
     return vec;
 }
 
@@ -181,27 +301,36 @@ DynamicData Secondaries::GetClosestApproachPoint() const
 
 void Secondaries::SetEntryPoint(const DynamicData& entry_point)
 {
-    entry_point_ = std::unique_ptr<DynamicData>(new DynamicData(entry_point));
+    if (entry_point_)
+        *entry_point_ = entry_point;
+    else
+        entry_point_.reset(new DynamicData(entry_point));
 }
 
 void Secondaries::SetExitPoint(const DynamicData& exit_point)
 {
-    exit_point_ = std::unique_ptr<DynamicData>(new DynamicData(exit_point));
+    if (exit_point_)
+        *exit_point_ = exit_point;
+    else
+        exit_point_.reset(new DynamicData(exit_point));
 }
 
 void Secondaries::SetClosestApproachPoint(const DynamicData& closest_approach_point)
 {
-    closest_approach_point_
-        = std::unique_ptr<DynamicData>(new DynamicData(closest_approach_point));
+    if (closest_approach_point_)
+        *closest_approach_point_ = closest_approach_point;
+    else
+        closest_approach_point_.reset(new DynamicData(closest_approach_point));
 }
 
 Secondaries Secondaries::GetOnlyLostInsideDetector() const
 {
     Secondaries croped_secondaries;
-    for (DynamicData p : secondaries_) {
-        if (p.GetTime() >= entry_point_->GetTime()
-            && p.GetTime() <= exit_point_->GetTime()) {
-            croped_secondaries.push_back(p);
+    const double* time = column(Time);
+    for (size_t i = 0; i < size_; ++i) {
+        if (time[i] >= entry_point_->GetTime()
+            && time[i] <= exit_point_->GetTime()) {
+            croped_secondaries.push_back(*this, i);
         }
     }
     return croped_secondaries;
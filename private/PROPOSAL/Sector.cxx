@@ -15,8 +15,10 @@
 #include "PROPOSAL/geometry/Sphere.h"
 
 #include "PROPOSAL/Sector.h"
+#include "PROPOSAL/math/FusedInterpolant.h"
 #include "PROPOSAL/math/MathMethods.h"
 #include "PROPOSAL/math/RandomGenerator.h"
+#include "PROPOSAL/math/TableScheduler.h"
 #include "PROPOSAL/medium/Medium.h"
 #include "PROPOSAL/medium/MediumFactory.h"
 
@@ -27,6 +29,7 @@
 
 #include <algorithm>
 #include <array>
+#include <functional>
 #include <memory>
 #include <utility>
 
@@ -241,12 +244,14 @@ std::ostream& operator<<(std::ostream& os, Sector const& sector)
 Sector::Sector(const ParticleDef& particle_def, const Definition& sector_def)
     : sector_def_(sector_def)
     , particle_def_(particle_def)
+    , secondaries_particle_def_(std::make_shared<ParticleDef>(particle_def))
     , utility_(particle_def, sector_def.GetMedium(), sector_def.cut_settings,
           sector_def.utility_def)
     , displacement_calculator_(new UtilityIntegralDisplacement(utility_))
     , interaction_calculator_(new UtilityIntegralInteraction(utility_))
     , decay_calculator_(new UtilityIntegralDecay(utility_))
     , exact_time_calculator_(NULL)
+    , fused_tables_(NULL)
     , cont_rand_(NULL)
     , scattering_(ScatteringFactory::Get().CreateScattering(
           sector_def_.scattering_model, particle_def, utility_))
@@ -265,46 +270,107 @@ Sector::Sector(const ParticleDef& particle_def, const Definition& sector_def,
     const InterpolationDef& interpolation_def)
     : sector_def_(sector_def)
     , particle_def_(particle_def)
+    , secondaries_particle_def_(std::make_shared<ParticleDef>(particle_def))
     , utility_(particle_def, sector_def.GetMedium(), sector_def.cut_settings,
           sector_def.utility_def, interpolation_def)
-    , displacement_calculator_(
-          new UtilityInterpolantDisplacement(utility_, interpolation_def))
-    , interaction_calculator_(
-          new UtilityInterpolantInteraction(utility_, interpolation_def))
-    , decay_calculator_(
-          new UtilityInterpolantDecay(utility_, interpolation_def))
+    , displacement_calculator_(NULL)
+    , interaction_calculator_(NULL)
+    , decay_calculator_(NULL)
     , exact_time_calculator_(NULL)
+    , fused_tables_(NULL)
     , cont_rand_(NULL)
-    , scattering_(ScatteringFactory::Get().CreateScattering(
-          sector_def_.scattering_model, particle_def, utility_,
-          interpolation_def))
+    , scattering_(NULL)
 {
+    // The tables of the sector are independent, so they are built in
+    // parallel. The cross sections keep the state of their last evaluation,
+    // therefore every table is built on an own copy of the utility and
+    // rebound to utility_ afterwards.
+    TableScheduler scheduler(interpolation_def.number_of_threads);
+
+    typedef std::function<UtilityDecorator*(const Utility&)> DecoratorFactory;
+
+    auto add_calculator = [this, &scheduler](DecoratorFactory create, std::shared_ptr<UtilityDecorator>& calculator) {
+        scheduler.Add([this, create, &calculator]() {
+            Utility utility(utility_);
+            std::unique_ptr<UtilityDecorator> decorator(create(utility));
+            calculator.reset(decorator->clone(utility_));
+        });
+    };
+
+    add_calculator(
+        [&interpolation_def](const Utility& utility) -> UtilityDecorator* {
+            return new UtilityInterpolantDisplacement(utility, interpolation_def);
+        },
+        displacement_calculator_);
+    add_calculator(
+        [&interpolation_def](const Utility& utility) -> UtilityDecorator* {
+            return new UtilityInterpolantInteraction(utility, interpolation_def);
+        },
+        interaction_calculator_);
+    add_calculator(
+        [&interpolation_def](const Utility& utility) -> UtilityDecorator* {
+            return new UtilityInterpolantDecay(utility, interpolation_def);
+        },
+        decay_calculator_);
+
     // These are optional, therfore check NULL
     if (sector_def_.do_exact_time_calculation) {
-        exact_time_calculator_ = std::make_shared<UtilityInterpolantTime>(utility_, interpolation_def);
+        add_calculator(
+            [&interpolation_def](const Utility& utility) -> UtilityDecorator* {
+                return new UtilityInterpolantTime(utility, interpolation_def);
+            },
+            exact_time_calculator_);
     }
 
     if (sector_def_.do_continuous_randomization) {
-        cont_rand_ = std::make_shared<ContinuousRandomizer>(utility_, interpolation_def);
+        scheduler.Add([this, &interpolation_def]() {
+            Utility utility(utility_);
+            ContinuousRandomizer randomizer(utility, interpolation_def);
+            cont_rand_ = std::make_shared<ContinuousRandomizer>(utility_, randomizer);
+        });
     }
+
+    scheduler.Add([this, &interpolation_def]() {
+        Utility utility(utility_);
+        std::unique_ptr<Scattering> scattering(ScatteringFactory::Get().CreateScattering(
+            sector_def_.scattering_model, particle_def_, utility, interpolation_def));
+        scattering_.reset(scattering->clone(particle_def_, utility_));
+    });
+
+    scheduler.Run();
+
+    InitFusedTables(NULL);
 }
 
 Sector::Sector(const Sector& sector)
     : sector_def_(sector.sector_def_)
     , particle_def_(sector.particle_def_)
+    , secondaries_particle_def_(sector.secondaries_particle_def_)
     , utility_(sector.utility_)
     , displacement_calculator_(sector.displacement_calculator_->clone(utility_))
     , interaction_calculator_(sector.interaction_calculator_->clone(utility_))
     , decay_calculator_(sector.decay_calculator_->clone(utility_))
     , exact_time_calculator_(NULL)
-    , cont_rand_(sector.cont_rand_)
-    , scattering_(sector.scattering_)
+    , fused_tables_(NULL)
+    , cont_rand_(NULL)
+    , scattering_(sector.scattering_->clone(particle_def_, utility_))
 {
+    // The calculators are rebound to the own utility, so a copied sector
+    // shares no mutable state with the original. The interpolation tables
+    // themselves are immutable and shared between both.
+
     // These are optional, therfore check NULL
     if (sector.exact_time_calculator_ != NULL) {
-        exact_time_calculator_ = sector.exact_time_calculator_;
+        exact_time_calculator_.reset(sector.exact_time_calculator_->clone(utility_));
+    }
+
+    if (sector.cont_rand_ != NULL) {
+        cont_rand_ = std::make_shared<ContinuousRandomizer>(utility_, *sector.cont_rand_);
     }
 
+    if (sector.fused_tables_ != NULL) {
+        InitFusedTables(sector.fused_tables_->GetTable());
+    }
 }
 
 bool Sector::operator==(const Sector& sector) const
@@ -332,24 +398,65 @@ Sector::~Sector()
 
 }
 
+void Sector::InitFusedTables(std::shared_ptr<const FusedInterpolant> table)
+{
+    // All tracking integrals are tabulated on the same energy grid, so one
+    // lookup at the energy of a step serves every calculator.
+    std::shared_ptr<UtilityDecorator> calculators[] = { displacement_calculator_,
+        interaction_calculator_, decay_calculator_, exact_time_calculator_ };
+
+    std::vector<UtilityInterpolant*> interpolants;
+    for (const auto& calculator : calculators) {
+        if (!calculator)
+            continue;
+
+        UtilityInterpolant* interpolant = dynamic_cast<UtilityInterpolant*>(calculator.get());
+        if (!interpolant)
+            return;
+
+        interpolants.push_back(interpolant);
+    }
+
+    if (!table) {
+        std::vector<const Interpolant*> tables;
+        for (auto interpolant : interpolants) {
+            tables.push_back(interpolant->GetInterpolant().get());
+            tables.push_back(interpolant->GetInterpolantDiff().get());
+        }
+        table = std::make_shared<const FusedInterpolant>(tables);
+    }
+
+    fused_tables_ = std::make_shared<FusedInterpolantCache>(table);
+    for (unsigned int i = 0; i < interpolants.size(); ++i) {
+        interpolants[i]->SetFusedTable(fused_tables_.get(), 2 * i);
+    }
+}
+
 // %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 // %                          Sector Utilities                               %
 // %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 
 double Sector::CalculateTime(const DynamicData& p_condition,
     const double final_energy, const double displacement)
+{
+    return CalculateTime(p_condition.GetTime(), p_condition.GetEnergy(),
+        p_condition.GetPosition(), final_energy, displacement);
+}
+
+double Sector::CalculateTime(const double time, const double initial_energy,
+    const Vector3D& position, const double final_energy, const double displacement)
 {
     if (exact_time_calculator_) {
         // DensityDistribution Approximation: Use the DensityDistribution at the
         // position of initial energy
-        return p_condition.GetTime()
+        return time
             + exact_time_calculator_->Calculate(
-                  p_condition.GetEnergy(), final_energy, 0.0)
+                  initial_energy, final_energy, 0.0)
             / utility_.GetMedium()->GetDensityDistribution().Evaluate(
-                  p_condition.GetPosition());
+                  position);
     }
 
-    return p_condition.GetTime() + displacement / SPEED;
+    return time + displacement / SPEED;
 }
 
 void Sector::Scatter(const double displacement, const double initial_energy,
@@ -491,8 +598,7 @@ int Sector::maximizeEnergy(const std::array<double, 4>& LossEnergies)
 // %                               Do Loss                                   %
 // %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 
-std::shared_ptr<DynamicData> Sector::DoInteraction(
-    const DynamicData& p_condition)
+void Sector::DoInteraction(DynamicData& p_condition)
 {
     std::pair<double, int> stochastic_loss
         = MakeStochasticLoss(p_condition.GetEnergy());
@@ -506,31 +612,20 @@ std::shared_ptr<DynamicData> Sector::DoInteraction(
     Vector3D new_direction(p_condition.GetDirection());
     new_direction.deflect(deflection_angles.first, deflection_angles.second);
 
-    double new_energy = p_condition.GetEnergy() - stochastic_loss.first;
-    return std::make_shared<DynamicData>(
-        stochastic_loss.second,
-        p_condition.GetPosition(),
-        new_direction,
-        new_energy,
-        p_condition.GetEnergy(),
-        p_condition.GetTime(),
-        p_condition.GetPropagatedDistance());
+    p_condition.SetType(stochastic_loss.second);
+    p_condition.SetDirection(new_direction);
+    p_condition.SetParentParticleEnergy(p_condition.GetEnergy());
+    p_condition.SetEnergy(p_condition.GetEnergy() - stochastic_loss.first);
 }
 
-std::shared_ptr<DynamicData> Sector::DoDecay(const DynamicData& p_condition)
+void Sector::DoDecay(DynamicData& p_condition)
 {
-
-    return std::make_shared<DynamicData>(
-        static_cast<int>(InteractionType::Decay), p_condition.GetPosition(),
-        p_condition.GetDirection(), p_condition.GetEnergy(),
-        p_condition.GetParentParticleEnergy(), p_condition.GetTime(),
-        p_condition.GetPropagatedDistance());
+    p_condition.SetType(static_cast<int>(InteractionType::Decay));
 }
 
-std::shared_ptr<DynamicData> Sector::DoContinuous(
-    const DynamicData& p_condition, double final_energy, double displacement)
+void Sector::DoContinuous(
+    DynamicData& p_condition, double final_energy, double displacement)
 {
-
     double initial_energy{ p_condition.GetEnergy() };
 
     double dist = p_condition.GetPropagatedDistance() + displacement;
@@ -539,43 +634,53 @@ std::shared_ptr<DynamicData> Sector::DoContinuous(
     Vector3D position{ p_condition.GetPosition() };
     Vector3D direction{ p_condition.GetDirection() };
 
-    Scatter(displacement, p_condition.GetEnergy(), final_energy, position,
+    Scatter(displacement, initial_energy, final_energy, position,
         direction);
-    final_energy = ContinuousRandomize(p_condition.GetEnergy(), final_energy);
+    final_energy = ContinuousRandomize(initial_energy, final_energy);
 
-    return std::make_shared<DynamicData>(
-        static_cast<int>(InteractionType::ContinuousEnergyLoss), position,
-        direction, final_energy, initial_energy, time, dist);
+    p_condition.SetType(static_cast<int>(InteractionType::ContinuousEnergyLoss));
+    p_condition.SetPosition(position);
+    p_condition.SetDirection(direction);
+    p_condition.SetEnergy(final_energy);
+    p_condition.SetParentParticleEnergy(initial_energy);
+    p_condition.SetTime(time);
+    p_condition.SetPropagatedDistance(dist);
 }
 
 Secondaries Sector::Propagate(
     const DynamicData& p_initial, double border_distance, const double minimal_energy)
 {
-    Secondaries secondaries(std::make_shared<ParticleDef>(particle_def_));
+    Secondaries secondaries(secondaries_particle_def_);
+    Propagate(p_initial, border_distance, minimal_energy, secondaries);
+    return secondaries;
+}
 
-    auto p_condition = std::make_shared<DynamicData>(p_initial);
+DynamicData Sector::Propagate(const DynamicData& p_initial,
+    double border_distance, const double minimal_energy, LossSink& loss_sink)
+{
+    DynamicData p_condition(p_initial);
     // double dist_limit{ p_initial.GetPropagatedDistance() + border_distance };
     double rnd;
     int minimalLoss;
     std::array<double, 4> LossEnergies;
-    double displacement;
+    double displacement = 0.;
 
     while (true) {
         rnd = RandomGenerator::Get().RandomDouble();
         LossEnergies[LossType::Decay]
-            = EnergyDecay(p_condition->GetEnergy(), rnd);
+            = EnergyDecay(p_condition.GetEnergy(), rnd);
 
         rnd = RandomGenerator::Get().RandomDouble();
         LossEnergies[LossType::Interaction]
-            = EnergyInteraction(p_condition->GetEnergy(), rnd);
+            = EnergyInteraction(p_condition.GetEnergy(), rnd);
 
-        // border_distance = dist_limit - p_condition->GetPropagatedDistance();
+        // border_distance = dist_limit - p_condition.GetPropagatedDistance();
         border_distance = border_distance - displacement;
         LossEnergies[LossType::Distance]
-            = EnergyDistance(p_condition->GetEnergy(), border_distance);
+            = EnergyDistance(p_condition.GetEnergy(), border_distance);
 
         LossEnergies[LossType::MinimalE]
-            = EnergyMinimal(p_condition->GetEnergy(), minimal_energy);
+            = EnergyMinimal(p_condition.GetEnergy(), minimal_energy);
 
         minimalLoss = maximizeEnergy(LossEnergies);
 
@@ -586,7 +691,7 @@ Secondaries Sector::Propagate(
         else
         {
             try{
-                displacement = Displacement(*p_condition, LossEnergies[minimalLoss], border_distance);
+                displacement = Displacement(p_condition, LossEnergies[minimalLoss], border_distance);
             }
             catch(DensityException& e){
                 // due to numerical instabilities
@@ -604,18 +709,17 @@ Secondaries Sector::Propagate(
         }
         // a small leap so that it can definitely enter next sector
         if (minimalLoss == LossType::Distance){
-            displacement += (p_condition->GetPropagatedDistance()*DOUBLE_PRECISION);
+            displacement += (p_condition.GetPropagatedDistance()*DOUBLE_PRECISION);
         }
 
-        p_condition
-            = DoContinuous(*p_condition, LossEnergies[minimalLoss], displacement);
+        DoContinuous(p_condition, LossEnergies[minimalLoss], displacement);
         if (sector_def_.do_continuous_energy_loss_output)
-            secondaries.push_back(*p_condition);
+            loss_sink.push_back(p_condition);
 
         if (minimalLoss == LossType::Interaction)
         {
-            p_condition = DoInteraction(*p_condition);
-            secondaries.push_back(*p_condition);
+            DoInteraction(p_condition);
+            loss_sink.push_back(p_condition);
         }
         else
         {
@@ -625,10 +729,217 @@ Secondaries Sector::Propagate(
 
     if (minimalLoss == LossType::Decay)
     {
-        p_condition = DoDecay(*p_condition);
+        DoDecay(p_condition);
     }
 
-    secondaries.push_back(*p_condition);
+    loss_sink.push_back(p_condition);
 
-    return secondaries;
+    return p_condition;
+}
+
+// %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+// %                              Wavefront                                  %
+// %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+
+void Sector::Wavefront::push_back(const DynamicData& particle_condition,
+    double border, RandomStream& stream, LossSink& sink)
+{
+    type.push_back(particle_condition.GetType());
+    position.push_back(particle_condition.GetPosition());
+    direction.push_back(particle_condition.GetDirection());
+    energy.push_back(particle_condition.GetEnergy());
+    parent_particle_energy.push_back(particle_condition.GetParentParticleEnergy());
+    time.push_back(particle_condition.GetTime());
+    propagated_distance.push_back(particle_condition.GetPropagatedDistance());
+    border_distance.push_back(border);
+    displacement.push_back(0.);
+    random_stream.push_back(&stream);
+    loss_sink.push_back(&sink);
+}
+
+DynamicData Sector::Wavefront::GetParticleCondition(size_t idx) const
+{
+    return DynamicData(type[idx], position[idx], direction[idx], energy[idx],
+        parent_particle_energy[idx], time[idx], propagated_distance[idx]);
+}
+
+void Sector::Wavefront::clear()
+{
+    type.clear();
+    position.clear();
+    direction.clear();
+    energy.clear();
+    parent_particle_energy.clear();
+    time.clear();
+    propagated_distance.clear();
+    border_distance.clear();
+    displacement.clear();
+    random_stream.clear();
+    loss_sink.clear();
+}
+
+void Sector::Wavefront::reserve(size_t size)
+{
+    type.reserve(size);
+    position.reserve(size);
+    direction.reserve(size);
+    energy.reserve(size);
+    parent_particle_energy.reserve(size);
+    time.reserve(size);
+    propagated_distance.reserve(size);
+    border_distance.reserve(size);
+    displacement.reserve(size);
+    random_stream.reserve(size);
+    loss_sink.reserve(size);
+}
+
+void Sector::Propagate(Wavefront& wf, const double minimal_energy)
+{
+    // Every loop below does the same as one part of the step in the scalar
+    // Propagate, but for all active particles. Each particle draws from its
+    // own stream, so it gets the same random numbers in the same order.
+
+    std::vector<std::array<double, 4>> LossEnergies(wf.size());
+    std::vector<int> minimalLoss(wf.size());
+
+    std::vector<size_t> active(wf.size());
+
+    // Gathered states of the active particles for the batch scattering
+    std::vector<double> scatter_displacement(wf.size());
+    std::vector<double> scatter_initial_energy(wf.size());
+    std::vector<double> scatter_final_energy(wf.size());
+    std::vector<Vector3D> scatter_position(wf.size());
+    std::vector<Vector3D> scatter_direction(wf.size());
+    std::vector<RandomStream*> scatter_random_stream(wf.size());
+
+    for (size_t i = 0; i < active.size(); ++i) {
+        active[i] = i;
+    }
+
+    while (!active.empty()) {
+        for (auto i : active) {
+            RandomStreamScope scope(*wf.random_stream[i]);
+            double rnd = RandomGenerator::Get().RandomDouble();
+            LossEnergies[i][LossType::Decay] = EnergyDecay(wf.energy[i], rnd);
+        }
+
+        for (auto i : active) {
+            RandomStreamScope scope(*wf.random_stream[i]);
+            double rnd = RandomGenerator::Get().RandomDouble();
+            LossEnergies[i][LossType::Interaction] = EnergyInteraction(wf.energy[i], rnd);
+        }
+
+        for (auto i : active) {
+            wf.border_distance[i] -= wf.displacement[i];
+            LossEnergies[i][LossType::Distance]
+                = EnergyDistance(wf.energy[i], wf.border_distance[i]);
+            LossEnergies[i][LossType::MinimalE]
+                = EnergyMinimal(wf.energy[i], minimal_energy);
+            minimalLoss[i] = maximizeEnergy(LossEnergies[i]);
+        }
+
+        for (auto i : active) {
+            double& displacement = wf.displacement[i];
+
+            if (minimalLoss[i] == LossType::Distance) {
+                displacement = wf.border_distance[i];
+            } else {
+                try {
+                    displacement = displacement_calculator_->Calculate(wf.energy[i],
+                        LossEnergies[i][minimalLoss[i]], wf.border_distance[i],
+                        wf.position[i], wf.direction[i]);
+                } catch (DensityException& e) {
+                    // see the scalar Propagate
+                    minimalLoss[i] = LossType::Distance;
+                    displacement = wf.border_distance[i];
+                }
+
+                if (std::abs(displacement - wf.border_distance[i]) < PARTICLE_POSITION_RESOLUTION) {
+                    minimalLoss[i] = LossType::Distance;
+                    displacement = wf.border_distance[i];
+                }
+            }
+            // a small leap so that it can definitely enter next sector
+            if (minimalLoss[i] == LossType::Distance) {
+                displacement += wf.propagated_distance[i] * DOUBLE_PRECISION;
+            }
+        }
+
+        for (auto i : active) {
+            wf.time[i] = CalculateTime(wf.time[i], wf.energy[i], wf.position[i],
+                LossEnergies[i][minimalLoss[i]], wf.displacement[i]);
+            wf.propagated_distance[i] += wf.displacement[i];
+        }
+
+        // All active particles are scattered in one batch, each particle
+        // still draws its scattering numbers before the continuous
+        // randomization below
+        if (sector_def_.scattering_model != ScatteringFactory::Enum::NoScattering) {
+            size_t n = active.size();
+            for (size_t k = 0; k < n; ++k) {
+                size_t i = active[k];
+                scatter_displacement[k] = wf.displacement[i];
+                scatter_initial_energy[k] = wf.energy[i];
+                scatter_final_energy[k] = LossEnergies[i][minimalLoss[i]];
+                scatter_position[k] = wf.position[i];
+                scatter_direction[k] = wf.direction[i];
+                scatter_random_stream[k] = wf.random_stream[i];
+            }
+
+            scattering_->Scatter(n, scatter_displacement.data(),
+                scatter_initial_energy.data(), scatter_final_energy.data(),
+                scatter_position.data(), scatter_direction.data(),
+                scatter_random_stream.data());
+
+            for (size_t k = 0; k < n; ++k) {
+                wf.position[active[k]] = scatter_position[k];
+                wf.direction[active[k]] = scatter_direction[k];
+            }
+        } else {
+            for (auto i : active) {
+                wf.position[i] = wf.position[i] + wf.displacement[i] * wf.direction[i];
+            }
+        }
+
+        for (auto i : active) {
+            RandomStreamScope scope(*wf.random_stream[i]);
+
+            double initial_energy = wf.energy[i];
+            double final_energy = LossEnergies[i][minimalLoss[i]];
+
+            wf.type[i] = static_cast<int>(InteractionType::ContinuousEnergyLoss);
+            wf.energy[i] = ContinuousRandomize(initial_energy, final_energy);
+            wf.parent_particle_energy[i] = initial_energy;
+
+            if (sector_def_.do_continuous_energy_loss_output)
+                wf.loss_sink[i]->push_back(wf.GetParticleCondition(i));
+        }
+
+        // Sample the stochastic losses and compact away the particles which
+        // decayed, reached the sector border or the minimal energy
+        size_t n_active = 0;
+        for (auto i : active) {
+            if (minimalLoss[i] == LossType::Interaction) {
+                RandomStreamScope scope(*wf.random_stream[i]);
+
+                std::pair<double, int> stochastic_loss = MakeStochasticLoss(wf.energy[i]);
+
+                CrossSection* cross_section = utility_.GetCrosssection(stochastic_loss.second);
+                std::pair<double, double> deflection_angles
+                    = cross_section->StochasticDeflection(wf.energy[i], stochastic_loss.first);
+                wf.direction[i].deflect(deflection_angles.first, deflection_angles.second);
+
+                wf.type[i] = stochastic_loss.second;
+                wf.parent_particle_energy[i] = wf.energy[i];
+                wf.energy[i] -= stochastic_loss.first;
+
+                active[n_active++] = i;
+            } else if (minimalLoss[i] == LossType::Decay) {
+                wf.type[i] = static_cast<int>(InteractionType::Decay);
+            }
+
+            wf.loss_sink[i]->push_back(wf.GetParticleCondition(i));
+        }
+        active.resize(n_active);
+    }
 }
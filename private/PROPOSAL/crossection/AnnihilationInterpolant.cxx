@@ -91,7 +91,7 @@ std::pair<std::vector<DynamicData>, bool> AnnihilationInterpolant::CalculateProd
         {
             parametrization_->SetCurrentComponent(i);
             Parametrization::IntegralLimits limits = parametrization_->GetIntegralLimits(energy);
-            rho = (limits.vUp * std::exp(dndx_interpolant_2d_.at(i)->FindLimit(energy, rnd_ * prob_for_component_[i]) *
+            rho = (limits.vUp * std::exp(FindLimitdNdx(energy, rnd_, prob_for_component_[i], i) *
                                          std::log(limits.vMax / limits.vUp)));
 
             // The available energy is the positron energy plus the mass of the electron
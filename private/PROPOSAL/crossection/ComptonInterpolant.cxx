@@ -1,5 +1,6 @@
 
 #include <functional>
+#include <memory>
 #include <cmath>
 
 #include "PROPOSAL/crossection/ComptonIntegral.h"
@@ -117,15 +118,16 @@ double ComptonInterpolant::FunctionToBuildDNdxInterpolant2D(double energy,
         return std::exp(t) * parametrization_->FunctionToDNdxIntegral(energy, 1 - std::exp(t));
     };
 
-    double t_min = std::log(1. - v);
-    double t_max = std::log(1. - limits.vUp);
+    return IntegratedNdxCumulative(energy, limits.vUp, v, component, [&](double v_low, double v_high) {
+        double t_min = std::log(1. - v_high);
+        double t_max = std::log(1. - v_low);
 
-
-    return integral.Integrate(
-            t_min,
-            t_max,
-            std::bind(integrand_substitution, energy, std::placeholders::_1),
-            2);
+        return integral.Integrate(
+                t_min,
+                t_max,
+                std::bind(integrand_substitution, energy, std::placeholders::_1),
+                2);
+    });
 }
 
 double ComptonInterpolant::CalculateCumulativeCrossSection(double energy, int component, double v)
@@ -174,7 +176,7 @@ double ComptonInterpolant::CalculateStochasticLoss(double energy, double rnd1)
             }
 
             // Linear interpolation in v
-            return energy * ( limits.vUp + (limits.vMax - limits.vMin) * dndx_interpolant_2d_.at(i)->FindLimit(energy, rnd_ * prob_for_component_[i]) );
+            return energy * ( limits.vUp + (limits.vMax - limits.vMin) * FindLimitdNdx(energy, rnd_, prob_for_component_[i], i) );
         }
     }
 
@@ -210,7 +212,10 @@ void ComptonInterpolant::InitdNdxInterpolation(const InterpolationDef& def)
     Helper::InterpolantBuilderContainer builder_container2d(components_.size());
     Helper::InterpolantBuilderContainer builder_return;
 
-    Integral integral(IROMB, IMAXS, IPREC);
+    std::vector<Integral> integrals(components_.size(), CreatedNdxIntegral());
+
+    std::vector<std::unique_ptr<CrossSection> > copies;
+    std::vector<CrossSectionInterpolant*> builders = GetdNdxBuilders(def, copies);
 
     for (unsigned int i = 0; i < components_.size(); ++i)
     {
@@ -238,10 +243,10 @@ void ComptonInterpolant::InitdNdxInterpolation(const InterpolationDef& def)
                 .SetLogSubst(false)
                 .SetFunction2D(std::bind(
                         &CrossSectionInterpolant::FunctionToBuildDNdxInterpolant2D,
-                        this,
+                        builders[i],
                         std::placeholders::_1,
                         std::placeholders::_2,
-                        std::ref(integral),
+                        std::ref(integrals[i]),
                         i));
 
         builder_container2d[i].first  = &builder2d[i];
@@ -269,5 +274,5 @@ void ComptonInterpolant::InitdNdxInterpolation(const InterpolationDef& def)
     builder_return.insert(builder_return.end(), builder_container1d.begin(), builder_container1d.end());
     // builder2d.insert(builder2d.end(), builder1d.begin(), builder1d.end());
 
-    Helper::InitializeInterpolation("dNdx", builder_return, std::vector<Parametrization*>(1, parametrization_), def);
+    InitdNdxTables(def, builder_return, GetdNdxDependencies(), parametrization_->GetParticleDef().low);
 }
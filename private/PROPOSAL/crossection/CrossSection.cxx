@@ -45,12 +45,8 @@ bool CrossSection::operator==(const CrossSection& cross_section) const
         return false;
     else if (*parametrization_ != *cross_section.parametrization_)
         return false;
-    else if (prob_for_component_ != cross_section.prob_for_component_)
-        return false;
-    else if (sum_of_rates_ != cross_section.sum_of_rates_)
-        return false;
-    else if (rnd_ != cross_section.rnd_)
-        return false;
+    // prob_for_component_, sum_of_rates_ and rnd_ only cache the last
+    // sampled loss, so a used cross section still equals a fresh one
     else
         return this->compare(cross_section);
 }
@@ -1,6 +1,8 @@
-
+#include <algorithm>
 #include <functional>
 #include <cmath>
+#include <limits>
+#include <memory>
 
 #include "PROPOSAL/crossection/CrossSectionInterpolant.h"
 #include "PROPOSAL/crossection/parametrization/Parametrization.h"
@@ -8,6 +10,7 @@
 
 #include "PROPOSAL/math/Integral.h"
 #include "PROPOSAL/math/Interpolant.h"
+#include "PROPOSAL/math/QuantileTable.h"
 
 #include "PROPOSAL/Constants.h"
 #include "PROPOSAL/Logging.h"
@@ -21,10 +24,13 @@ using namespace PROPOSAL;
 
 CrossSectionInterpolant::CrossSectionInterpolant(const InteractionType& type, const Parametrization& param)
     : CrossSection(type, param)
-    , dedx_interpolant_(NULL)
-    , de2dx_interpolant_(NULL)
-    , dndx_interpolant_1d_(param.GetMedium()->GetNumComponents(), NULL)
-    , dndx_interpolant_2d_(param.GetMedium()->GetNumComponents(), NULL)
+    , dedx_interpolant_()
+    , de2dx_interpolant_()
+    , dndx_interpolant_1d_(param.GetMedium()->GetNumComponents())
+    , dndx_interpolant_2d_(param.GetMedium()->GetNumComponents())
+    , dndx_quantile_(param.GetMedium()->GetNumComponents())
+    , quantile_energy_min_(param.GetMedium()->GetNumComponents(), 0.)
+    , dndx_partial_integrals_(param.GetMedium()->GetNumComponents())
 {
 }
 
@@ -52,6 +58,16 @@ bool CrossSectionInterpolant::compare(const CrossSection& cross_section) const
         if (*dndx_interpolant_2d_[i] != *cross_section_interpolant->dndx_interpolant_2d_[i])
             return false;
     }
+    for (unsigned int i = 0; i < dndx_quantile_.size(); ++i)
+    {
+        const QuantileTable* quantile       = dndx_quantile_[i].get();
+        const QuantileTable* other_quantile = cross_section_interpolant->dndx_quantile_[i].get();
+
+        if ((quantile == NULL) != (other_quantile == NULL))
+            return false;
+        else if (quantile != NULL && *quantile != *other_quantile)
+            return false;
+    }
 
     return true;
 }
@@ -70,7 +86,10 @@ void CrossSectionInterpolant::InitdNdxInterpolation(const InterpolationDef& def)
     Helper::InterpolantBuilderContainer builder_container2d(components_.size());
     Helper::InterpolantBuilderContainer builder_return;
 
-    Integral integral(IROMB, IMAXS, IPREC);
+    std::vector<Integral> integrals(components_.size(), CreatedNdxIntegral());
+
+    std::vector<std::unique_ptr<CrossSection> > copies;
+    std::vector<CrossSectionInterpolant*> builders = GetdNdxBuilders(def, copies);
 
     for (unsigned int i = 0; i < components_.size(); ++i)
     {
@@ -98,10 +117,10 @@ void CrossSectionInterpolant::InitdNdxInterpolation(const InterpolationDef& def)
             .SetLogSubst(false)
             .SetFunction2D(std::bind(
                 &CrossSectionInterpolant::FunctionToBuildDNdxInterpolant2D,
-                this,
+                builders[i],
                 std::placeholders::_1,
                 std::placeholders::_2,
-                std::ref(integral),
+                std::ref(integrals[i]),
                 i));
 
         builder_container2d[i].first  = &builder2d[i];
@@ -129,65 +148,185 @@ void CrossSectionInterpolant::InitdNdxInterpolation(const InterpolationDef& def)
     builder_return.insert(builder_return.end(), builder_container1d.begin(), builder_container1d.end());
     // builder2d.insert(builder2d.end(), builder1d.begin(), builder1d.end());
 
-    Helper::InitializeInterpolation("dNdx", builder_return, std::vector<Parametrization*>(1, parametrization_), def);
+    InitdNdxTables(def, builder_return, GetdNdxDependencies(), parametrization_->GetParticleDef().mass);
 }
 
-CrossSectionInterpolant::CrossSectionInterpolant(const CrossSectionInterpolant& cross_section)
-    : CrossSection(cross_section)
+// ------------------------------------------------------------------------- //
+Integral CrossSectionInterpolant::CreatedNdxIntegral()
 {
-    if (cross_section.dedx_interpolant_ != NULL)
+    return Integral(IROMB - 1, IMAXS, IPREC);
+}
+
+// ------------------------------------------------------------------------- //
+void CrossSectionInterpolant::InitdNdxTables(const InterpolationDef& def,
+                                             Helper::InterpolantBuilderContainer& builder_container,
+                                             const std::vector<std::vector<unsigned int> >& dependencies,
+                                             double energy_min)
+{
+    Helper::InitializeInterpolation(
+        "dNdx", builder_container, std::vector<Parametrization*>(1, parametrization_), def, dependencies);
+
+    for (auto& partial_integrals : dndx_partial_integrals_)
     {
-        dedx_interpolant_ = new Interpolant(*cross_section.dedx_interpolant_);
-    }
-    else{
-        dedx_interpolant_ = NULL;
+        partial_integrals.clear();
     }
 
-    if (cross_section.de2dx_interpolant_ != NULL)
+    InitdNdxQuantileInterpolation(def, energy_min);
+}
+
+// ------------------------------------------------------------------------- //
+std::vector<CrossSectionInterpolant*> CrossSectionInterpolant::GetdNdxBuilders(
+    const InterpolationDef& def,
+    std::vector<std::unique_ptr<CrossSection> >& copies)
+{
+    std::vector<CrossSectionInterpolant*> builders(components_.size(), this);
+
+    if (def.number_of_threads == 1)
     {
-        de2dx_interpolant_ = new Interpolant(*cross_section.de2dx_interpolant_);
+        return builders;
     }
-    else{
-        de2dx_interpolant_ = NULL;
-    }
-
-    int num_components = cross_section.parametrization_->GetMedium()->GetNumComponents();
 
-    dndx_interpolant_1d_.reserve(num_components);
-    for (auto interpolant: cross_section.dndx_interpolant_1d_)
+    for (unsigned int i = 1; i < components_.size(); ++i)
     {
-        if (interpolant != NULL)
-        {
-            dndx_interpolant_1d_.push_back(new Interpolant(*interpolant));
-        }
+        copies.emplace_back(clone());
+        builders[i] = static_cast<CrossSectionInterpolant*>(copies.back().get());
     }
 
-    dndx_interpolant_2d_.reserve(num_components);
-    for (auto interpolant: cross_section.dndx_interpolant_2d_)
+    return builders;
+}
+
+// ------------------------------------------------------------------------- //
+std::vector<std::vector<unsigned int> > CrossSectionInterpolant::GetdNdxDependencies() const
+{
+    unsigned int n = components_.size();
+    std::vector<std::vector<unsigned int> > dependencies(2 * n);
+
+    for (unsigned int i = 0; i < n; ++i)
     {
-        if (interpolant != NULL)
-        {
-            dndx_interpolant_2d_.push_back(new Interpolant(*interpolant));
-        }
+        dependencies[n + i].push_back(i);
     }
+
+    return dependencies;
 }
 
-CrossSectionInterpolant::~CrossSectionInterpolant()
+// ------------------------------------------------------------------------- //
+double CrossSectionInterpolant::IntegratedNdxCumulative(double energy,
+                                                        double v_min,
+                                                        double v,
+                                                        int component,
+                                                        const std::function<double(double, double)>& integrate)
 {
-    delete dedx_interpolant_;
-    delete de2dx_interpolant_;
+    std::pair<double, double>& partial = dndx_partial_integrals_[component][energy];
 
-    for (auto interpolant: dndx_interpolant_1d_)
+    // A new energy node or a new pass starts at the lower limit
+    if (partial.first < v_min || partial.first > v)
     {
-        delete interpolant;
+        partial.first  = v_min;
+        partial.second = 0;
     }
 
-    for (auto interpolant: dndx_interpolant_2d_)
+    partial.second += integrate(partial.first, v);
+    partial.first = v;
+
+    return partial.second;
+}
+
+// ------------------------------------------------------------------------- //
+void CrossSectionInterpolant::InitdNdxQuantileInterpolation(const InterpolationDef& def, double energy_min)
+{
+    for (unsigned int i = 0; i < components_.size(); ++i)
     {
-        delete interpolant;
+        dndx_quantile_[i]       = NULL;
+        quantile_energy_min_[i] = def.max_node_energy;
+
+        if (def.quantile_accuracy <= 0)
+        {
+            continue;
+        }
+
+        // Components with the same table share the quantiles
+        bool shared = false;
+        for (unsigned int j = 0; j < i; ++j)
+        {
+            if (dndx_quantile_[j] && *dndx_interpolant_2d_[j] == *dndx_interpolant_2d_[i])
+            {
+                dndx_quantile_[i]       = dndx_quantile_[j];
+                quantile_energy_min_[i] = quantile_energy_min_[j];
+                shared                  = true;
+                break;
+            }
+        }
+        if (shared)
+        {
+            continue;
+        }
+
+        // The quantiles are only defined where the component has a positive
+        // rate. Close to the threshold they change too fast with the energy
+        // for a coarse table, so the table starts one node above the first
+        // node with a positive rate. Below, FindLimit is used.
+        parametrization_->SetCurrentComponent(i);
+
+        int nodes   = def.nodes_cross_section;
+        double step = std::log(def.max_node_energy / energy_min) / (nodes - 1);
+        int start   = nodes - 1;
+
+        while (start > 0)
+        {
+            double energy = energy_min * std::exp((start - 1) * step);
+            Parametrization::IntegralLimits limits = parametrization_->GetIntegralLimits(energy);
+
+            if (limits.vUp == limits.vMax || dndx_interpolant_2d_[i]->Interpolate(energy, 1.) <= 0)
+            {
+                break;
+            }
+            --start;
+        }
+
+        ++start;
+
+        if (start > nodes - 2)
+        {
+            continue;
+        }
+
+        quantile_energy_min_[i] = energy_min * std::exp(start * step);
+        dndx_quantile_[i]       = std::make_shared<QuantileTable>(
+            nodes - start,
+            quantile_energy_min_[i],
+            def.max_node_energy,
+            nodes,
+            std::bind(&CrossSectionInterpolant::FunctionToBuildDNdxQuantile,
+                      this,
+                      std::placeholders::_1,
+                      std::placeholders::_2,
+                      i),
+            std::bind(&CrossSectionInterpolant::FunctionToValidateDNdxQuantile,
+                      this,
+                      std::placeholders::_1,
+                      std::placeholders::_2,
+                      i),
+            def.quantile_accuracy,
+            true);
     }
 }
 
+CrossSectionInterpolant::CrossSectionInterpolant(const CrossSectionInterpolant& cross_section)
+    : CrossSection(cross_section)
+    , dedx_interpolant_(cross_section.dedx_interpolant_)
+    , de2dx_interpolant_(cross_section.de2dx_interpolant_)
+    , dndx_interpolant_1d_(cross_section.dndx_interpolant_1d_)
+    , dndx_interpolant_2d_(cross_section.dndx_interpolant_2d_)
+    , dndx_quantile_(cross_section.dndx_quantile_)
+    , quantile_energy_min_(cross_section.quantile_energy_min_)
+    , dndx_partial_integrals_(cross_section.dndx_partial_integrals_.size())
+{
+    // The interpolation tables are not modified after the initialization,
+    // so the copy shares them instead of duplicating the tables.
+}
+
+CrossSectionInterpolant::~CrossSectionInterpolant() {}
+
 // ------------------------------------------------------------------------- //
 // Pulblic methods
 // ------------------------------------------------------------------------- //
@@ -253,6 +392,32 @@ double CrossSectionInterpolant::CalculateStochasticLoss(double energy, double rn
     return CalculateStochasticLoss(energy, rnd2);
 }
 
+// ------------------------------------------------------------------------- //
+double CrossSectionInterpolant::CalculatedNdxOfComponent(double energy, int component) const
+{
+    if (parametrization_->GetMultiplier() <= 0)
+    {
+        return 0;
+    }
+
+    return parametrization_->GetMultiplier() * std::max(dndx_interpolant_1d_[component]->Interpolate(energy), 0.);
+}
+
+// ------------------------------------------------------------------------- //
+double CrossSectionInterpolant::CalculateStochasticLossOfComponent(double energy, double rnd, int component)
+{
+    // Only the chosen table keeps a rate, so the sampling of the component in
+    // the derived classes always ends there. The rate must stay positive for
+    // this, even if the interpolation drops to zero next to a threshold.
+    std::fill(prob_for_component_.begin(), prob_for_component_.end(), 0.);
+
+    sum_of_rates_ = std::max(dndx_interpolant_1d_[component]->Interpolate(energy), std::numeric_limits<double>::min());
+    prob_for_component_[component] = sum_of_rates_;
+    rnd_ = rnd;
+
+    return CalculateStochasticLoss(energy, rnd, rnd);
+}
+
 // ------------------------------------------------------------------------- //
 // Private methods
 // ------------------------------------------------------------------------- //
@@ -282,7 +447,7 @@ double CrossSectionInterpolant::CalculateStochasticLoss(double energy, double rn
             }
 
             return energy *
-                   (limits.vUp * std::exp(dndx_interpolant_2d_.at(i)->FindLimit(energy, rnd_ * prob_for_component_[i]) *
+                   (limits.vUp * std::exp(FindLimitdNdx(energy, rnd_, prob_for_component_[i], i) *
                                      std::log(limits.vMax / limits.vUp)));
         }
     }
@@ -305,6 +470,17 @@ double CrossSectionInterpolant::CalculateStochasticLoss(double energy, double rn
     return 0; // just to prevent warnings
 }
 
+// ------------------------------------------------------------------------- //
+double CrossSectionInterpolant::FindLimitdNdx(double energy, double rnd, double rate, int component) const
+{
+    if (dndx_quantile_[component] && energy >= quantile_energy_min_[component])
+    {
+        return dndx_quantile_[component]->Interpolate(energy, rnd);
+    }
+
+    return dndx_interpolant_2d_[component]->FindLimit(energy, rnd * rate);
+}
+
 // ------------------------------------------------------------------------- //
 // Function needed for interpolation intitialization
 // ------------------------------------------------------------------------- //
@@ -315,6 +491,73 @@ double CrossSectionInterpolant::FunctionToBuildDNdxInterpolant(double energy, in
     return dndx_interpolant_2d_[component]->Interpolate(energy, 1.);
 }
 
+// ------------------------------------------------------------------------- //
+double CrossSectionInterpolant::FunctionToBuildDNdxQuantile(double energy, double rnd, int component)
+{
+    // FindLimit relies on a monotone table along v, which the interpolation
+    // does not guarantee close to the thresholds. Regula falsi with the
+    // Illinois modification keeps the root bracketed and always finds a
+    // value with the requested cumulative rate.
+    const Interpolant& interpolant = *dndx_interpolant_2d_[component];
+
+    double rate = rnd * interpolant.Interpolate(energy, 1.);
+
+    double low       = 0;
+    double high      = 1;
+    double diff_low  = interpolant.Interpolate(energy, low) - rate;
+    double diff_high = interpolant.Interpolate(energy, high) - rate;
+    double v         = 0.5 * (low + high);
+    int side         = 0;
+
+    if (diff_low >= 0)
+    {
+        return low;
+    }
+    if (diff_high <= 0)
+    {
+        return high;
+    }
+
+    for (int i = 0; i < IMAXS && high - low > IPREC; ++i)
+    {
+        v           = (low * diff_high - high * diff_low) / (diff_high - diff_low);
+        double diff = interpolant.Interpolate(energy, v) - rate;
+
+        if (diff < 0)
+        {
+            low      = v;
+            diff_low = diff;
+            if (side == -1)
+            {
+                diff_high *= 0.5;
+            }
+            side = -1;
+        } else if (diff > 0)
+        {
+            high      = v;
+            diff_high = diff;
+            if (side == 1)
+            {
+                diff_low *= 0.5;
+            }
+            side = 1;
+        } else
+        {
+            break;
+        }
+    }
+
+    return v;
+}
+
+// ------------------------------------------------------------------------- //
+double CrossSectionInterpolant::FunctionToValidateDNdxQuantile(double energy, double v, int component)
+{
+    // cumulative distribution of v, the inverse of FunctionToBuildDNdxQuantile
+    return dndx_interpolant_2d_[component]->Interpolate(energy, v) /
+           dndx_interpolant_2d_[component]->Interpolate(energy, 1.);
+}
+
 double CrossSectionInterpolant::CalculateCumulativeCrossSection(double energy, int component, double v)
 {
     parametrization_->SetCurrentComponent(component);
@@ -341,6 +584,8 @@ double CrossSectionInterpolant::FunctionToBuildDNdxInterpolant2D(double energy,
 
     v = limits.vUp * std::exp(v * std::log(limits.vMax / limits.vUp));
 
-    return integral.Integrate(
-        limits.vUp, v, std::bind(&Parametrization::FunctionToDNdxIntegral, parametrization_, energy, std::placeholders::_1), 4);
+    return IntegratedNdxCumulative(energy, limits.vUp, v, component, [&](double v_low, double v_high) {
+        return integral.Integrate(
+            v_low, v_high, std::bind(&Parametrization::FunctionToDNdxIntegral, parametrization_, energy, std::placeholders::_1), 4);
+    });
 }
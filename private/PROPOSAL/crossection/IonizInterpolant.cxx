@@ -1,5 +1,6 @@
 
 #include <functional>
+#include <memory>
 
 #include <cmath>
 
@@ -98,7 +99,10 @@ void IonizInterpolant::InitdNdxInterpolation(const InterpolationDef& def)
     Helper::InterpolantBuilderContainer builder_container2d(components_.size());
     Helper::InterpolantBuilderContainer builder_return;
 
-    Integral integral(IROMB, IMAXS, IPREC);
+    std::vector<Integral> integrals(components_.size(), CreatedNdxIntegral());
+
+    std::vector<std::unique_ptr<CrossSection> > copies;
+    std::vector<CrossSectionInterpolant*> builders = GetdNdxBuilders(def, copies);
 
     for (unsigned int i = 0; i < components_.size(); ++i)
     {
@@ -125,7 +129,7 @@ void IonizInterpolant::InitdNdxInterpolation(const InterpolationDef& def)
             .SetRelativeY(false)
             .SetLogSubst(false)
             .SetFunction2D(std::bind(
-                &IonizInterpolant::FunctionToBuildDNdxInterpolant2D, this, std::placeholders::_1, std::placeholders::_2, std::ref(integral), i));
+                &CrossSectionInterpolant::FunctionToBuildDNdxInterpolant2D, builders[i], std::placeholders::_1, std::placeholders::_2, std::ref(integrals[i]), i));
 
         builder_container2d[i].first  = &builder2d[i];
         builder_container2d[i].second = &dndx_interpolant_2d_[i];
@@ -152,7 +156,14 @@ void IonizInterpolant::InitdNdxInterpolation(const InterpolationDef& def)
     builder_return.insert(builder_return.end(), builder_container1d.begin(), builder_container1d.end());
     // builder2d.insert(builder2d.end(), builder1d.begin(), builder1d.end());
 
-    Helper::InitializeInterpolation("dNdx", builder_return, std::vector<Parametrization*>(1, parametrization_), def);
+    // The 1d tables of all components are read from the first 2d table
+    std::vector<std::vector<unsigned int> > dependencies = GetdNdxDependencies();
+    for (unsigned int i = 1; i < components_.size(); ++i)
+    {
+        dependencies[components_.size() + i].push_back(0);
+    }
+
+    InitdNdxTables(def, builder_return, dependencies, parametrization_->GetParticleDef().mass);
 }
 
 // ----------------------------------------------------------------- //
@@ -207,8 +218,6 @@ double IonizInterpolant::FunctionToBuildDNdxInterpolant(double energy, int compo
 // ------------------------------------------------------------------------- //
 double IonizInterpolant::FunctionToBuildDNdxInterpolant2D(double energy, double v, Integral& integral, int component)
 {
-    (void)component;
-
     Parametrization::IntegralLimits limits = parametrization_->GetIntegralLimits(energy);
 
 
@@ -219,8 +228,10 @@ double IonizInterpolant::FunctionToBuildDNdxInterpolant2D(double energy, double
 
     v = limits.vUp * std::exp(v * std::log(limits.vMax / limits.vUp));
 
-    return integral.Integrate(
-        limits.vUp, v, std::bind(&Parametrization::FunctionToDNdxIntegral, parametrization_, energy, std::placeholders::_1), 3, 1);
+    return IntegratedNdxCumulative(energy, limits.vUp, v, component, [&](double v_low, double v_high) {
+        return integral.Integrate(
+            v_low, v_high, std::bind(&Parametrization::FunctionToDNdxIntegral, parametrization_, energy, std::placeholders::_1), 3, 1);
+    });
 }
 
 // ------------------------------------------------------------------------- //
@@ -243,7 +254,7 @@ double IonizInterpolant::CalculateStochasticLoss(double energy, double rnd1)
             {
                 return energy * limits.vUp;
             }
-            return energy * (limits.vUp * std::exp(dndx_interpolant_2d_[0]->FindLimit(energy, rnd1 * sum_of_rates_) *
+            return energy * (limits.vUp * std::exp(FindLimitdNdx(energy, rnd1, sum_of_rates_, 0) *
                                               std::log(limits.vMax / limits.vUp)));
         }
     }
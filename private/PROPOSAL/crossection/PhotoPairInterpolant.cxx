@@ -1,5 +1,6 @@
 
 #include <functional>
+#include <memory>
 #include <cmath>
 
 #include "PROPOSAL/crossection/PhotoPairIntegral.h"
@@ -120,7 +121,7 @@ std::pair<std::vector<DynamicData>, bool> PhotoPairInterpolant::CalculateProduce
         {
             parametrization_->SetCurrentComponent(i);
             Parametrization::IntegralLimits limits = parametrization_->GetIntegralLimits(energy);
-            rho = (limits.vUp * std::exp(dndx_interpolant_2d_.at(i)->FindLimit(energy, rnd_ * prob_for_component_[i]) *
+            rho = (limits.vUp * std::exp(FindLimitdNdx(energy, rnd_, prob_for_component_[i], i) *
                                          std::log(limits.vMax / limits.vUp)));
 
             particle_list[0].SetEnergy(energy * (1-rho));
@@ -155,7 +156,10 @@ void PhotoPairInterpolant::InitdNdxInterpolation(const InterpolationDef& def)
     Helper::InterpolantBuilderContainer builder_container2d(components_.size());
     Helper::InterpolantBuilderContainer builder_return;
 
-    Integral integral(IROMB, IMAXS, IPREC);
+    std::vector<Integral> integrals(components_.size(), CreatedNdxIntegral());
+
+    std::vector<std::unique_ptr<CrossSection> > copies;
+    std::vector<CrossSectionInterpolant*> builders = GetdNdxBuilders(def, copies);
 
     for (unsigned int i = 0; i < components_.size(); ++i)
     {
@@ -183,10 +187,10 @@ void PhotoPairInterpolant::InitdNdxInterpolation(const InterpolationDef& def)
                 .SetLogSubst(false)
                 .SetFunction2D(std::bind(
                         &CrossSectionInterpolant::FunctionToBuildDNdxInterpolant2D,
-                        this,
+                        builders[i],
                         std::placeholders::_1,
                         std::placeholders::_2,
-                        std::ref(integral),
+                        std::ref(integrals[i]),
                         i));
 
         builder_container2d[i].first  = &builder2d[i];
@@ -214,5 +218,5 @@ void PhotoPairInterpolant::InitdNdxInterpolation(const InterpolationDef& def)
     builder_return.insert(builder_return.end(), builder_container1d.begin(), builder_container1d.end());
     // builder2d.insert(builder2d.end(), builder1d.begin(), builder1d.end());
 
-    Helper::InitializeInterpolation("dNdx", builder_return, std::vector<Parametrization*>(1, parametrization_), def);
+    InitdNdxTables(def, builder_return, GetdNdxDependencies(), ME);
 }
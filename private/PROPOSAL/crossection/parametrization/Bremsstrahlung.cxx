@@ -582,25 +582,23 @@ BremsElectronScreening::BremsElectronScreening(const ParticleDef& particle_def,
                                const EnergyCutSettings& cuts,
                                double multiplier,
                                bool lpm)
-        : Bremsstrahlung(particle_def, medium, cuts, multiplier, lpm), interpolant_(NULL)
+        : Bremsstrahlung(particle_def, medium, cuts, multiplier, lpm)
+        , interpolant_(std::make_shared<Interpolant>(A_logZ, A_energies, A_correction, 2, false, false, 2, false, false))
     {
-        interpolant_ = new Interpolant(A_logZ, A_energies, A_correction, 2, false, false, 2, false, false);
     }
 
 BremsElectronScreening::BremsElectronScreening(const BremsElectronScreening& brems)
-        : Bremsstrahlung(brems), interpolant_(new Interpolant(*brems.interpolant_))
+        : Bremsstrahlung(brems), interpolant_(brems.interpolant_)
     {
     }
 
-BremsElectronScreening::~BremsElectronScreening() {
-    delete interpolant_;
-}
+BremsElectronScreening::~BremsElectronScreening() {}
 
 bool BremsElectronScreening::compare(const Parametrization& parametrization) const
 {
     const BremsElectronScreening* bremsstrahlung = static_cast<const BremsElectronScreening*>(&parametrization);
 
-    if (interpolant_ != bremsstrahlung->interpolant_)
+    if (*interpolant_ != *bremsstrahlung->interpolant_)
         return false;
     else
         return Bremsstrahlung::compare(parametrization);
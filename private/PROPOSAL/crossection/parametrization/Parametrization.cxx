@@ -53,8 +53,8 @@ bool Parametrization::compare(const Parametrization& parametrization) const {
         return false;
     else if (cut_settings_ != parametrization.cut_settings_)
         return false;
-    else if (component_index_ != parametrization.component_index_)
-        return false;
+    // component_index_ is set before every evaluation, so a parametrization
+    // used to build tables still equals one whose tables were built on copies
     else if (multiplier_ != parametrization.multiplier_)
         return false;
     else
@@ -74,9 +74,11 @@ void DecayChannel::Boost(DynamicData& particle, const Vector3D& direction_unnorm
 // ------------------------------------------------------------------------- //
 void DecayChannel::Boost(Secondaries& secondaries, const Vector3D& direction, double gamma, double betagamma)
 {
-    for (auto& p : secondaries.GetModifyableSecondaries())
+    for (unsigned int i = 0; i < secondaries.GetNumberOfParticles(); ++i)
     {
+        DynamicData p = secondaries[i];
         Boost(p, direction, gamma, betagamma);
+        secondaries.Set(i, p);
     }
 }
 
@@ -1,4 +1,5 @@
 
+#include <algorithm>
 #include <sstream>
 
 #include "PROPOSAL/decay/DecayTable.h"
@@ -18,11 +19,16 @@ using namespace PROPOSAL;
 // ------------------------------------------------------------------------- //
 DecayTable::DecayTable()
     : channels_()
+    , alias_channels_()
+    , alias_probabilities_()
+    , alias_indices_()
+    , tables_built_(std::make_shared<std::once_flag>())
 {
 }
 
 // ------------------------------------------------------------------------- //
 DecayTable::DecayTable(const DecayTable& table)
+    : tables_built_(std::make_shared<std::once_flag>())
 {
     clearTable();
 
@@ -30,6 +36,8 @@ DecayTable::DecayTable(const DecayTable& table)
     {
         channels_[iter->first] = iter->second->clone();
     }
+
+    BuildAliasTable();
 }
 
 // ------------------------------------------------------------------------- //
@@ -52,6 +60,10 @@ void PROPOSAL::swap(DecayTable& first, DecayTable& second)
 {
     using std::swap;
     swap(first.channels_, second.channels_);
+    swap(first.alias_channels_, second.alias_channels_);
+    swap(first.alias_probabilities_, second.alias_probabilities_);
+    swap(first.alias_indices_, second.alias_indices_);
+    swap(first.tables_built_, second.tables_built_);
 }
 
 bool DecayTable::operator==(const DecayTable& table) const
@@ -107,26 +119,23 @@ std::ostream& operator<<(std::ostream& os, DecayTable const& table)
 // ------------------------------------------------------------------------- //
 DecayChannel& DecayTable::SelectChannel(double rnd) const
 {
-    double sumBranchingRatio = 0.0;
-    for (DecayMap::const_iterator iter = channels_.begin(); iter != channels_.end(); ++iter)
+    if (alias_channels_.empty())
     {
-        sumBranchingRatio += iter->first;
+        log_fatal("No decay channel found. If your particle is stable, call \"SetStable\"!");
     }
-    rnd = sumBranchingRatio * rnd;
-    double partial_br_sum = 0.0;
 
-    for (DecayMap::const_iterator iter = channels_.begin(); iter != channels_.end(); ++iter)
-    {
-        partial_br_sum += iter->first;
+    // The integer part of rnd * n picks the bin, the fractional part decides
+    // between the channel of the bin and its alias
+    double bin      = rnd * alias_channels_.size();
+    size_t index    = std::min(static_cast<size_t>(bin), alias_channels_.size() - 1);
+    double fraction = bin - index;
 
-        if (rnd < partial_br_sum)
-        {
-            return *iter->second;
-        }
+    if (fraction < alias_probabilities_[index])
+    {
+        return *alias_channels_[index];
     }
 
-    log_fatal("No decay channel found. If your particle is stable, call \"SetStable\"!");
-    return *channels_.begin()->second; // return first channel just to prevent warnings
+    return *alias_channels_[alias_indices_[index]];
 }
 
 // ------------------------------------------------------------------------- //
@@ -137,12 +146,23 @@ void DecayTable::SetStable()
     // TODO(mario): Find better way Wed 2017/08/23
     // A stable channel which alwas will be selected
     channels_[1.1] = new StableChannel();
+
+    BuildAliasTable();
+    tables_built_ = std::make_shared<std::once_flag>();
 }
 
 // ------------------------------------------------------------------------- //
 DecayTable& DecayTable::addChannel(double Br, const DecayChannel& dc)
 {
+    DecayMap::iterator iter = channels_.find(Br);
+    if (iter != channels_.end())
+    {
+        delete iter->second;
+    }
+
     channels_[Br] = dc.clone();
+    BuildAliasTable();
+    tables_built_ = std::make_shared<std::once_flag>();
     return *this;
 }
 
@@ -154,6 +174,18 @@ void DecayTable::SetUniformSampling(bool uniform) const
     }
 }
 
+// ------------------------------------------------------------------------- //
+void DecayTable::BuildTables(const ParticleDef& parent) const
+{
+    // Threads decaying the same particle wait for the first one to build
+    std::call_once(*tables_built_, [this, &parent]() {
+        for (DecayMap::const_iterator iter = channels_.begin(); iter != channels_.end(); ++iter)
+        {
+            iter->second->BuildTables(parent);
+        }
+    });
+}
+
 // ------------------------------------------------------------------------- //
 // private methods
 // ------------------------------------------------------------------------- //
@@ -170,4 +202,78 @@ void DecayTable::clearTable()
     }
 
     channels_.clear();
+
+    alias_channels_.clear();
+    alias_probabilities_.clear();
+    alias_indices_.clear();
+}
+
+// ------------------------------------------------------------------------- //
+void DecayTable::BuildAliasTable()
+{
+    alias_channels_.clear();
+    alias_probabilities_.clear();
+    alias_indices_.clear();
+
+    double sumBranchingRatio = 0.0;
+    for (DecayMap::const_iterator iter = channels_.begin(); iter != channels_.end(); ++iter)
+    {
+        sumBranchingRatio += iter->first;
+    }
+
+    // Without a positive branching ratio no channel can be selected,
+    // SelectChannel reports this
+    if (!(sumBranchingRatio > 0.0))
+    {
+        return;
+    }
+
+    size_t n = channels_.size();
+    for (DecayMap::const_iterator iter = channels_.begin(); iter != channels_.end(); ++iter)
+    {
+        alias_channels_.push_back(iter->second);
+        alias_probabilities_.push_back(iter->first * n / sumBranchingRatio);
+    }
+    alias_indices_.resize(n);
+
+    std::vector<size_t> small;
+    std::vector<size_t> large;
+    for (size_t i = 0; i < n; ++i)
+    {
+        alias_indices_[i] = i;
+        if (alias_probabilities_[i] < 1.0)
+        {
+            small.push_back(i);
+        } else
+        {
+            large.push_back(i);
+        }
+    }
+
+    // Fill the bins below one with the excess of the bins above one
+    while (!small.empty() && !large.empty())
+    {
+        size_t less = small.back();
+        size_t more = large.back();
+        small.pop_back();
+
+        alias_indices_[less] = more;
+        alias_probabilities_[more] -= 1.0 - alias_probabilities_[less];
+
+        if (alias_probabilities_[more] < 1.0)
+        {
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+
+    // What is left differs from one only by rounding
+    for (size_t i = 0; i < small.size(); ++i)
+    {
+        alias_probabilities_[small[i]] = 1.0;
+    }
+    for (size_t i = 0; i < large.size(); ++i)
+    {
+        alias_probabilities_[large[i]] = 1.0;
+    }
 }
@@ -1,5 +1,10 @@
 #include <functional>
 #include <cmath>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <typeindex>
+#include <typeinfo>
 
 
 #include "PROPOSAL/Constants.h"
@@ -9,6 +14,7 @@
 #include "PROPOSAL/particle/Particle.h"
 #include "PROPOSAL/particle/ParticleDef.h"
 #include "PROPOSAL/math/MathMethods.h"
+#include "PROPOSAL/math/QuantileTable.h"
 
 template<typename T, typename... Args>
 std::unique_ptr<T> make_unique(Args&&... args)
@@ -24,6 +30,7 @@ using namespace PROPOSAL;
 
 
 const std::string LeptonicDecayChannelApprox::name_ = "LeptonicDecayChannelApprox";
+const double LeptonicDecayChannelApprox::energy_table_accuracy_ = 1e-5;
 
 // ------------------------------------------------------------------------- //
 LeptonicDecayChannelApprox::LeptonicDecayChannelApprox(const ParticleDef& lepton,
@@ -33,6 +40,8 @@ LeptonicDecayChannelApprox::LeptonicDecayChannelApprox(const ParticleDef& lepton
     , massive_lepton_(lepton)
     , neutrino_(neutrino)
     , anti_neutrino_(anti_neutrino)
+    , energy_table_(NULL)
+    , energy_table_parent_mass_(0)
 {
 }
 
@@ -45,6 +54,8 @@ LeptonicDecayChannelApprox::LeptonicDecayChannelApprox(const LeptonicDecayChanne
     , massive_lepton_(mode.massive_lepton_)
     , neutrino_(mode.neutrino_)
     , anti_neutrino_(mode.anti_neutrino_)
+    , energy_table_(mode.energy_table_)
+    , energy_table_parent_mass_(mode.energy_table_parent_mass_)
 {
 }
 
@@ -84,18 +95,63 @@ double LeptonicDecayChannelApprox::DifferentialDecayRate(double x, double parent
 }
 
 // ------------------------------------------------------------------------- //
-double LeptonicDecayChannelApprox::FindRoot(double min, double parent_mass, double E_max, double right_side)
+double LeptonicDecayChannelApprox::FindRoot(double min, double parent_mass, double E_max, double right_side, int max_steps, double accuracy)
 {
     double max        = 1;
     double x_start    = 0.5;
 
     return NewtonRaphson(std::bind(&LeptonicDecayChannelApprox::DecayRate, this, std::placeholders::_1, parent_mass, E_max, right_side),
                          std::bind(&LeptonicDecayChannelApprox::DifferentialDecayRate, this, std::placeholders::_1, parent_mass, E_max),
-                         min, max, x_start, 40, 1e-3);
+                         min, max, x_start, max_steps, accuracy);
 
 
 }
 
+// ------------------------------------------------------------------------- //
+void LeptonicDecayChannelApprox::BuildTables(const ParticleDef& parent)
+{
+    // The table depends only on the channel and on the masses, so channels
+    // of equal parents, e.g. of copied ParticleDefs, share it. The type tells
+    // the channel apart from the derived LeptonicDecayChannel.
+    static std::mutex mutex;
+    static std::map<std::tuple<std::type_index, double, double>, std::weak_ptr<const QuantileTable> > tables;
+
+    double parent_mass = parent.mass;
+    double emax        = (parent_mass * parent_mass + massive_lepton_.mass * massive_lepton_.mass) / (2 * parent_mass);
+    double x_min       = massive_lepton_.mass / emax;
+
+    if (!(x_min < 1))
+    {
+        // kinematically forbidden, nothing to sample
+        return;
+    }
+
+    double f_min = DecayRate(x_min, parent_mass, emax, 0.0);
+    double f_max = DecayRate(1.0, parent_mass, emax, 0.0);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::tuple<std::type_index, double, double> key(std::type_index(typeid(*this)), parent_mass, massive_lepton_.mass);
+    std::shared_ptr<const QuantileTable> table = tables[key].lock();
+
+    if (!table)
+    {
+        // The first coordinate of the table is not used, it holds only the
+        // distribution of this parent mass
+        table = std::make_shared<QuantileTable>(1, parent_mass, parent_mass, 33,
+            [&](double, double u) {
+                return FindRoot(x_min, parent_mass, emax, f_min + (f_max - f_min) * u, 100, 1e-12);
+            },
+            [&](double, double x) {
+                return (DecayRate(x, parent_mass, emax, 0.0) - f_min) / (f_max - f_min);
+            },
+            energy_table_accuracy_, false);
+        tables[key] = table;
+    }
+
+    energy_table_             = table;
+    energy_table_parent_mass_ = parent_mass;
+}
+
 // ------------------------------------------------------------------------- //
 Secondaries LeptonicDecayChannelApprox::Decay(const ParticleDef& p_def, const DynamicData& p_condition)
 {
@@ -104,11 +160,20 @@ Secondaries LeptonicDecayChannelApprox::Decay(const ParticleDef& p_def, const Dy
     double emax       = (p_def.mass * p_def.mass + massive_lepton_.mass * massive_lepton_.mass) / (2 * p_def.mass);
     double x_min      = massive_lepton_.mass / emax;
 
-    double f_min      = DecayRate(x_min, p_def.mass, emax, 0.0);
-    double f_max      = DecayRate(1.0, p_def.mass, emax, 0.0);
-    double right_side = f_min + (f_max - f_min) * RandomGenerator::Get().RandomDouble();
+    double rnd        = RandomGenerator::Get().RandomDouble();
+    double find_root;
+
+    if (energy_table_ && p_def.mass == energy_table_parent_mass_)
+    {
+        find_root = energy_table_->Interpolate(p_def.mass, rnd);
+    } else
+    {
+        double f_min      = DecayRate(x_min, p_def.mass, emax, 0.0);
+        double f_max      = DecayRate(1.0, p_def.mass, emax, 0.0);
+        double right_side = f_min + (f_max - f_min) * rnd;
 
-    double find_root = FindRoot(x_min, p_def.mass, emax, right_side);
+        find_root = FindRoot(x_min, p_def.mass, emax, right_side);
+    }
 
     double lepton_energy   = std::max(find_root * emax, massive_lepton_.mass);
     double lepton_momentum = std::sqrt((lepton_energy - massive_lepton_.mass) * (lepton_energy + massive_lepton_.mass));
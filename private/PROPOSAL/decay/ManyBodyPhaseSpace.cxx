@@ -27,6 +27,7 @@ ManyBodyPhaseSpace::ManyBodyPhaseSpace(std::vector<const ParticleDef*> daughters
     , matrix_element_()
     , use_default_matrix_element_(true)
     , estimate_(nullptr)
+    , parameter_cache_(std::make_shared<ParameterCache>())
 {
     if (me == nullptr)
     {
@@ -71,6 +72,7 @@ ManyBodyPhaseSpace::ManyBodyPhaseSpace(const ManyBodyPhaseSpace& mode)
     , broad_phase_statistic_(mode.broad_phase_statistic_)
     , matrix_element_(mode.matrix_element_)
     , use_default_matrix_element_(mode.use_default_matrix_element_)
+    , parameter_cache_(mode.parameter_cache_)
 {
     if (use_default_matrix_element_)
     {
@@ -123,16 +125,18 @@ bool ManyBodyPhaseSpace::compare(const DecayChannel& channel) const
 // ------------------------------------------------------------------------- //
 Secondaries ManyBodyPhaseSpace::Decay(const ParticleDef& p_def, const DynamicData& p_condition)
 {
-    // Create vector for decay products
-    Secondaries products;
+    // The candidates are generated into buffers of this thread, which are
+    // kept between the decays, only the accepted event becomes Secondaries
+    static thread_local PhaseSpaceKinematics kinematics;
+    static thread_local std::vector<DynamicData> daughters;
 
+    daughters.clear();
     for (auto p : daughters_) {
-        products.emplace_back(p->particle_type, p_condition.GetPosition(), p_condition.GetDirection(), p_condition.GetEnergy(), p_condition.GetParentParticleEnergy(), p_condition.GetTime(), 0);
+        daughters.emplace_back(p->particle_type, p_condition.GetPosition(), p_condition.GetDirection(), p_condition.GetEnergy(), p_condition.GetParentParticleEnergy(), p_condition.GetTime(), 0);
     }
 
     // prefactor for the phase space density
     PhaseSpaceParameters params = GetPhaseSpaceParams(p_def);
-    PhaseSpaceKinematics kinematics;
 
     if (uniform_)
     {
@@ -141,19 +145,40 @@ Secondaries ManyBodyPhaseSpace::Decay(const ParticleDef& p_def, const DynamicDat
         do
         {
             // precalculated kinematics
-            kinematics = CalculateKinematics(params.normalization, p_def.mass);
-            GenerateEvent(products.GetModifyableSecondaries(), kinematics);
-            // sample product states with rejection sampling
-            weight_ref = params.weight_min + RandomGenerator::Get().RandomDouble() * (params.weight_max - params.weight_min);
-            weight_sample = kinematics.weight * matrix_element_(p_condition, products.GetSecondaries());
+            CalculateKinematics(kinematics, params.normalization, p_def.mass);
+
+            if (use_default_matrix_element_)
+            {
+                // The default matrix element is constant, so the weight is
+                // known without the momenta of the daughters
+                weight_ref = params.weight_min + RandomGenerator::Get().RandomDouble() * (params.weight_max - params.weight_min);
+                weight_sample = kinematics.weight;
+            } else
+            {
+                GenerateEvent(daughters, kinematics);
+                // sample product states with rejection sampling
+                weight_ref = params.weight_min + RandomGenerator::Get().RandomDouble() * (params.weight_max - params.weight_min);
+                weight_sample = kinematics.weight * matrix_element_(p_condition, daughters);
+            }
 
         } while(weight_ref > weight_sample);
+
+        if (use_default_matrix_element_)
+        {
+            GenerateEvent(daughters, kinematics);
+        }
     }
     else
     {
         // precalculated kinematics
-        kinematics = CalculateKinematics(params.normalization, p_def.mass);
-        GenerateEvent(products.GetModifyableSecondaries(), kinematics);
+        CalculateKinematics(kinematics, params.normalization, p_def.mass);
+        GenerateEvent(daughters, kinematics);
+    }
+
+    Secondaries products;
+    products.reserve(daughters.size());
+    for (auto& p : daughters) {
+        products.push_back(p);
     }
 
     // Boost all products in Lab frame (the reason, why the boosting goes in the negative direction of the particle)
@@ -162,6 +187,12 @@ Secondaries ManyBodyPhaseSpace::Decay(const ParticleDef& p_def, const DynamicDat
     return products;
 }
 
+// ------------------------------------------------------------------------- //
+void ManyBodyPhaseSpace::BuildTables(const ParticleDef& parent)
+{
+    GetPhaseSpaceParams(parent);
+}
+
 // ------------------------------------------------------------------------- //
 void ManyBodyPhaseSpace::GenerateEvent(std::vector<DynamicData>& products, const PhaseSpaceKinematics& kinematics)
 {
@@ -217,9 +248,24 @@ double ManyBodyPhaseSpace::Evaluate(const DynamicData& p_condition, const std::v
 // ------------------------------------------------------------------------- //
 ManyBodyPhaseSpace::PhaseSpaceParameters ManyBodyPhaseSpace::GetPhaseSpaceParams(const ParticleDef& parent_def)
 {
-    ParameterMap::iterator it = parameter_map_.find(parent_def);
+    std::pair<int, double> key(parent_def.particle_type, parent_def.mass);
+
+    const ParameterMap* parameters = parameter_cache_->parameters.load(std::memory_order_acquire);
+    if (parameters)
+    {
+        ParameterMap::const_iterator it = parameters->find(key);
+        if (it != parameters->end())
+        {
+            return it->second;
+        }
+    }
 
-    if (it != parameter_map_.end())
+    std::lock_guard<std::mutex> lock(parameter_cache_->mutex);
+
+    // Another thread may have added the parent meanwhile
+    parameters = parameter_cache_->parameters.load(std::memory_order_acquire);
+    ParameterMap::const_iterator it;
+    if (parameters && (it = parameters->find(key)) != parameters->end())
     {
         return it->second;
     } else
@@ -227,9 +273,21 @@ ManyBodyPhaseSpace::PhaseSpaceParameters ManyBodyPhaseSpace::GetPhaseSpaceParams
         PhaseSpaceParameters params;
 
         params.normalization = CalculateNormalization(parent_def.mass);
+        params.weight_max = 0.0;
+        params.weight_min = 0.0;
+
+        // The estimate draws from its own stream, so the envelope does not
+        // depend on when it is estimated and the decays get the same random
+        // numbers with or without it
+        RandomStream stream;
+        RandomStreamScope scope(stream);
         estimate_(params, parent_def);
 
-        parameter_map_[parent_def] = params;
+        std::unique_ptr<ParameterMap> snapshot(parameters ? new ParameterMap(*parameters) : new ParameterMap());
+        (*snapshot)[key] = params;
+
+        parameter_cache_->snapshots.push_back(std::move(snapshot));
+        parameter_cache_->parameters.store(parameter_cache_->snapshots.back().get(), std::memory_order_release);
 
         return params;
     }
@@ -268,7 +326,7 @@ void ManyBodyPhaseSpace::EstimateMaxWeight(PhaseSpaceParameters& params, const P
 void ManyBodyPhaseSpace::SampleEstimateMaxWeight(PhaseSpaceParameters& params, const ParticleDef& parent_def)
 {
     // Create vector for decay products
-    Secondaries products;
+    std::vector<DynamicData> products;
 
     for (auto d : daughters_) {
         products.emplace_back(d->particle_type);
@@ -283,9 +341,9 @@ void ManyBodyPhaseSpace::SampleEstimateMaxWeight(PhaseSpaceParameters& params, c
 
     for (int i = 0; i < broad_phase_statistic_; ++i)
     {
-        kinematics = CalculateKinematics(params.normalization, parent_def.mass);
-        GenerateEvent(products.GetModifyableSecondaries(), kinematics);
-        result = kinematics.weight * matrix_element_(particle, products.GetSecondaries());
+        CalculateKinematics(kinematics, params.normalization, parent_def.mass);
+        GenerateEvent(products, kinematics);
+        result = kinematics.weight * matrix_element_(particle, products);
 
         if (result < params.weight_min)
         {
@@ -300,13 +358,11 @@ void ManyBodyPhaseSpace::SampleEstimateMaxWeight(PhaseSpaceParameters& params, c
 }
 
 // ------------------------------------------------------------------------- //
-ManyBodyPhaseSpace::PhaseSpaceKinematics ManyBodyPhaseSpace::CalculateKinematics(double normalization, double parent_mass)
+void ManyBodyPhaseSpace::CalculateKinematics(PhaseSpaceKinematics& kinematics, double normalization, double parent_mass)
 {
-    PhaseSpaceKinematics kinematics;
-
     // Create sorted random numbers
-    std::vector<double> randoms;
-    randoms.reserve(daughters_.size());
+    std::vector<double>& randoms = kinematics.randoms;
+    randoms.clear();
 
     randoms.push_back(0.0);
 
@@ -320,6 +376,7 @@ ManyBodyPhaseSpace::PhaseSpaceKinematics ManyBodyPhaseSpace::CalculateKinematics
     std::sort(randoms.begin(), randoms.end());
 
     // Calculate virtual masses
+    kinematics.virtual_masses.clear();
     double intermediate_mass = 0.0;
     for (int i = 0; i < number_of_daughters_; ++i)
     {
@@ -328,6 +385,7 @@ ManyBodyPhaseSpace::PhaseSpaceKinematics ManyBodyPhaseSpace::CalculateKinematics
     }
 
     // Calculate intermediate momenta
+    kinematics.momenta.clear();
     double weight = 1.0;
     double momentum = 0.0;
 
@@ -339,8 +397,6 @@ ManyBodyPhaseSpace::PhaseSpaceKinematics ManyBodyPhaseSpace::CalculateKinematics
     }
 
     kinematics.weight = normalization * weight;
-
-    return kinematics;
 }
 
 // ------------------------------------------------------------------------- //
@@ -323,3 +323,10 @@ std::pair<double, double> Box::DistanceToBorder(const Vector3D& position, const
 
     return distance;
 }
+
+// ------------------------------------------------------------------------- //
+std::pair<Vector3D, Vector3D> Box::GetBoundingBox() const
+{
+    Vector3D half_width(0.5 * x_, 0.5 * y_, 0.5 * z_);
+    return std::make_pair(position_ - half_width, position_ + half_width);
+}
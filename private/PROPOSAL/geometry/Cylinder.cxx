@@ -570,3 +570,21 @@ std::pair<double, double> Cylinder::DistanceToBorder(const Vector3D& position, c
 
     return distance;
 }
+
+// ------------------------------------------------------------------------- //
+std::pair<Vector3D, Vector3D> Cylinder::GetBoundingBox() const
+{
+    Vector3D half_width(radius_, radius_, 0.5 * z_);
+    return std::make_pair(position_ - half_width, position_ + half_width);
+}
+
+// ------------------------------------------------------------------------- //
+std::pair<Vector3D, Vector3D> Cylinder::GetCavityBox() const
+{
+    if (inner_radius_ <= 0)
+        return Geometry::GetCavityBox();
+
+    // square inscribed into the inner circle
+    Vector3D half_width(inner_radius_ / SQRT2, inner_radius_ / SQRT2, 0.5 * z_);
+    return std::make_pair(position_ - half_width, position_ + half_width);
+}
@@ -177,3 +177,9 @@ double Geometry::DistanceToClosestApproach(const Vector3D& position, const Vecto
 {
     return scalar_product(position_ - position, direction);
 }
+
+// ------------------------------------------------------------------------- //
+std::pair<Vector3D, Vector3D> Geometry::GetCavityBox() const
+{
+    return std::make_pair(Vector3D(1, 1, 1), Vector3D(-1, -1, -1));
+}
@@ -0,0 +1,326 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "PROPOSAL/Constants.h"
+#include "PROPOSAL/Logging.h"
+#include "PROPOSAL/geometry/GeometryIndex.h"
+
+using namespace PROPOSAL;
+
+namespace {
+
+void ToArray(const Vector3D& vector, double array[3])
+{
+    array[0] = vector.GetX();
+    array[1] = vector.GetY();
+    array[2] = vector.GetZ();
+}
+
+} // namespace
+
+/******************************************************************************
+ *                             Axis aligned box                              *
+ ******************************************************************************/
+
+GeometryIndex::AxisAlignedBox::AxisAlignedBox()
+{
+    for (int i = 0; i < 3; ++i) {
+        lower[i] = std::numeric_limits<double>::infinity();
+        upper[i] = -std::numeric_limits<double>::infinity();
+    }
+}
+
+GeometryIndex::AxisAlignedBox::AxisAlignedBox(const std::pair<Vector3D, Vector3D>& corners)
+{
+    ToArray(corners.first, lower);
+    ToArray(corners.second, upper);
+}
+
+bool GeometryIndex::AxisAlignedBox::IsEmpty() const
+{
+    return lower[0] > upper[0] || lower[1] > upper[1] || lower[2] > upper[2];
+}
+
+bool GeometryIndex::AxisAlignedBox::Contains(const double point[3]) const
+{
+    for (int i = 0; i < 3; ++i) {
+        if (point[i] < lower[i] || point[i] > upper[i])
+            return false;
+    }
+    return true;
+}
+
+void GeometryIndex::AxisAlignedBox::Enclose(const AxisAlignedBox& box)
+{
+    for (int i = 0; i < 3; ++i) {
+        lower[i] = std::min(lower[i], box.lower[i]);
+        upper[i] = std::max(upper[i], box.upper[i]);
+    }
+}
+
+void GeometryIndex::AxisAlignedBox::Intersect(const AxisAlignedBox& box)
+{
+    for (int i = 0; i < 3; ++i) {
+        lower[i] = std::max(lower[i], box.lower[i]);
+        upper[i] = std::min(upper[i], box.upper[i]);
+    }
+}
+
+void GeometryIndex::AxisAlignedBox::Widen(double margin)
+{
+    if (IsEmpty())
+        return;
+
+    for (int i = 0; i < 3; ++i) {
+        lower[i] -= margin;
+        upper[i] += margin;
+    }
+}
+
+std::pair<double, double> GeometryIndex::AxisAlignedBox::RayIntersection(
+    const double origin[3], const double inverse_direction[3]) const
+{
+    double enter = -std::numeric_limits<double>::infinity();
+    double leave = std::numeric_limits<double>::infinity();
+
+    for (int i = 0; i < 3; ++i) {
+        if (std::isinf(inverse_direction[i])) {
+            // the ray is parallel to these faces
+            if (origin[i] < lower[i] || origin[i] > upper[i])
+                return std::make_pair(1., -1.);
+            continue;
+        }
+
+        double t_lower = (lower[i] - origin[i]) * inverse_direction[i];
+        double t_upper = (upper[i] - origin[i]) * inverse_direction[i];
+        if (t_lower > t_upper)
+            std::swap(t_lower, t_upper);
+
+        enter = std::max(enter, t_lower);
+        leave = std::min(leave, t_upper);
+    }
+
+    return std::make_pair(enter, leave);
+}
+
+/******************************************************************************
+ *                              Geometry index                               *
+ ******************************************************************************/
+
+GeometryIndex::GeometryIndex()
+    : entries_()
+    , order_()
+    , nodes_()
+{
+}
+
+GeometryIndex::GeometryIndex(const std::vector<std::shared_ptr<const Geometry>>& geometries,
+    const std::vector<int>& groups)
+    : entries_(geometries.size())
+    , order_(geometries.size())
+    , nodes_()
+{
+    if (groups.size() != geometries.size())
+        log_fatal("Every geometry of the index needs a group!");
+
+    for (size_t i = 0; i < geometries.size(); ++i) {
+        Entry& entry = entries_[i];
+        entry.geometry = geometries[i];
+        entry.group = groups[i];
+        entry.hierarchy = geometries[i]->GetHierarchy();
+        entry.bounds = AxisAlignedBox(geometries[i]->GetBoundingBox());
+        entry.cavity = AxisAlignedBox(geometries[i]->GetCavityBox());
+
+        // Points on the border, which move into the geometry, are inside.
+        // Keep them away from the box faces by a margin.
+        double scale = 1.;
+        for (int k = 0; k < 3; ++k) {
+            scale = std::max(scale, std::abs(entry.bounds.lower[k]));
+            scale = std::max(scale, std::abs(entry.bounds.upper[k]));
+        }
+        double margin = 1e-6 * scale;
+
+        entry.bounds.Widen(margin);
+        entry.cavity.Widen(-margin);
+
+        order_[i] = i;
+    }
+
+    if (!entries_.empty()) {
+        nodes_.reserve(2 * entries_.size());
+        Build(0, entries_.size());
+    }
+}
+
+// ------------------------------------------------------------------------- //
+int GeometryIndex::Build(int first, int count)
+{
+    int index = nodes_.size();
+    nodes_.push_back(Node());
+
+    AxisAlignedBox bounds;
+    AxisAlignedBox cavity = entries_[order_[first]].cavity;
+    for (int i = first; i < first + count; ++i) {
+        bounds.Enclose(entries_[order_[i]].bounds);
+        cavity.Intersect(entries_[order_[i]].cavity);
+    }
+
+    nodes_[index].bounds = bounds;
+    nodes_[index].cavity = cavity;
+    nodes_[index].left = -1;
+    nodes_[index].right = -1;
+    nodes_[index].first = first;
+    nodes_[index].count = count;
+
+    if (count <= max_leaf_size_)
+        return index;
+
+    // Split at the median of the box centers along the axis of the largest
+    // spread. If the boxes mostly overlap, as nested layers do, split by
+    // their size instead, so inner and outer layers are separated.
+    int axis = 0;
+    double spread = -1.;
+    double extent = 0.;
+    for (int k = 0; k < 3; ++k) {
+        double min_center = std::numeric_limits<double>::infinity();
+        double max_center = -std::numeric_limits<double>::infinity();
+        double sum_extent = 0.;
+        for (int i = first; i < first + count; ++i) {
+            const AxisAlignedBox& box = entries_[order_[i]].bounds;
+            double center = 0.5 * (box.lower[k] + box.upper[k]);
+            min_center = std::min(min_center, center);
+            max_center = std::max(max_center, center);
+            sum_extent += box.upper[k] - box.lower[k];
+        }
+        if (max_center - min_center > spread) {
+            axis = k;
+            spread = max_center - min_center;
+            extent = sum_extent / count;
+        }
+    }
+
+    const std::vector<Entry>& entries = entries_;
+    std::vector<int>::iterator begin = order_.begin() + first;
+    std::vector<int>::iterator middle = begin + count / 2;
+    std::vector<int>::iterator end = begin + count;
+
+    if (spread < 0.5 * extent) {
+        std::nth_element(begin, middle, end, [&entries](int a, int b) {
+            const AxisAlignedBox& box_a = entries[a].bounds;
+            const AxisAlignedBox& box_b = entries[b].bounds;
+            double size_a = 0., size_b = 0.;
+            for (int k = 0; k < 3; ++k) {
+                size_a = std::max(size_a, box_a.upper[k] - box_a.lower[k]);
+                size_b = std::max(size_b, box_b.upper[k] - box_b.lower[k]);
+            }
+            return size_a < size_b;
+        });
+    } else {
+        std::nth_element(begin, middle, end, [&entries, axis](int a, int b) {
+            return entries[a].bounds.lower[axis] + entries[a].bounds.upper[axis]
+                < entries[b].bounds.lower[axis] + entries[b].bounds.upper[axis];
+        });
+    }
+
+    int left = Build(first, count / 2);
+    int right = Build(first + count / 2, count - count / 2);
+    nodes_[index].left = left;
+    nodes_[index].right = right;
+
+    return index;
+}
+
+// ------------------------------------------------------------------------- //
+void GeometryIndex::FindInside(const Vector3D& position, const Vector3D& direction,
+    int group, std::vector<int>& inside) const
+{
+    inside.clear();
+    if (nodes_.empty())
+        return;
+
+    double point[3];
+    ToArray(position, point);
+
+    int stack[max_depth_];
+    int stack_size = 0;
+    stack[stack_size++] = 0;
+
+    while (stack_size > 0) {
+        const Node& node = nodes_[stack[--stack_size]];
+
+        if (!node.bounds.Contains(point) || node.cavity.Contains(point))
+            continue;
+
+        if (node.left >= 0) {
+            stack[stack_size++] = node.right;
+            stack[stack_size++] = node.left;
+            continue;
+        }
+
+        for (int i = node.first; i < node.first + node.count; ++i) {
+            const Entry& entry = entries_[order_[i]];
+            if (entry.group != group)
+                continue;
+            if (!entry.bounds.Contains(point) || entry.cavity.Contains(point))
+                continue;
+            if (entry.geometry->IsInside(position, direction))
+                inside.push_back(order_[i]);
+        }
+    }
+
+    std::sort(inside.begin(), inside.end());
+}
+
+// ------------------------------------------------------------------------- //
+double GeometryIndex::DistanceToBorder(const Vector3D& position, const Vector3D& direction,
+    int group, unsigned int min_hierarchy, double max_distance) const
+{
+    double distance = max_distance;
+    if (nodes_.empty())
+        return distance;
+
+    double origin[3];
+    double inverse_direction[3];
+    ToArray(position, origin);
+    ToArray(direction, inverse_direction);
+    for (int k = 0; k < 3; ++k) {
+        inverse_direction[k] = 1. / inverse_direction[k];
+    }
+
+    int stack[max_depth_];
+    int stack_size = 0;
+    stack[stack_size++] = 0;
+
+    while (stack_size > 0) {
+        const Node& node = nodes_[stack[--stack_size]];
+
+        // the ray does not reach the node before the closest border so far
+        std::pair<double, double> bounds = node.bounds.RayIntersection(origin, inverse_direction);
+        if (bounds.second < 0 || bounds.first > bounds.second || bounds.first >= distance)
+            continue;
+
+        // the ray stays inside the common cavity up to the closest border so far
+        if (node.cavity.Contains(origin)
+            && node.cavity.RayIntersection(origin, inverse_direction).second >= distance)
+            continue;
+
+        if (node.left >= 0) {
+            stack[stack_size++] = node.right;
+            stack[stack_size++] = node.left;
+            continue;
+        }
+
+        for (int i = node.first; i < node.first + node.count; ++i) {
+            const Entry& entry = entries_[order_[i]];
+            if (entry.group != group || entry.hierarchy < min_hierarchy)
+                continue;
+
+            double tmp_distance = entry.geometry->DistanceToBorder(position, direction).first;
+            if (tmp_distance > 0 && tmp_distance < distance)
+                distance = tmp_distance;
+        }
+    }
+
+    return distance;
+}
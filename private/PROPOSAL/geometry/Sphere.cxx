@@ -290,3 +290,21 @@ std::pair<double, double> Sphere::DistanceToBorder(const Vector3D& position, con
 
     return distance;
 }
+
+// ------------------------------------------------------------------------- //
+std::pair<Vector3D, Vector3D> Sphere::GetBoundingBox() const
+{
+    Vector3D half_width(radius_, radius_, radius_);
+    return std::make_pair(position_ - half_width, position_ + half_width);
+}
+
+// ------------------------------------------------------------------------- //
+std::pair<Vector3D, Vector3D> Sphere::GetCavityBox() const
+{
+    if (inner_radius_ <= 0)
+        return Geometry::GetCavityBox();
+
+    // cube inscribed into the inner sphere
+    Vector3D half_width(inner_radius_ / SQRT3, inner_radius_ / SQRT3, inner_radius_ / SQRT3);
+    return std::make_pair(position_ - half_width, position_ + half_width);
+}
@@ -0,0 +1,90 @@
+#include "PROPOSAL/Logging.h"
+#include "PROPOSAL/math/AliasTable.h"
+
+using namespace PROPOSAL;
+
+AliasTable::AliasTable(const std::vector<double>& weights)
+    : probability_(weights.size(), 1.)
+    , alias_(weights.size())
+{
+    double sum = 0;
+    for (double weight : weights)
+    {
+        if (weight < 0)
+        {
+            log_fatal("The weights of an alias table must not be negative!");
+        }
+        sum += weight;
+    }
+
+    if (weights.empty() || sum <= 0)
+    {
+        log_fatal("An alias table needs at least one positive weight!");
+    }
+
+    // Vose's setup: columns with less than the average weight are filled up
+    // by the rest of a column with more than the average weight.
+    unsigned int size = weights.size();
+    std::vector<unsigned int> small, large;
+
+    for (unsigned int i = 0; i < size; ++i)
+    {
+        alias_[i]       = i;
+        probability_[i] = weights[i] * size / sum;
+
+        if (probability_[i] < 1.)
+            small.push_back(i);
+        else
+            large.push_back(i);
+    }
+
+    while (!small.empty() && !large.empty())
+    {
+        unsigned int less = small.back();
+        unsigned int more = large.back();
+        small.pop_back();
+
+        alias_[less] = more;
+        probability_[more] -= 1. - probability_[less];
+
+        if (probability_[more] < 1.)
+        {
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+
+    // The remaining columns are full up to rounding errors
+    for (unsigned int i : small)
+        probability_[i] = 1.;
+    for (unsigned int i : large)
+        probability_[i] = 1.;
+}
+
+bool AliasTable::operator==(const AliasTable& table) const
+{
+    if (probability_ != table.probability_)
+        return false;
+    else if (alias_ != table.alias_)
+        return false;
+    return true;
+}
+
+bool AliasTable::operator!=(const AliasTable& table) const
+{
+    return !(*this == table);
+}
+
+// ------------------------------------------------------------------------- //
+unsigned int AliasTable::Sample(double rnd) const
+{
+    double column = rnd * probability_.size();
+    unsigned int i = static_cast<unsigned int>(column);
+
+    if (i >= probability_.size())
+    {
+        i = probability_.size() - 1;
+    }
+
+    return (column - i < probability_[i]) ? i : alias_[i];
+}
@@ -0,0 +1,244 @@
+#include <cmath>
+#include <limits>
+
+#include "PROPOSAL/Logging.h"
+#include "PROPOSAL/math/FusedInterpolant.h"
+#include "PROPOSAL/math/Interpolant.h"
+
+using namespace PROPOSAL;
+
+/******************************************************************************
+ *                              Fused Interpolant                             *
+ ******************************************************************************/
+
+FusedInterpolant::FusedInterpolant(const std::vector<const Interpolant*>& interpolants)
+    : columns_(interpolants.size())
+    , romberg_(0)
+    , max_(0)
+    , xmin_(0)
+    , step_(0)
+    , rational_(false)
+    , isLog_(false)
+    , iX_()
+    , iY_()
+{
+    if (interpolants.empty() || interpolants.size() > max_columns_) {
+        log_fatal("A fused table needs between 1 and %u tables!", max_columns_);
+    }
+
+    const Interpolant& first = *interpolants.front();
+
+    for (const Interpolant* interpolant : interpolants) {
+        // The fused Neville scheme assumes the settings of the fast 1d
+        // interpolation, so only tables of the same kind can be combined.
+        if (!interpolant->fast_ || interpolant->logSubst_ || !interpolant->Interpolant_.empty()) {
+            log_fatal("Only 1d tables without log substitution can be fused!");
+        }
+        if (interpolant->max_ != first.max_ || interpolant->romberg_ != first.romberg_
+            || interpolant->xmin_ != first.xmin_ || interpolant->step_ != first.step_
+            || interpolant->rational_ != first.rational_ || interpolant->isLog_ != first.isLog_
+            || interpolant->GetIX() != first.GetIX()) {
+            log_fatal("Fused tables must share the same grid!");
+        }
+    }
+
+    romberg_  = first.romberg_;
+    max_      = first.max_;
+    xmin_     = first.xmin_;
+    step_     = first.step_;
+    rational_ = first.rational_;
+    isLog_    = first.isLog_;
+    iX_       = first.GetIX();
+
+    iY_.resize(max_ * columns_);
+    for (int i = 0; i < max_; ++i) {
+        for (unsigned int j = 0; j < columns_; ++j) {
+            iY_[i * columns_ + j] = interpolants[j]->GetY()[i];
+        }
+    }
+}
+
+bool FusedInterpolant::operator==(const FusedInterpolant& interpolant) const
+{
+    if (columns_ != interpolant.columns_)
+        return false;
+    else if (romberg_ != interpolant.romberg_)
+        return false;
+    else if (max_ != interpolant.max_)
+        return false;
+    else if (xmin_ != interpolant.xmin_)
+        return false;
+    else if (step_ != interpolant.step_)
+        return false;
+    else if (rational_ != interpolant.rational_)
+        return false;
+    else if (isLog_ != interpolant.isLog_)
+        return false;
+    else if (iX_ != interpolant.iX_)
+        return false;
+    else if (iY_ != interpolant.iY_)
+        return false;
+    return true;
+}
+
+bool FusedInterpolant::operator!=(const FusedInterpolant& interpolant) const
+{
+    return !(*this == interpolant);
+}
+
+// ------------------------------------------------------------------------- //
+void FusedInterpolant::Interpolate(double x, double* values) const
+{
+    // Same as Interpolant::Interpolate, but the position on the grid and the
+    // differences of the sampling points are evaluated once for all tables.
+
+    if (isLog_) {
+        x = Interpolant::Log(x);
+    }
+
+    double aux = (x - xmin_) / step_;
+    int starti = (int)aux;
+
+    if (starti < 0) {
+        starti = 0;
+    } else if (starti >= max_) {
+        starti = max_ - 1;
+    }
+
+    int start = (int)(aux - 0.5 * (romberg_ - 1));
+
+    if (start < 0) {
+        start = 0;
+    } else if (start + romberg_ > max_ || start > max_) {
+        start = max_ - romberg_;
+    }
+
+    const double* xs = &iX_[start];
+    const double* ys = &iY_[start * columns_];
+    int num = starti - start;
+
+    if (x == xs[num]) {
+        for (unsigned int j = 0; j < columns_; ++j) {
+            values[j] = ys[num * columns_ + j];
+        }
+        return;
+    }
+
+    double c[max_columns_][Interpolant::romberg_max_];
+    double d[max_columns_][Interpolant::romberg_max_];
+
+    for (int i = 0; i < romberg_; ++i) {
+        for (unsigned int j = 0; j < columns_; ++j) {
+            c[j][i] = ys[i * columns_ + j];
+            d[j][i] = c[j][i];
+        }
+    }
+
+    bool dd;
+    if (num == 0) {
+        dd = true;
+    } else if (num == romberg_ - 1) {
+        dd = false;
+    } else {
+        dd = ((x - xs[num - 1]) > (xs[num + 1] - x)) == (xs[num + 1] > xs[num - 1]);
+    }
+
+    for (unsigned int j = 0; j < columns_; ++j) {
+        values[j] = ys[num * columns_ + j];
+    }
+
+    for (int k = 1; k < romberg_; ++k) {
+        for (int i = 0; i < romberg_ - k; ++i) {
+            double dx1 = xs[i] - x;
+            double dx2 = xs[i + k] - x;
+
+            for (unsigned int j = 0; j < columns_; ++j) {
+                double diff = c[j][i + 1] - d[j][i];
+                double denominator;
+
+                if (rational_) {
+                    double ratio = d[j][i] * dx1 / dx2;
+                    denominator = ratio - c[j][i + 1];
+
+                    if (denominator != 0) {
+                        diff = diff / denominator;
+                        d[j][i] = c[j][i + 1] * diff;
+                        c[j][i] = ratio * diff;
+                    } else {
+                        c[j][i] = 0;
+                        d[j][i] = 0;
+                    }
+                } else {
+                    denominator = dx1 - dx2;
+
+                    if (denominator != 0) {
+                        diff = diff / denominator;
+                        c[j][i] = dx1 * diff;
+                        d[j][i] = dx2 * diff;
+                    } else {
+                        c[j][i] = 0;
+                        d[j][i] = 0;
+                    }
+                }
+            }
+        }
+
+        if (num == 0) {
+            dd = true;
+        }
+
+        if (num == romberg_ - k) {
+            dd = false;
+        }
+
+        if (dd) {
+            for (unsigned int j = 0; j < columns_; ++j) {
+                values[j] += c[j][num];
+            }
+        } else {
+            num--;
+            for (unsigned int j = 0; j < columns_; ++j) {
+                values[j] += d[j][num];
+            }
+        }
+
+        dd = !dd;
+    }
+}
+
+/******************************************************************************
+ *                           Fused Interpolant Cache                          *
+ ******************************************************************************/
+
+FusedInterpolantCache::FusedInterpolantCache(std::shared_ptr<const FusedInterpolant> table)
+    : table_(table)
+    , newest_(0)
+    , values_(2 * table->GetNumberOfColumns())
+{
+    // NaN never compares equal, so both slots start empty
+    x_[0] = std::numeric_limits<double>::quiet_NaN();
+    x_[1] = std::numeric_limits<double>::quiet_NaN();
+}
+
+FusedInterpolantCache::FusedInterpolantCache(const FusedInterpolantCache& cache)
+    : FusedInterpolantCache(cache.table_)
+{
+}
+
+double FusedInterpolantCache::Interpolate(double x, unsigned int column)
+{
+    unsigned int columns = table_->GetNumberOfColumns();
+
+    if (x == x_[newest_]) {
+        return values_[newest_ * columns + column];
+    }
+
+    int other = 1 - newest_;
+    if (x != x_[other]) {
+        table_->Interpolate(x, &values_[other * columns]);
+        x_[other] = x;
+    }
+    newest_ = other;
+
+    return values_[newest_ * columns + column];
+}
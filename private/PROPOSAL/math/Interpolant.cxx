@@ -26,6 +26,7 @@
 #include <algorithm>
 #include <cmath>
 #include <fstream>
+#include <limits>
 #include <sstream>
 
 #include "PROPOSAL/math/Interpolant.h"
@@ -42,26 +43,25 @@ const double Interpolant::aBigNumber_ = -299;
 //----------------------------------------------------------------------------//
 //----------------------------------------------------------------------------//
 
-double Interpolant::Interpolate(double x)
+double Interpolant::Interpolate(double x) const
 {
-    int start;
+    int start, starti;
     double result, aux;
 
     if (isLog_)
     {
-        x = Slog(x);
+        x = Log(x);
     }
 
-    reverse_ = true;
-    aux      = (x - xmin_) / step_;
-    starti_  = (int)aux;
+    aux    = (x - xmin_) / step_;
+    starti = (int)aux;
 
-    if (starti_ < 0)
+    if (starti < 0)
     {
-        starti_ = 0;
-    } else if (starti_ >= max_)
+        starti = 0;
+    } else if (starti >= max_)
     {
-        starti_ = max_ - 1;
+        starti = max_ - 1;
     }
 
     start = (int)(aux - 0.5 * (romberg_ - 1));
@@ -73,7 +73,8 @@ double Interpolant::Interpolate(double x)
     {
         start = max_ - romberg_;
     }
-    result = Interpolate(x, start);
+
+    result = Interpolate(x, &GetX()[start], &GetY()[start], romberg_, starti - start, rational_, true);
 
     if (logSubst_)
     {
@@ -89,27 +90,26 @@ double Interpolant::Interpolate(double x)
 //----------------------------------------------------------------------------//
 //----------------------------------------------------------------------------//
 
-double Interpolant::Interpolate(double x1, double x2)
+double Interpolant::Interpolate(double x1, double x2) const
 {
-    int i, start;
-    double aux, aux2 = 0, result;
+    int i, start, starti;
+    double aux, result;
+    double sub_values[romberg_max_];
 
     if (isLog_)
     {
         x2 = std::log(x2);
     }
 
-    reverse_ = true;
-
-    aux     = (x2 - xmin_) / step_;
-    starti_ = (int)aux;
+    aux    = (x2 - xmin_) / step_;
+    starti = (int)aux;
 
-    if (starti_ < 0)
+    if (starti < 0)
     {
-        starti_ = 0;
-    } else if (starti_ >= max_)
+        starti = 0;
+    } else if (starti >= max_)
     {
-        starti_ = max_ - 1;
+        starti = max_ - 1;
     }
 
     start = (int)(aux - 0.5 * (romberg_ - 1));
@@ -122,32 +122,12 @@ double Interpolant::Interpolate(double x1, double x2)
         start = max_ - romberg_;
     }
 
-    for (i = start; i < start + romberg_; i++)
+    for (i = 0; i < romberg_; i++)
     {
-        iY_.at(i) = Interpolant_.at(i)->Interpolate(x1);
-    }
-
-    if (!fast_)
-    {
-        aux = 0;
-
-        for (i = start; i < start + romberg_; i++)
-        {
-            if (Interpolant_.at(i)->precision_ > aux)
-            {
-                aux  = Interpolant_.at(i)->precision_;
-                aux2 = Interpolant_.at(i)->worstX_;
-            }
-        }
-
-        if (aux > precision2_)
-        {
-            precision2_ = aux;
-            worstX2_    = aux2;
-        }
+        sub_values[i] = Interpolant_[start + i]->Interpolate(x1);
     }
 
-    result = Interpolate(x2, start);
+    result = Interpolate(x2, &GetX()[start], sub_values, romberg_, starti - start, rational_, true);
 
     if (logSubst_)
     {
@@ -160,21 +140,20 @@ double Interpolant::Interpolate(double x1, double x2)
 //----------------------------------------------------------------------------//
 //----------------------------------------------------------------------------//
 
-double Interpolant::InterpolateArray(double x)
+double Interpolant::InterpolateArray(double x) const
 {
-    int i, j, m, start, auxdir;
+    int i, j, m, start, starti, auxdir;
     bool dir;
 
-    reverse_ = false;
-    i        = 0;
-    j        = max_ - 1;
-    dir      = iX_.at(max_ - 1) > iX_.at(0);
+    i   = 0;
+    j   = max_ - 1;
+    dir = GetX()[max_ - 1] > GetX()[0];
 
     while (j - i > 1)
     {
         m = (i + j) / 2;
 
-        if ((x > iX_.at(m)) == dir)
+        if ((x > GetX()[m]) == dir)
         {
             i = m;
         } else
@@ -185,7 +164,7 @@ double Interpolant::InterpolateArray(double x)
 
     if (i + 1 < max_)
     {
-        if (((x - iX_.at(i)) < (iX_.at(i + 1) - x)) == dir)
+        if (((x - GetX()[i]) < (GetX()[i + 1] - x)) == dir)
         {
             auxdir = 0;
         } else
@@ -197,8 +176,8 @@ double Interpolant::InterpolateArray(double x)
         auxdir = 0;
     }
 
-    starti_ = i + auxdir;
-    start   = i - (int)(0.5 * (romberg_ - 1 - auxdir));
+    starti = i + auxdir;
+    start  = i - (int)(0.5 * (romberg_ - 1 - auxdir));
 
     if (start < 0)
     {
@@ -210,27 +189,27 @@ double Interpolant::InterpolateArray(double x)
         start = max_ - romberg_;
     }
 
-    return Interpolate(x, start);
+    return Interpolate(x, &GetX()[start], &GetY()[start], romberg_, starti - start, rational_, false);
 }
 
 //----------------------------------------------------------------------------//
 //----------------------------------------------------------------------------//
 
-double Interpolant::InterpolateArray(double x1, double x2)
+double Interpolant::InterpolateArray(double x1, double x2) const
 {
-    int i, j, m, start, auxdir, aux, aux2;
+    int i, j, m, start, starti, auxdir;
     bool dir;
+    double sub_values[romberg_max_];
 
-    reverse_ = false;
-    i        = 0;
-    j        = max_ - 1;
-    dir      = iX_.at(max_ - 1) > iX_.at(0);
+    i   = 0;
+    j   = max_ - 1;
+    dir = GetX()[max_ - 1] > GetX()[0];
 
     while (j - i > 1)
     {
         m = (i + j) / 2;
 
-        if ((x1 > iX_.at(m)) == dir)
+        if ((x1 > GetX()[m]) == dir)
         {
             i = m;
         } else
@@ -241,7 +220,7 @@ double Interpolant::InterpolateArray(double x1, double x2)
 
     if (i + 1 < max_)
     {
-        if (((x1 - iX_.at(i)) < (iX_.at(i + 1) - x1)) == dir)
+        if (((x1 - GetX()[i]) < (GetX()[i + 1] - x1)) == dir)
         {
             auxdir = 0;
         } else
@@ -253,8 +232,8 @@ double Interpolant::InterpolateArray(double x1, double x2)
         auxdir = 0;
     }
 
-    starti_ = i + auxdir;
-    start   = i - (int)(0.5 * (romberg_ - 1 - auxdir));
+    starti = i + auxdir;
+    start  = i - (int)(0.5 * (romberg_ - 1 - auxdir));
 
     if (start < 0)
     {
@@ -266,49 +245,23 @@ double Interpolant::InterpolateArray(double x1, double x2)
         start = max_ - romberg_;
     }
 
-    for (i = start; i < start + romberg_; i++)
+    for (i = 0; i < romberg_; i++)
     {
-        iY_.at(i) = Interpolant_.at(i)->InterpolateArray(x2);
+        sub_values[i] = Interpolant_[start + i]->InterpolateArray(x2);
     }
 
-    if (!fast_)
-    {
-        aux = 0;
-        aux2 = 0;
-
-        for (i = start; i < start + romberg_; i++)
-        {
-            if (Interpolant_.at(i)->precision_ > aux)
-            {
-                aux  = Interpolant_.at(i)->precision_;
-                aux2 = Interpolant_.at(i)->worstX_;
-            }
-        }
-
-        if (aux > precision2_)
-        {
-            precision2_ = aux;
-            worstX2_    = aux2;
-        }
-    }
-
-    double result = Interpolate(x1, start);
-
-    return result;
+    return Interpolate(x1, &GetX()[start], sub_values, romberg_, starti - start, rational_, false);
 }
 
 //----------------------------------------------------------------------------//
 //----------------------------------------------------------------------------//
 
-double Interpolant::FindLimit(double y)
+double Interpolant::FindLimit(double y) const
 {
-    int i, j, m, start, auxdir;
-    bool dir, rat, rel;
+    int i, j, m, start, starti, auxdir;
+    bool dir;
     double result;
 
-    rat      = false;
-    reverse_ = false;
-
     if (logSubst_)
     {
         y = Log(y);
@@ -316,13 +269,13 @@ double Interpolant::FindLimit(double y)
 
     i   = 0;
     j   = max_ - 1;
-    dir = iY_.at(max_ - 1) > iY_.at(0);
+    dir = GetY()[max_ - 1] > GetY()[0];
 
     while (j - i > 1)
     {
         m = (i + j) / 2;
 
-        if ((y > iY_.at(m)) == dir)
+        if ((y > GetY()[m]) == dir)
         {
             i = m;
         } else
@@ -331,24 +284,12 @@ double Interpolant::FindLimit(double y)
         }
     }
 
-    iX_.swap(iY_);
-    if (!fast_)
-    {
-        std::swap(precision_, precisionY_);
-        std::swap(worstX_, worstY_);
-
-        rat       = rational_;
-        rational_ = rationalY_;
-    }
-
-    std::swap(romberg_, rombergY_);
-
-    rel       = relative_;
-    relative_ = relativeY_;
-
+    // The inverse interpolation reads the tables with the roles of x and y
+    // exchanged. Only the slow mode switches to the rational flag of the
+    // inverse, this is kept for compatibility with existing results.
     if (i + 1 < max_)
     {
-        if (((y - iX_.at(i)) < (iX_.at(i + 1) - y)) == dir)
+        if (((y - GetY()[i]) < (GetY()[i + 1] - y)) == dir)
         {
             auxdir = 0;
         } else
@@ -360,34 +301,21 @@ double Interpolant::FindLimit(double y)
         auxdir = 0;
     }
 
-    starti_ = i + auxdir;
-    start   = i - (int)(0.5 * (romberg_ - 1 - auxdir));
+    starti = i + auxdir;
+    start  = i - (int)(0.5 * (rombergY_ - 1 - auxdir));
 
     if (start < 0)
     {
         start = 0;
     }
 
-    if (start + romberg_ > max_ || start > max_)
-    {
-        start = max_ - romberg_;
-    }
-
-    result = Interpolate(y, start);
-
-    iX_.swap(iY_);
-
-    if (!fast_)
+    if (start + rombergY_ > max_ || start > max_)
     {
-        std::swap(precision_, precisionY_);
-        std::swap(worstX_, worstY_);
-
-        rational_ = rat;
+        start = max_ - rombergY_;
     }
 
-    std::swap(romberg_, rombergY_);
-
-    relative_ = rel;
+    result = Interpolate(
+        y, &GetY()[start], &GetX()[start], rombergY_, starti - start, fast_ ? rational_ : rationalY_, false);
 
     if (result < xmin_)
     {
@@ -408,49 +336,28 @@ double Interpolant::FindLimit(double y)
 //----------------------------------------------------------------------------//
 //----------------------------------------------------------------------------//
 
-double Interpolant::FindLimit(double x1, double y)
+double Interpolant::FindLimit(double x1, double y) const
 {
-    int i, j, m, start, auxdir;
+    int i, j, m, start, starti, auxdir;
     bool dir;
-    double result, aux, aux2 = 0;
-
-    reverse_ = false;
+    double result, aux;
+    double sub_values[romberg_max_];
 
     if (logSubst_)
     {
         y = Log(y);
     }
 
-    if (!flag_)
-    {
-        for (i = 0; i < max_; i++)
-        {
-            iY_.at(i) = Interpolant_.at(i)->Interpolate(x1);
-        }
-    }
-
-    i = 0;
-    j = max_ - 1;
-
-    if (flag_)
-    {
-        dir = Interpolant_.at(max_ - 1)->Interpolate(x1) > Interpolant_.at(0)->Interpolate(x1);
-    } else
-    {
-        dir = iY_.at(max_ - 1) > iY_.at(0);
-    }
+    // The values f(x1, iX[i]) of the sub interpolants are only evaluated
+    // where the bisection and the romberg vicinity actually need them.
+    i   = 0;
+    j   = max_ - 1;
+    dir = Interpolant_[max_ - 1]->Interpolate(x1) > Interpolant_[0]->Interpolate(x1);
 
     while (j - i > 1)
     {
-        m = (i + j) / 2;
-
-        if (flag_)
-        {
-            aux = Interpolant_.at(m)->Interpolate(x1);
-        } else
-        {
-            aux = iY_.at(m);
-        }
+        m   = (i + j) / 2;
+        aux = Interpolant_[m]->Interpolate(x1);
 
         if ((y > aux) == dir)
         {
@@ -461,27 +368,9 @@ double Interpolant::FindLimit(double x1, double y)
         }
     }
 
-    iX_.swap(iY_);
-
-    if (!fast_)
-    {
-        std::swap(precision_, precisionY_);
-        std::swap(worstX_, worstY_);
-        std::swap(rational_, rationalY_);
-    }
-
-    std::swap(romberg_, rombergY_);
-    std::swap(relative_, relativeY_);
-
     if (i + 1 < max_)
     {
-        // iX_ is not pre-filled if flag is true. Fill the bits we're about to use.
-        if (flag_)
-        {
-            iX_.at(i) = Interpolant_.at(i)->Interpolate(x1);
-            iX_.at(i+1) = Interpolant_.at(i+1)->Interpolate(x1);
-        }
-        if (((y - iX_.at(i)) < (iX_.at(i + 1) - y)) == dir)
+        if (((y - Interpolant_[i]->Interpolate(x1)) < (Interpolant_[i + 1]->Interpolate(x1) - y)) == dir)
         {
             auxdir = 0;
         } else
@@ -493,40 +382,26 @@ double Interpolant::FindLimit(double x1, double y)
         auxdir = 0;
     }
 
-    starti_ = i + auxdir;
-    start   = i - (int)(0.5 * (romberg_ - 1 - auxdir));
+    starti = i + auxdir;
+    start  = i - (int)(0.5 * (rombergY_ - 1 - auxdir));
 
     if (start < 0)
     {
         start = 0;
     }
 
-    if (start + romberg_ > max_ || start > max_)
-    {
-        start = max_ - romberg_;
-    }
-
-    if (flag_)
+    if (start + rombergY_ > max_ || start > max_)
     {
-        for (i = start; i < start + romberg_; i++)
-        {
-            iX_.at(i) = Interpolant_.at(i)->Interpolate(x1);
-        }
+        start = max_ - rombergY_;
     }
 
-    result = Interpolate(y, start);
-
-    iX_.swap(iY_);
-
-    if (!fast_)
+    for (i = 0; i < rombergY_; i++)
     {
-        std::swap(precision_, precisionY_);
-        std::swap(worstX_, worstY_);
-        std::swap(rational_, rationalY_);
+        sub_values[i] = Interpolant_[start + i]->Interpolate(x1);
     }
 
-    std::swap(romberg_, rombergY_);
-    std::swap(relative_, relativeY_);
+    result = Interpolate(
+        y, sub_values, &GetX()[start], rombergY_, starti - start, fast_ ? rational_ : rationalY_, false);
 
     if (result < xmin_)
     {
@@ -536,26 +411,6 @@ double Interpolant::FindLimit(double x1, double y)
         result = xmax_;
     }
 
-    if (!fast_)
-    {
-        aux = 0;
-
-        for (i = start; i < start + romberg_; i++)
-        {
-            if (Interpolant_.at(i)->precision_ > aux)
-            {
-                aux  = Interpolant_.at(i)->precision_;
-                aux2 = Interpolant_.at(i)->worstX_;
-            }
-        }
-
-        if (aux > precision2_)
-        {
-            precision2_ = aux;
-            worstX2_    = aux2;
-        }
-    }
-
     if (isLog_)
     {
         result = std::exp(result);
@@ -581,7 +436,7 @@ bool Interpolant::Save(std::string Path, bool binary_tables)
 
         out.open(ss.str().c_str());
 
-        out.precision(16);
+        out.precision(std::numeric_limits<double>::max_digits10);
 
         if (!out.good())
         {
@@ -609,7 +464,7 @@ bool Interpolant::Save(std::string Path, bool binary_tables)
 //----------------------------------------------------------------------------//
 //----------------------------------------------------------------------------//
 
-bool Interpolant::Save(std::ofstream& out, bool binary_tables)
+bool Interpolant::Save(std::ostream& out, bool binary_tables)
 {
     if (!out.good())
     {
@@ -651,7 +506,7 @@ bool Interpolant::Save(std::ofstream& out, bool binary_tables)
 
             for (int i = 0; i < max_; i++)
             {
-                out.write(reinterpret_cast<char*>(&iX_.at(i)), sizeof iX_.at(i));
+                out.write(reinterpret_cast<const char*>(&GetX()[i]), sizeof(double));
                 Interpolant_.at(i)->Save(out, binary_tables);
             }
         } else
@@ -682,8 +537,8 @@ bool Interpolant::Save(std::ofstream& out, bool binary_tables)
 
             for (int i = 0; i < max_; i++)
             {
-                out.write(reinterpret_cast<char*>(&iX_.at(i)), sizeof iX_.at(i));
-                out.write(reinterpret_cast<char*>(&iY_.at(i)), sizeof iY_.at(i));
+                out.write(reinterpret_cast<const char*>(&GetX()[i]), sizeof(double));
+                out.write(reinterpret_cast<const char*>(&GetY()[i]), sizeof(double));
             }
         }
     } else
@@ -704,7 +559,7 @@ bool Interpolant::Save(std::ofstream& out, bool binary_tables)
 
             for (int i = 0; i < max_; i++)
             {
-                out << iX_.at(i) << std::endl;
+                out << GetX()[i] << std::endl;
                 Interpolant_.at(i)->Save(out, binary_tables);
             }
         } else
@@ -721,7 +576,7 @@ bool Interpolant::Save(std::ofstream& out, bool binary_tables)
 
             for (int i = 0; i < max_; i++)
             {
-                out << iX_.at(i) << "\t" << iY_.at(i) << std::endl;
+                out << GetX()[i] << "\t" << GetY()[i] << std::endl;
             }
         }
     }
@@ -757,7 +612,7 @@ bool Interpolant::Load(std::string Path, bool binary_tables)
 //----------------------------------------------------------------------------//
 //----------------------------------------------------------------------------//
 
-bool Interpolant::Load(std::ifstream& in, bool binary_tables)
+bool Interpolant::Load(std::istream& in, bool binary_tables)
 {
     bool D2;
 
@@ -890,8 +745,6 @@ Interpolant::Interpolant()
     , rombergY_(1.)
     , iX_()
     , iY_()
-    , c_()
-    , d_()
     , max_(1.)
     , xmin_(1.)
     , xmax_(1.)
@@ -902,23 +755,16 @@ Interpolant::Interpolant()
     , function2d_(NULL)
     , Interpolant_()
     , row_(0)
-    , starti_(0)
     , rationalY_(false)
     , relativeY_(false)
-    , reverse_(false)
     , self_(true)
     , flag_(false)
     , isLog_(false)
     , logSubst_(false)
-    , precision_(0)
-    , worstX_(0)
-    , precision2_(0)
-    , worstX2_(0)
-    , precisionY_(0)
-    , worstY_(0)
     , fast_(true)
-    , x_save_(0)
-    , y_save_(0)
+    , table_file_()
+    , mapped_x_(NULL)
+    , mapped_y_(NULL)
 {
 }
 
@@ -930,8 +776,6 @@ Interpolant::Interpolant(const Interpolant& interpolant)
     , rombergY_(interpolant.rombergY_)
     , iX_(interpolant.iX_)
     , iY_(interpolant.iY_)
-    , c_(interpolant.c_)
-    , d_(interpolant.d_)
     , max_(interpolant.max_)
     , xmin_(interpolant.xmin_)
     , xmax_(interpolant.xmax_)
@@ -939,23 +783,16 @@ Interpolant::Interpolant(const Interpolant& interpolant)
     , rational_(interpolant.rational_)
     , relative_(interpolant.relative_)
     , row_(interpolant.row_)
-    , starti_(interpolant.starti_)
     , rationalY_(interpolant.rationalY_)
     , relativeY_(interpolant.relativeY_)
-    , reverse_(interpolant.reverse_)
     , self_(interpolant.self_)
     , flag_(interpolant.flag_)
     , isLog_(interpolant.isLog_)
     , logSubst_(interpolant.logSubst_)
-    , precision_(interpolant.precision_)
-    , worstX_(interpolant.worstX_)
-    , precision2_(interpolant.precision2_)
-    , worstX2_(interpolant.worstX2_)
-    , precisionY_(interpolant.precisionY_)
-    , worstY_(interpolant.worstY_)
     , fast_(interpolant.fast_)
-    , x_save_(interpolant.x_save_)
-    , y_save_(interpolant.y_save_)
+    , table_file_(interpolant.table_file_)
+    , mapped_x_(interpolant.mapped_x_)
+    , mapped_y_(interpolant.mapped_y_)
 
 {
     Interpolant_.resize(interpolant.Interpolant_.size());
@@ -988,8 +825,6 @@ Interpolant::Interpolant(int max,
     , rombergY_(1.)
     , iX_()
     , iY_()
-    , c_()
-    , d_()
     , max_(1.)
     , xmin_(1.)
     , xmax_(1.)
@@ -1000,23 +835,16 @@ Interpolant::Interpolant(int max,
     , function2d_(NULL)
     , Interpolant_()
     , row_(0)
-    , starti_(0)
     , rationalY_(false)
     , relativeY_(false)
-    , reverse_(false)
     , self_(true)
     , flag_(false)
     , isLog_(false)
     , logSubst_(false)
-    , precision_(0)
-    , worstX_(0)
-    , precision2_(0)
-    , worstX2_(0)
-    , precisionY_(0)
-    , worstY_(0)
     , fast_(true)
-    , x_save_(1)
-    , y_save_(0)
+    , table_file_()
+    , mapped_x_(NULL)
+    , mapped_y_(NULL)
 {
     InitInterpolant(max, xmin, xmax, romberg, rational, relative, isLog, rombergY, rationalY, relativeY, logSubst);
 
@@ -1076,8 +904,6 @@ Interpolant::Interpolant(int max1,
     , rombergY_(1.)
     , iX_()
     , iY_()
-    , c_()
-    , d_()
     , max_(1.)
     , xmin_(1.)
     , xmax_(1.)
@@ -1088,23 +914,16 @@ Interpolant::Interpolant(int max1,
     , function2d_(NULL)
     , Interpolant_()
     , row_(0)
-    , starti_(0)
     , rationalY_(false)
     , relativeY_(false)
-    , reverse_(false)
     , self_(true)
     , flag_(false)
     , isLog_(false)
     , logSubst_(false)
-    , precision_(0)
-    , worstX_(0)
-    , precision2_(0)
-    , worstX2_(0)
-    , precisionY_(0)
-    , worstY_(0)
     , fast_(true)
-    , x_save_(1)
-    , y_save_(0)
+    , table_file_()
+    , mapped_x_(NULL)
+    , mapped_y_(NULL)
 {
     InitInterpolant(
         max2, x2min, x2max, romberg2, rational2, relative2, isLog2, rombergY, rationalY, relativeY, logSubst);
@@ -1137,8 +956,6 @@ Interpolant::Interpolant(int max1,
 
         Interpolant_.at(i)->self_ = false;
     }
-
-    precision2_ = 0;
 }
 
 //----------------------------------------------------------------------------//
@@ -1149,8 +966,6 @@ Interpolant::Interpolant(std::vector<double> x, std::vector<double> y, int rombe
     , rombergY_(1.)
     , iX_()
     , iY_()
-    , c_()
-    , d_()
     , max_(1.)
     , xmin_(1.)
     , xmax_(1.)
@@ -1161,23 +976,16 @@ Interpolant::Interpolant(std::vector<double> x, std::vector<double> y, int rombe
     , function2d_(NULL)
     , Interpolant_()
     , row_(0)
-    , starti_(0)
     , rationalY_(false)
     , relativeY_(false)
-    , reverse_(false)
     , self_(true)
     , flag_(false)
     , isLog_(false)
     , logSubst_(false)
-    , precision_(0)
-    , worstX_(0)
-    , precision2_(0)
-    , worstX2_(0)
-    , precisionY_(0)
-    , worstY_(0)
     , fast_(true)
-    , x_save_(1)
-    , y_save_(0)
+    , table_file_()
+    , mapped_x_(NULL)
+    , mapped_y_(NULL)
 {
     InitInterpolant(std::min(x.size(), y.size()),
                     x.at(0),
@@ -1216,8 +1024,6 @@ Interpolant::Interpolant(std::vector<double> x1, std::vector<double> x2, std::ve
         , iX_()
         , iY_()
         , iY2_()
-        , c_()
-        , d_()
         , max_(1.)
         , xmin_(1.)
         , xmax_(1.)
@@ -1228,23 +1034,16 @@ Interpolant::Interpolant(std::vector<double> x1, std::vector<double> x2, std::ve
         , function2d_(NULL)
         , Interpolant_()
         , row_(0)
-        , starti_(0)
         , rationalY_(false)
         , relativeY_(false)
-        , reverse_(false)
         , self_(true)
         , flag_(false)
         , isLog_(false)
         , logSubst_(false)
-        , precision_(0)
-        , worstX_(0)
-        , precision2_(0)
-        , worstX2_(0)
-        , precisionY_(0)
-        , worstY_(0)
         , fast_(true)
-        , x_save_(1)
-        , y_save_(0)
+        , table_file_()
+        , mapped_x_(NULL)
+        , mapped_y_(NULL)
 {
 
     //TODO: Not sure what is happening in the romberg=0 case
@@ -1307,8 +1106,6 @@ Interpolant::Interpolant(std::vector<double> x1, std::vector<double> x2, std::ve
 
         Interpolant_.at(i)->self_ = false;
     }
-
-    precision2_ = 0;
 }
 
 //----------------------------------------------------------------------------//
@@ -1319,8 +1116,6 @@ Interpolant::Interpolant(std::vector<double> x1, std::vector< std::vector<double
         , rombergY_(1.)
         , iX_()
         , iY_()
-        , c_()
-        , d_()
         , max_(1.)
         , xmin_(1.)
         , xmax_(1.)
@@ -1331,23 +1126,16 @@ Interpolant::Interpolant(std::vector<double> x1, std::vector< std::vector<double
         , function2d_(NULL)
         , Interpolant_()
         , row_(0)
-        , starti_(0)
         , rationalY_(false)
         , relativeY_(false)
-        , reverse_(false)
         , self_(true)
         , flag_(false)
         , isLog_(false)
         , logSubst_(false)
-        , precision_(0)
-        , worstX_(0)
-        , precision2_(0)
-        , worstX2_(0)
-        , precisionY_(0)
-        , worstY_(0)
         , fast_(true)
-        , x_save_(1)
-        , y_save_(0)
+        , table_file_()
+        , mapped_x_(NULL)
+        , mapped_y_(NULL)
 {
 
     //TODO: Not sure what is happening in the romberg=0 case
@@ -1417,8 +1205,6 @@ Interpolant::Interpolant(std::vector<double> x1, std::vector< std::vector<double
 
         Interpolant_.at(i)->self_ = false;
     }
-
-    precision2_ = 0;
 }
 
 //----------------------------------------------------------------------------//
@@ -1442,6 +1228,9 @@ Interpolant& Interpolant::operator=(const Interpolant& interpolant)
 
 bool Interpolant::operator==(const Interpolant& interpolant) const
 {
+    // Shared tables are equal without comparing every node
+    if (this == &interpolant)
+        return true;
     if (romberg_ != interpolant.romberg_)
         return false;
     if (rombergY_ != interpolant.rombergY_)
@@ -1460,14 +1249,10 @@ bool Interpolant::operator==(const Interpolant& interpolant) const
         return false;
     if (row_ != interpolant.row_)
         return false;
-    if (starti_ != interpolant.starti_)
-        return false;
     if (rationalY_ != interpolant.rationalY_)
         return false;
     if (relativeY_ != interpolant.relativeY_)
         return false;
-    if (reverse_ != interpolant.reverse_)
-        return false;
     if (self_ != interpolant.self_)
         return false;
     if (flag_ != interpolant.flag_)
@@ -1476,55 +1261,25 @@ bool Interpolant::operator==(const Interpolant& interpolant) const
         return false;
     if (logSubst_ != interpolant.logSubst_)
         return false;
-    if (precision_ != interpolant.precision_)
-        return false;
-    if (worstX_ != interpolant.worstX_)
-        return false;
-    if (precision2_ != interpolant.precision2_)
-        return false;
-    if (worstX2_ != interpolant.worstX2_)
-        return false;
-    if (precisionY_ != interpolant.precisionY_)
-        return false;
-    if (worstY_ != interpolant.worstY_)
-        return false;
     if (fast_ != interpolant.fast_)
         return false;
-    if (x_save_ != interpolant.x_save_)
-        return false;
-    if (y_save_ != interpolant.y_save_)
-        return false;
 
-    if (iX_.size() != interpolant.iX_.size())
-        return false;
-    if (iY_.size() != interpolant.iY_.size())
-        return false;
-    if (c_.size() != interpolant.c_.size())
+    if (GetNumberOfX() != interpolant.GetNumberOfX())
         return false;
-    if (d_.size() != interpolant.d_.size())
+    if (GetNumberOfY() != interpolant.GetNumberOfY())
         return false;
 
     if (Interpolant_.size() != interpolant.Interpolant_.size())
         return false;
 
-    for (unsigned int i = 0; i < iX_.size(); i++)
-    {
-        if (iX_.at(i) != interpolant.iX_.at(i))
-            return false;
-    }
-    for (unsigned int i = 0; i < iY_.size(); i++)
+    for (int i = 0; i < GetNumberOfX(); i++)
     {
-        if (iY_.at(i) != interpolant.iY_.at(i))
+        if (GetX()[i] != interpolant.GetX()[i])
             return false;
     }
-    for (unsigned int i = 0; i < c_.size(); i++)
+    for (int i = 0; i < GetNumberOfY(); i++)
     {
-        if (c_.at(i) != interpolant.c_.at(i))
-            return false;
-    }
-    for (unsigned int i = 0; i < d_.size(); i++)
-    {
-        if (d_.at(i) != interpolant.d_.at(i))
+        if (GetY()[i] != interpolant.GetY()[i])
             return false;
     }
     for (unsigned int i = 0; i < interpolant.Interpolant_.size(); i++)
@@ -1561,29 +1316,20 @@ void Interpolant::swap(Interpolant& interpolant)
     swap(rational_, interpolant.rational_);
     swap(relative_, interpolant.relative_);
     swap(row_, interpolant.row_);
-    swap(starti_, interpolant.starti_);
     swap(rationalY_, interpolant.rationalY_);
     swap(relativeY_, interpolant.relativeY_);
-    swap(reverse_, interpolant.reverse_);
     swap(self_, interpolant.self_);
     swap(flag_, interpolant.flag_);
     swap(isLog_, interpolant.isLog_);
     swap(logSubst_, interpolant.logSubst_);
-    swap(precision_, interpolant.precision_);
-    swap(worstX_, interpolant.worstX_);
-    swap(precision2_, interpolant.precision2_);
-    swap(worstX2_, interpolant.worstX2_);
-    swap(precisionY_, interpolant.precisionY_);
-    swap(worstY_, interpolant.worstY_);
     swap(fast_, interpolant.fast_);
-    swap(x_save_, interpolant.x_save_);
-    swap(y_save_, interpolant.y_save_);
 
     iX_.swap(interpolant.iX_);
     iY_.swap(interpolant.iY_);
 
-    c_.swap(interpolant.c_);
-    d_.swap(interpolant.d_);
+    table_file_.swap(interpolant.table_file_);
+    swap(mapped_x_, interpolant.mapped_x_);
+    swap(mapped_y_, interpolant.mapped_y_);
 
     Interpolant_.swap(interpolant.Interpolant_);
 }
@@ -1607,10 +1353,8 @@ void Interpolant::InitInterpolant(int max,
                                   bool logSubst)
 {
 
-    self_   = true;
-    fast_   = true;
-    x_save_ = 1;
-    y_save_ = 0;
+    self_ = true;
+    fast_ = true;
 
     if (max <= 0)
     {
@@ -1647,6 +1391,12 @@ void Interpolant::InitInterpolant(int max,
         romberg = 1;
     }
 
+    if (romberg > romberg_max_)
+    {
+        log_warn("romberg = %i must be <= %i! setting to %i!", romberg, romberg_max_, romberg_max_);
+        romberg = romberg_max_;
+    }
+
     if (romberg > max)
     {
         log_warn("romberg = %i must be <= max = %i! setting to %i!", romberg, max, max);
@@ -1659,6 +1409,12 @@ void Interpolant::InitInterpolant(int max,
         rombergY = 1;
     }
 
+    if (rombergY > romberg_max_)
+    {
+        log_warn("rombergY = %i must be <= %i! setting to %i!", rombergY, romberg_max_, romberg_max_);
+        rombergY = romberg_max_;
+    }
+
     if (rombergY > max)
     {
         log_warn("rombergY = %i must be < %i! setting to %i!", rombergY, max, max);
@@ -1688,17 +1444,12 @@ void Interpolant::InitInterpolant(int max,
     this->romberg_  = romberg;
     this->rombergY_ = rombergY;
 
+    Unmap();
     iX_.resize(max);
     iY_.resize(max);
 
     step_ = (this->xmax_ - this->xmin_) / max;
 
-    int VectorMax_ = std::max(romberg, rombergY);
-
-    c_.resize(VectorMax_);
-    d_.resize(VectorMax_);
-
-    precision_       = 0;
     this->isLog_     = isLog;
     this->logSubst_  = logSubst;
     this->rational_  = rational;
@@ -1710,6 +1461,22 @@ void Interpolant::InitInterpolant(int max,
 //----------------------------------------------------------------------------//
 //----------------------------------------------------------------------------//
 
+void Interpolant::Unmap()
+{
+    if (table_file_)
+    {
+        iX_.assign(mapped_x_, mapped_x_ + max_);
+        iY_.assign(mapped_y_, mapped_y_ + max_);
+
+        table_file_.reset();
+        mapped_x_ = NULL;
+        mapped_y_ = NULL;
+    }
+}
+
+//----------------------------------------------------------------------------//
+//----------------------------------------------------------------------------//
+
 double Interpolant::Get2dFunctionFixedY(double x)
 {
     if (isLog_)
@@ -1724,22 +1491,30 @@ double Interpolant::Get2dFunctionFixedY(double x)
 //----------------------------------------------------------------------------//
 //----------------------------------------------------------------------------//
 
-double Interpolant::Interpolate(double x, int start)
+double Interpolant::Interpolate(double x,
+                                const double* xs,
+                                const double* ys,
+                                int romberg,
+                                int num,
+                                bool rational,
+                                bool reverse) const
 {
-    int num, i, k;
+    int i, k;
     bool dd, doLog;
     double error = 0, result = 0;
     double aux, aux2, dx1, dx2;
+    double c[romberg_max_];
+    double d[romberg_max_];
 
     doLog = false;
 
     if (logSubst_)
     {
-        if (reverse_)
+        if (reverse)
         {
-            for (i = 0; i < romberg_; i++)
+            for (i = 0; i < romberg; i++)
             {
-                if (iY_.at(start + i) == bigNumber_)
+                if (ys[i] == bigNumber_)
                 {
                     doLog = true;
                     break;
@@ -1750,40 +1525,38 @@ double Interpolant::Interpolate(double x, int start)
 
     if (fast_)
     {
-        num = starti_ - start;
-
-        if (x == iX_.at(starti_))
+        if (x == xs[num])
         {
-            return iY_.at(starti_);
+            return ys[num];
         }
 
         if (doLog)
         {
-            for (i = 0; i < romberg_; i++)
+            for (i = 0; i < romberg; i++)
             {
-                c_.at(i) = Exp(iY_.at(start + i));
-                d_.at(i) = c_.at(i);
+                c[i] = Exp(ys[i]);
+                d[i] = c[i];
             }
         } else
         {
-            for (i = 0; i < romberg_; i++)
+            for (i = 0; i < romberg; i++)
             {
-                c_.at(i) = iY_.at(start + i);
-                d_.at(i) = c_.at(i);
+                c[i] = ys[i];
+                d[i] = c[i];
             }
         }
     } else
     {
         num = 0;
-        aux = std::abs(x - iX_.at(start + 0));
+        aux = std::abs(x - xs[0]);
 
-        for (i = 0; i < romberg_; i++)
+        for (i = 0; i < romberg; i++)
         {
-            aux2 = std::abs(x - iX_.at(start + i));
+            aux2 = std::abs(x - xs[i]);
 
             if (aux2 == 0)
             {
-                return iY_.at(start + i);
+                return ys[i];
             }
 
             if (aux2 < aux)
@@ -1794,12 +1567,12 @@ double Interpolant::Interpolate(double x, int start)
 
             if (doLog)
             {
-                c_.at(i) = Exp(iY_.at(start + i));
-                d_.at(i) = c_.at(i);
+                c[i] = Exp(ys[i]);
+                d[i] = c[i];
             } else
             {
-                c_.at(i) = iY_.at(start + i);
-                d_.at(i) = c_.at(i);
+                c[i] = ys[i];
+                d[i] = c[i];
             }
         }
     }
@@ -1807,14 +1580,13 @@ double Interpolant::Interpolate(double x, int start)
     if (num == 0)
     {
         dd = true;
-    } else if (num == romberg_ - 1)
+    } else if (num == romberg - 1)
     {
         dd = false;
     } else
     {
-        k    = start + num;
-        aux  = iX_.at(k - 1);
-        aux2 = iX_.at(k + 1);
+        aux  = xs[num - 1];
+        aux2 = xs[num + 1];
 
         if (fast_)
         {
@@ -1837,50 +1609,50 @@ double Interpolant::Interpolate(double x, int start)
         }
     }
 
-    result = iY_.at(start + num);
+    result = ys[num];
 
     if (doLog)
     {
         result = Exp(result);
     }
 
-    for (k = 1; k < romberg_; k++)
+    for (k = 1; k < romberg; k++)
     {
-        for (i = 0; i < romberg_ - k; i++)
+        for (i = 0; i < romberg - k; i++)
         {
-            if (rational_)
+            if (rational)
             {
-                aux  = c_.at(i + 1) - d_.at(i);
-                dx2  = iX_.at(start + i + k) - x;
-                dx1  = d_.at(i) * (iX_.at(start + i) - x) / dx2;
-                aux2 = dx1 - c_.at(i + 1);
+                aux  = c[i + 1] - d[i];
+                dx2  = xs[i + k] - x;
+                dx1  = d[i] * (xs[i] - x) / dx2;
+                aux2 = dx1 - c[i + 1];
 
                 if (aux2 != 0)
                 {
-                    aux      = aux / aux2;
-                    d_.at(i) = c_.at(i + 1) * aux;
-                    c_.at(i) = dx1 * aux;
+                    aux  = aux / aux2;
+                    d[i] = c[i + 1] * aux;
+                    c[i] = dx1 * aux;
                 } else
                 {
-                    c_.at(i) = 0;
-                    d_.at(i) = 0;
+                    c[i] = 0;
+                    d[i] = 0;
                 }
             } else
             {
-                dx1  = iX_.at(start + i) - x;
-                dx2  = iX_.at(start + i + k) - x;
-                aux  = c_.at(i + 1) - d_.at(i);
+                dx1  = xs[i] - x;
+                dx2  = xs[i + k] - x;
+                aux  = c[i + 1] - d[i];
                 aux2 = dx1 - dx2;
 
                 if (aux2 != 0)
                 {
-                    aux      = aux / aux2;
-                    c_.at(i) = dx1 * aux;
-                    d_.at(i) = dx2 * aux;
+                    aux  = aux / aux2;
+                    c[i] = dx1 * aux;
+                    d[i] = dx2 * aux;
                 } else
                 {
-                    c_.at(i) = 0;
-                    d_.at(i) = 0;
+                    c[i] = 0;
+                    d[i] = 0;
                 }
             }
         }
@@ -1890,47 +1662,24 @@ double Interpolant::Interpolate(double x, int start)
             dd = true;
         }
 
-        if (num == romberg_ - k)
+        if (num == romberg - k)
         {
             dd = false;
         }
 
         if (dd)
         {
-            error = c_.at(num);
+            error = c[num];
         } else
         {
             num--;
-            error = d_.at(num);
+            error = d[num];
         }
 
         dd = !dd;
         result += error;
     }
 
-    if (!fast_)
-    {
-        if (relative_)
-        {
-            if (result != 0)
-            {
-                aux = std::abs(error / result);
-            } else
-            {
-                aux = 0;
-            }
-        } else
-        {
-            aux = std::abs(error);
-        }
-
-        if (aux > precision_)
-        {
-            precision_ = aux;
-            worstX_    = x;
-        }
-    }
-
     if (doLog)
     {
         result = Log(result);
@@ -1967,59 +1716,60 @@ double Interpolant::Log(double x)
     }
 }
 
-//----------------------------------------------------------------------------//
-//----------------------------------------------------------------------------//
-
-double Interpolant::Slog(double x)
-{
-    if (x == x_save_)
-    {
-        return y_save_;
-    } else
-    {
-        x_save_ = x;
-        y_save_ = Log(x_save_);
-
-        return y_save_;
-    }
-}
-
 //----------------------------------------------------------------------------//
 //----------------------------------------------------------------------------//
 //---------------------------------Setter-------------------------------------//
 //----------------------------------------------------------------------------//
 //----------------------------------------------------------------------------//
 
+// The interpolation keeps its scratch arrays of romberg_max_ values on the
+// stack, so the orders are clamped as in InitInterpolant
 void Interpolant::SetRombergY(int rombergY)
 {
+    if (rombergY <= 0)
+    {
+        log_warn("rombergY = %i must be > 0! setting to 1!", rombergY);
+        rombergY = 1;
+    }
+
+    if (rombergY > romberg_max_)
+    {
+        log_warn("rombergY = %i must be <= %i! setting to %i!", rombergY, romberg_max_, romberg_max_);
+        rombergY = romberg_max_;
+    }
+
     rombergY_ = rombergY;
 }
 
 void Interpolant::SetRomberg(int romberg)
 {
+    if (romberg <= 0)
+    {
+        log_warn("romberg = %i must be > 0! setting to 1!", romberg);
+        romberg = 1;
+    }
+
+    if (romberg > romberg_max_)
+    {
+        log_warn("romberg = %i must be <= %i! setting to %i!", romberg, romberg_max_, romberg_max_);
+        romberg = romberg_max_;
+    }
+
     romberg_ = romberg;
 }
 
 void Interpolant::SetIX(const std::vector<double>& iX)
 {
+    Unmap();
     iX_ = iX;
 }
 
 void Interpolant::SetIY(const std::vector<double>& iY)
 {
+    Unmap();
     iY_ = iY;
 }
 
-void Interpolant::SetC(const std::vector<double>& c)
-{
-    c_ = c;
-}
-
-void Interpolant::SetD(const std::vector<double>& d)
-{
-    d_ = d;
-}
-
 void Interpolant::SetMax(int max)
 {
     max_ = max;
@@ -2055,11 +1805,6 @@ void Interpolant::SetRow(int row)
     row_ = row;
 }
 
-void Interpolant::SetStarti(int starti)
-{
-    starti_ = starti;
-}
-
 void Interpolant::SetRationalY(bool rationalY)
 {
     rationalY_ = rationalY;
@@ -2080,11 +1825,6 @@ void Interpolant::SetFlag(bool flag)
     flag_ = flag;
 }
 
-void Interpolant::SetReverse(bool reverse)
-{
-    reverse_ = reverse;
-}
-
 void Interpolant::SetIsLog(bool isLog)
 {
     isLog_ = isLog;
@@ -2095,46 +1835,11 @@ void Interpolant::SetLogSubst(bool logSubst)
     logSubst_ = logSubst;
 }
 
-void Interpolant::SetPrecision(double precision)
-{
-    precision_ = precision;
-}
-
-void Interpolant::SetWorstX(double worstX)
-{
-    worstX_ = worstX;
-}
-
-void Interpolant::SetWorstX2(double worstX2)
-{
-    worstX2_ = worstX2;
-}
-
-void Interpolant::SetWorstY(double worstY)
-{
-    worstY_ = worstY;
-}
-
-void Interpolant::SetPrecisionY(double precisionY)
-{
-    precisionY_ = precisionY;
-}
-
 void Interpolant::SetFast(bool fast)
 {
     fast_ = fast;
 }
 
-void Interpolant::SetX_save(double x_save)
-{
-    x_save_ = x_save;
-}
-
-void Interpolant::SetY_save(double y_save)
-{
-    y_save_ = y_save;
-}
-
 //----------------------------------------------------------------------------//
 //----------------------------------------------------------------------------//
 //---------------------------------Destructor---------------------------------//
@@ -2145,8 +1850,6 @@ Interpolant::~Interpolant()
 {
     iX_.clear();
     iY_.clear();
-    c_.clear();
-    d_.clear();
 
     for (unsigned int i = 0; i < Interpolant_.size(); i++)
     {
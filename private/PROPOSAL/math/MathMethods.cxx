@@ -11,67 +11,110 @@
 
 namespace PROPOSAL {
 
+namespace {
+
+// Coefficients of the rational approximations of the inverse error function
+const double inverse_erf_a[] = {-3.969683028665376e+01, 2.209460984245205e+02,
+                                -2.759285104469687e+02, 1.383577518672690e+02,
+                                -3.066479806614716e+01, 2.506628277459239e+00};
+const double inverse_erf_b[] = {-5.447609879822406e+01, 1.615858368580409e+02,
+                                -1.556989798598866e+02, 6.680131188771972e+01,
+                                -1.328068155288572e+01};
+const double inverse_erf_c[] = {-7.784894002430293e-03, -3.223964580411365e-01,
+                                -2.400758277161838e+00, -2.549732539343734e+00,
+                                4.374664141464968e+00,  2.938163982698783e+00};
+const double inverse_erf_d[] = {7.784695709041462e-03, 3.224671290700398e-01,
+                                2.445134137142996e+00, 3.754408661907416e+00};
+const double inverse_erf_p_low = 0.02425;
+const double inverse_erf_p_high = 1 - inverse_erf_p_low;
+
+// Rational approximation for central region.
+inline double InverseErrorFunctionCentral(double p) {
+    const double* a_arr = inverse_erf_a;
+    const double* b_arr = inverse_erf_b;
+    double q = p - 0.5;
+    double r = q * q;
+    return (((((a_arr[0] * r + a_arr[1]) * r + a_arr[2]) * r + a_arr[3]) * r +
+             a_arr[4]) *
+                r +
+            a_arr[5]) *
+           q /
+           (((((b_arr[0] * r + b_arr[1]) * r + b_arr[2]) * r + b_arr[3]) * r +
+             b_arr[4]) *
+                r +
+            1);
+}
+
+// Rational approximation for lower region, the upper region is the
+// negative of it at 1 - p.
+inline double InverseErrorFunctionTail(double p) {
+    const double* c_arr = inverse_erf_c;
+    const double* d_arr = inverse_erf_d;
+    double q = std::sqrt(-2 * std::log(p));
+    return (((((c_arr[0] * q + c_arr[1]) * q + c_arr[2]) * q + c_arr[3]) * q +
+             c_arr[4]) *
+                q +
+            c_arr[5]) /
+           ((((d_arr[0] * q + d_arr[1]) * q + d_arr[2]) * q + d_arr[3]) * q +
+            1);
+}
+
+// Refining the result:
+// One iteration of Halley’s rational method (third order)
+// gives full machine precision.
+inline double InverseErrorFunctionRefine(double p, double x) {
+    double e = 0.5 * std::erfc(-x / SQRT2) - p;
+    double u = e * std::sqrt(2 * PI) * std::exp(0.5 * x * x);
+    return x - u / (1 + x * u * 0.5);
+}
+
+} // namespace
+
 double inverseErrorFunction(double p) {
     if (p <= 0 || p >= 1) {
         log_fatal(
             "The inverse Error function can just handle values between 0 and "
             "1.");
     }
-    double a_arr[] = {-3.969683028665376e+01, 2.209460984245205e+02,
-                      -2.759285104469687e+02, 1.383577518672690e+02,
-                      -3.066479806614716e+01, 2.506628277459239e+00};
-    double b_arr[] = {-5.447609879822406e+01, 1.615858368580409e+02,
-                      -1.556989798598866e+02, 6.680131188771972e+01,
-                      -1.328068155288572e+01};
-    double c_arr[] = {-7.784894002430293e-03, -3.223964580411365e-01,
-                      -2.400758277161838e+00, -2.549732539343734e+00,
-                      4.374664141464968e+00,  2.938163982698783e+00};
-    double d_arr[] = {7.784695709041462e-03, 3.224671290700398e-01,
-                      2.445134137142996e+00, 3.754408661907416e+00};
-    double p_low = 0.02425;
-    double p_high = 1 - p_low;
-
-    double q, r, x, e, u;
-    if (p < p_low) {
-        // Rational approximation for lower region.
-        q = std::sqrt(-2 * std::log(p));
-        x = (((((c_arr[0] * q + c_arr[1]) * q + c_arr[2]) * q + c_arr[3]) * q +
-              c_arr[4]) *
-                 q +
-             c_arr[5]) /
-            ((((d_arr[0] * q + d_arr[1]) * q + d_arr[2]) * q + d_arr[3]) * q +
-             1);
-    } else if (p_low <= p && p <= p_high) {
-        // Rational approximation for central region.
-        q = p - 0.5;
-        r = q * q;
-        x = (((((a_arr[0] * r + a_arr[1]) * r + a_arr[2]) * r + a_arr[3]) * r +
-              a_arr[4]) *
-                 r +
-             a_arr[5]) *
-            q /
-            (((((b_arr[0] * r + b_arr[1]) * r + b_arr[2]) * r + b_arr[3]) * r +
-              b_arr[4]) *
-                 r +
-             1);
+
+    double x;
+    if (p < inverse_erf_p_low) {
+        x = InverseErrorFunctionTail(p);
+    } else if (p <= inverse_erf_p_high) {
+        x = InverseErrorFunctionCentral(p);
     } else {
-        // Rational approximation for upper region.
-        q = std::sqrt(-2 * std::log(1 - p));
-        x = -(((((c_arr[0] * q + c_arr[1]) * q + c_arr[2]) * q + c_arr[3]) * q +
-               c_arr[4]) *
-                  q +
-              c_arr[5]) /
-            ((((d_arr[0] * q + d_arr[1]) * q + d_arr[2]) * q + d_arr[3]) * q +
-             1);
+        x = -InverseErrorFunctionTail(1 - p);
     }
 
-    // Refining the result:
-    // One iteration of Halley’s rational method (third order)
-    // gives full machine precision.
-    e = 0.5 * std::erfc(-x / SQRT2) - p;
-    u = e * std::sqrt(2 * PI) * std::exp(0.5 * x * x);
-    x = x - u / (1 + x * u * 0.5);
-    return x;
+    return InverseErrorFunctionRefine(p, x);
+}
+
+void inverseErrorFunction(const double* p, double* x, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        if (p[i] <= 0 || p[i] >= 1) {
+            log_fatal(
+                "The inverse Error function can just handle values between 0 "
+                "and 1.");
+        }
+    }
+
+    // Most values are in the central region, so it is evaluated for all of
+    // them without branches and only the few tail values are replaced.
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = InverseErrorFunctionCentral(p[i]);
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        if (p[i] < inverse_erf_p_low) {
+            x[i] = InverseErrorFunctionTail(p[i]);
+        } else if (p[i] > inverse_erf_p_high) {
+            x[i] = -InverseErrorFunctionTail(1 - p[i]);
+        }
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = InverseErrorFunctionRefine(p[i], x[i]);
+    }
 }
 
 // ------------------------------------------------------------------------- //
@@ -183,8 +226,8 @@ double dilog(double x) {
 //     }
 // }
 
-double NewtonRaphson(std::function<double(double)> func,
-                     std::function<double(double)> dfunc,
+double NewtonRaphson(const std::function<double(double)>& func,
+                     const std::function<double(double)>& dfunc,
                      double x1,
                      double x2,
                      double xinit,
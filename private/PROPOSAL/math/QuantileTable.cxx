@@ -0,0 +1,269 @@
+#include <algorithm>
+#include <cmath>
+
+#include "PROPOSAL/Logging.h"
+#include "PROPOSAL/math/QuantileTable.h"
+
+using namespace PROPOSAL;
+
+namespace {
+
+// The nodes in u are equidistant in w, with u = 2w^2 below and
+// u = 1 - 2(1 - w)^2 above one half. They are dense at both ends, where the
+// quantile functions are often steep.
+double ProbabilityToW(double u)
+{
+    if (u < 0.5)
+    {
+        return std::sqrt(0.5 * std::max(u, 0.));
+    }
+    return 1. - std::sqrt(0.5 * std::max(1. - u, 0.));
+}
+
+double WToProbability(double w)
+{
+    if (w < 0.5)
+    {
+        return 2. * w * w;
+    }
+    return 1. - 2. * (1. - w) * (1. - w);
+}
+
+} // namespace
+
+const double QuantileTable::min_improvement_ = 1.5;
+
+QuantileTable::QuantileTable(int max1,
+                             double x1min,
+                             double x1max,
+                             int max2,
+                             std::function<double(double, double)> quantile,
+                             std::function<double(double, double)> cdf,
+                             double accuracy,
+                             bool isLog1,
+                             int max_size)
+    : max1_(max1)
+    , max2_(max2)
+    , x1min_(x1min)
+    , x1max_(x1max)
+    , step1_(0)
+    , step2_(0)
+    , isLog1_(isLog1)
+    , accuracy_(0)
+    , values_()
+{
+    if (max1_ < 1 || max2_ < 2)
+    {
+        log_fatal("A quantile table needs at least 1 node in x1 and 2 nodes in u!");
+    }
+
+    if (isLog1_)
+    {
+        x1min_ = std::log(x1min);
+        x1max_ = std::log(x1max);
+    }
+
+    // Grid before the last refinement, to step back if it did not pay off
+    int last_max1             = max1_;
+    int last_max2             = max2_;
+    double last_error1        = 0;
+    double last_error2        = 0;
+    std::vector<double> last_values;
+
+    bool refine1 = true;
+    bool refine2 = true;
+
+    while (true)
+    {
+        Fill(quantile);
+
+        // Check the table in the middle of the cells, separately for both
+        // directions to know which one to refine.
+        double error1 = 0;
+        double error2 = 0;
+
+        for (int i1 = 0; i1 < max1_; ++i1)
+        {
+            double x1     = x1min_ + i1 * step1_;
+            double x1_mid = x1 + 0.5 * step1_;
+
+            if (isLog1_)
+            {
+                x1     = std::exp(x1);
+                x1_mid = std::exp(x1_mid);
+            }
+
+            for (int i2 = 0; i2 < max2_; ++i2)
+            {
+                double u = WToProbability(i2 * step2_);
+
+                if (i1 + 1 < max1_)
+                {
+                    error1 = std::max(error1, std::abs(cdf(x1_mid, Interpolate(x1_mid, u)) - u));
+                }
+                if (i2 + 1 < max2_)
+                {
+                    double u_mid = WToProbability((i2 + 0.5) * step2_);
+                    error2 = std::max(error2, std::abs(cdf(x1, Interpolate(x1, u_mid)) - u_mid));
+                }
+            }
+        }
+
+        // If halving a step did not reduce the error, the error comes from
+        // the tabulated function itself, e.g. from the switching stencils of
+        // an interpolation it is based on. Go back to the coarser grid and
+        // do not refine this direction any further.
+        bool stalled1 = max1_ != last_max1 && error1 * min_improvement_ > last_error1;
+        bool stalled2 = max2_ != last_max2 && error2 * min_improvement_ > last_error2;
+
+        if (stalled1 || stalled2)
+        {
+            refine1 = refine1 && !stalled1;
+            refine2 = refine2 && !stalled2;
+
+            max1_ = last_max1;
+            max2_ = last_max2;
+            step1_ = max1_ > 1 ? (x1max_ - x1min_) / (max1_ - 1) : 0.;
+            step2_ = 1. / (max2_ - 1);
+            values_.swap(last_values);
+
+            error1 = last_error1;
+            error2 = last_error2;
+        }
+
+        accuracy_ = std::max(error1, error2);
+
+        bool choose1 = refine1 && error1 > accuracy;
+        bool choose2 = refine2 && error2 > accuracy;
+
+        if (!choose1 && !choose2)
+        {
+            if (accuracy_ > accuracy)
+            {
+                log_debug("Quantile table stopped at an accuracy of %g instead of %g, which is the "
+                          "resolution of the tabulated function",
+                          accuracy_,
+                          accuracy);
+            }
+            break;
+        }
+
+        // Halve the step of the direction with the larger error. The old
+        // nodes stay nodes of the refined grid.
+        int max1_new = max1_;
+        int max2_new = max2_;
+
+        if (choose1 && (error1 >= error2 || !choose2))
+        {
+            max1_new = 2 * max1_ - 1;
+        } else
+        {
+            max2_new = 2 * max2_ - 1;
+        }
+
+        if (max1_new * max2_new > max_size)
+        {
+            log_warn("Quantile table reached its maximum size of %i nodes with an accuracy of %g instead of %g",
+                     max1_ * max2_,
+                     accuracy_,
+                     accuracy);
+            break;
+        }
+
+        last_max1   = max1_;
+        last_max2   = max2_;
+        last_error1 = error1;
+        last_error2 = error2;
+        last_values.swap(values_);
+
+        max1_ = max1_new;
+        max2_ = max2_new;
+    }
+}
+
+bool QuantileTable::operator==(const QuantileTable& table) const
+{
+    if (max1_ != table.max1_)
+        return false;
+    else if (max2_ != table.max2_)
+        return false;
+    else if (x1min_ != table.x1min_)
+        return false;
+    else if (x1max_ != table.x1max_)
+        return false;
+    else if (isLog1_ != table.isLog1_)
+        return false;
+    else if (values_ != table.values_)
+        return false;
+    return true;
+}
+
+bool QuantileTable::operator!=(const QuantileTable& table) const
+{
+    return !(*this == table);
+}
+
+// ------------------------------------------------------------------------- //
+double QuantileTable::GetEdgeProbability() const
+{
+    return WToProbability(step2_);
+}
+
+// ------------------------------------------------------------------------- //
+void QuantileTable::Fill(const std::function<double(double, double)>& quantile)
+{
+    step1_ = max1_ > 1 ? (x1max_ - x1min_) / (max1_ - 1) : 0.;
+    step2_ = 1. / (max2_ - 1);
+
+    values_.resize(max1_ * max2_);
+
+    for (int i1 = 0; i1 < max1_; ++i1)
+    {
+        double x1 = x1min_ + i1 * step1_;
+
+        if (isLog1_)
+        {
+            x1 = std::exp(x1);
+        }
+
+        for (int i2 = 0; i2 < max2_; ++i2)
+        {
+            // hit the upper edge exactly
+            double u = (i2 + 1 < max2_) ? WToProbability(i2 * step2_) : 1.;
+
+            values_[i1 * max2_ + i2] = quantile(x1, u);
+        }
+    }
+}
+
+// ------------------------------------------------------------------------- //
+double QuantileTable::Interpolate(double x1, double u) const
+{
+    if (isLog1_)
+    {
+        x1 = std::log(x1);
+    }
+
+    // bilinear in x1 and w, outside of the grid the border cells are extrapolated
+    double aux2 = ProbabilityToW(u) / step2_;
+    int i2      = std::min((int)aux2, max2_ - 2);
+    double w2   = aux2 - i2;
+
+    if (max1_ == 1)
+    {
+        const double* values = &values_[i2];
+        return values[0] + w2 * (values[1] - values[0]);
+    }
+
+    double aux1 = (x1 - x1min_) / step1_;
+    int i1      = std::min(std::max((int)std::floor(aux1), 0), max1_ - 2);
+    double w1   = aux1 - i1;
+
+    const double* lower = &values_[i1 * max2_ + i2];
+    const double* upper = lower + max2_;
+
+    double value_lower = lower[0] + w2 * (lower[1] - lower[0]);
+    double value_upper = upper[0] + w2 * (upper[1] - upper[0]);
+
+    return value_lower + w1 * (value_upper - value_lower);
+}
@@ -6,13 +6,70 @@
 *   \author Jan-Hendrik Koehne
 */
 
+#include <mutex>
+
 #include "PROPOSAL/math/RandomGenerator.h"
 
 using namespace PROPOSAL;
 
+namespace {
+// Propagators, which are created on several threads, seed the global rng
+std::mutex seed_mutex;
+} // namespace
+
+thread_local RandomStream* RandomGenerator::thread_stream_ = NULL;
 std::mt19937 RandomGenerator::rng_;
 std::uniform_real_distribution<double> RandomGenerator::uniform_distribution(0.0, 1.0);
 
+// ------------------------------------------------------------------------- //
+// RandomStream
+// ------------------------------------------------------------------------- //
+
+RandomStream::RandomStream(uint64_t seed, uint64_t event_id)
+{
+    Reset(seed, event_id);
+}
+
+// ------------------------------------------------------------------------- //
+void RandomStream::Reset(uint64_t seed, uint64_t event_id)
+{
+    seed_     = seed;
+    event_id_ = event_id;
+    block_    = 0;
+    key_[0]   = static_cast<uint32_t>(seed);
+    key_[1]   = static_cast<uint32_t>(seed >> 32);
+    buffered_ = 0;
+}
+
+// ------------------------------------------------------------------------- //
+RandomStream::Counter RandomStream::Philox4x32(Counter counter, Key key)
+{
+    const uint64_t multiplier_0 = 0xD2511F53;
+    const uint64_t multiplier_1 = 0xCD9E8D57;
+    const uint32_t weyl_0       = 0x9E3779B9;
+    const uint32_t weyl_1       = 0xBB67AE85;
+
+    for (int round = 0; round < 10; ++round)
+    {
+        if (round > 0)
+        {
+            key[0] += weyl_0;
+            key[1] += weyl_1;
+        }
+
+        uint64_t product_0 = multiplier_0 * counter[0];
+        uint64_t product_1 = multiplier_1 * counter[2];
+
+        Counter next = { { static_cast<uint32_t>(product_1 >> 32) ^ counter[1] ^ key[0],
+                           static_cast<uint32_t>(product_1),
+                           static_cast<uint32_t>(product_0 >> 32) ^ counter[3] ^ key[1],
+                           static_cast<uint32_t>(product_0) } };
+        counter = next;
+    }
+
+    return counter;
+}
+
 // ------------------------------------------------------------------------- //
 // Constructor & destructor
 // ------------------------------------------------------------------------- //
@@ -34,6 +91,11 @@ RandomGenerator::~RandomGenerator() {}
 // ------------------------------------------------------------------------- //
 double RandomGenerator::RandomDouble()
 {
+    if (thread_stream_)
+    {
+        return thread_stream_->RandomDouble();
+    }
+
 #ifdef ICECUBE_PROJECT
     if (i3random_gen_)
     {
@@ -51,9 +113,18 @@ double RandomGenerator::RandomDouble()
 // ------------------------------------------------------------------------- //
 void RandomGenerator::SetSeed(int seed)
 {
+    std::lock_guard<std::mutex> lock(seed_mutex);
     rng_.seed(seed);
 }
 
+// ------------------------------------------------------------------------- //
+RandomStream* RandomGenerator::SetThreadStream(RandomStream* stream)
+{
+    RandomStream* previous = thread_stream_;
+    thread_stream_         = stream;
+    return previous;
+}
+
 // ------------------------------------------------------------------------- //
 void RandomGenerator::Serialize(std::ostream& os)
 {
@@ -0,0 +1,437 @@
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "PROPOSAL/Logging.h"
+#include "PROPOSAL/math/Interpolant.h"
+#include "PROPOSAL/math/TableFile.h"
+#include "PROPOSAL/methods.h"
+
+using namespace PROPOSAL;
+
+const uint32_t TableFile::version_;
+const char* const TableFile::extension_ = ".tbl";
+
+namespace {
+
+const char magic[8]              = { 'P', 'R', 'O', 'P', 'T', 'B', 'L', '\0' };
+const uint32_t byte_order_mark   = 0x01020304;
+const size_t alignment           = 64;
+
+struct Header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t file_size;
+    uint64_t number_of_tables;
+    uint64_t checksum; // of the index
+    uint64_t reserved[3];
+};
+
+// Entry of the index, which follows the header
+struct IndexEntry
+{
+    uint64_t offset;   // of the record of the table
+    uint64_t checksum; // from the record up to the next table
+};
+
+// Parameters of one table. The arrays follow the record, their positions
+// are given relative to the start of the file.
+struct Record
+{
+    int32_t dimension;
+    int32_t max;
+    int32_t romberg;
+    int32_t rombergY;
+    int32_t row;
+    uint8_t rational;
+    uint8_t relative;
+    uint8_t rationalY;
+    uint8_t relativeY;
+    uint8_t self;
+    uint8_t flag;
+    uint8_t isLog;
+    uint8_t logSubst;
+    double xmin;
+    double xmax;
+    double step;
+    uint64_t x;    // max nodes
+    uint64_t y;    // max values
+    uint64_t rows; // max offsets of the rows of a 2d table
+};
+
+static_assert(sizeof(Header) == 64, "The header of a table file has to be 64 bytes");
+static_assert(sizeof(Record) == 80, "The record of a table has to be 80 bytes");
+static_assert(sizeof(IndexEntry) == 16, "An entry of the index has to be 16 bytes");
+
+// States of the lazy check of the table checksums
+const int table_unchecked = 0;
+const int table_valid     = 1;
+const int table_corrupt   = 2;
+
+// Pads the buffer to the next multiple of the alignment and appends the data
+uint64_t Append(std::vector<char>& buffer, const void* data, size_t size)
+{
+    buffer.resize((buffer.size() + alignment - 1) / alignment * alignment, 0);
+
+    uint64_t offset = buffer.size();
+    const char* begin = static_cast<const char*>(data);
+    buffer.insert(buffer.end(), begin, begin + size);
+
+    return offset;
+}
+
+bool InBounds(uint64_t offset, uint64_t size, uint64_t file_size)
+{
+    return offset % alignment == 0 && offset <= file_size && size <= file_size - offset;
+}
+
+} // namespace
+
+// ------------------------------------------------------------------------- //
+TableFile::TableFile(std::shared_ptr<const char> mapping, const char* data, size_t size)
+    : mapping_(mapping)
+    , data_(data)
+    , size_(size)
+    , offsets_()
+    , checksums_()
+    , checks_()
+{
+}
+
+// ------------------------------------------------------------------------- //
+bool TableFile::Write(const std::string& path, const std::vector<const Interpolant*>& tables)
+{
+    std::vector<char> buffer;
+    if (!Serialize(tables, buffer))
+    {
+        return false;
+    }
+
+    // Other processes may have mapped a former version of the file, which
+    // must not be truncated
+    return Helper::WriteFileAtomic(path, &buffer[0], buffer.size());
+}
+
+// ------------------------------------------------------------------------- //
+bool TableFile::Serialize(const std::vector<const Interpolant*>& tables, std::vector<char>& buffer)
+{
+    buffer.assign(sizeof(Header) + tables.size() * sizeof(IndexEntry), 0);
+    std::vector<IndexEntry> index(tables.size());
+
+    for (unsigned int i = 0; i < tables.size(); ++i)
+    {
+        if (!AppendTable(buffer, *tables[i], index[i].offset))
+        {
+            return false;
+        }
+    }
+    buffer.resize((buffer.size() + alignment - 1) / alignment * alignment, 0);
+
+    // A table reaches up to the next one, the last one up to the end
+    for (unsigned int i = 0; i < index.size(); ++i)
+    {
+        uint64_t end      = (i + 1 < index.size()) ? index[i + 1].offset : buffer.size();
+        index[i].checksum = Helper::Checksum(&buffer[index[i].offset], end - index[i].offset);
+    }
+
+    Header header;
+    std::memset(&header, 0, sizeof header);
+    std::memcpy(header.magic, magic, sizeof magic);
+    header.version          = version_;
+    header.byte_order       = byte_order_mark;
+    header.file_size        = buffer.size();
+    header.number_of_tables = tables.size();
+
+    if (!index.empty())
+    {
+        std::memcpy(&buffer[sizeof header], &index[0], index.size() * sizeof(IndexEntry));
+    }
+
+    header.checksum = Helper::Checksum(&buffer[sizeof header], index.size() * sizeof(IndexEntry));
+
+    std::memcpy(&buffer[0], &header, sizeof header);
+
+    return true;
+}
+
+// ------------------------------------------------------------------------- //
+bool TableFile::AppendTable(std::vector<char>& buffer, const Interpolant& table, uint64_t& offset)
+{
+    // The 2d tables from arrays keep their values in iY2_, which is not
+    // stored
+    bool is_2d = !table.Interpolant_.empty();
+
+    if (!table.fast_ || !table.iY2_.empty() || table.max_ <= 0 || table.GetNumberOfX() != table.max_
+        || table.GetNumberOfY() != table.max_ || (is_2d && table.Interpolant_.size() != (size_t)table.max_))
+    {
+        return false;
+    }
+
+    Record record;
+    std::memset(&record, 0, sizeof record);
+    record.dimension = is_2d ? 2 : 1;
+    record.max       = table.max_;
+    record.romberg   = table.romberg_;
+    record.rombergY  = table.rombergY_;
+    record.row       = table.row_;
+    record.rational  = table.rational_;
+    record.relative  = table.relative_;
+    record.rationalY = table.rationalY_;
+    record.relativeY = table.relativeY_;
+    record.self      = table.self_;
+    record.flag      = table.flag_;
+    record.isLog     = table.isLog_;
+    record.logSubst  = table.logSubst_;
+    record.xmin      = table.xmin_;
+    record.xmax      = table.xmax_;
+    record.step      = table.step_;
+
+    offset = Append(buffer, &record, sizeof record);
+
+    record.x = Append(buffer, table.GetX(), table.max_ * sizeof(double));
+    record.y = Append(buffer, table.GetY(), table.max_ * sizeof(double));
+
+    if (is_2d)
+    {
+        std::vector<uint64_t> rows(table.max_);
+        for (int i = 0; i < table.max_; ++i)
+        {
+            if (!table.Interpolant_[i]->Interpolant_.empty() || !AppendTable(buffer, *table.Interpolant_[i], rows[i]))
+            {
+                return false;
+            }
+        }
+        record.rows = Append(buffer, &rows[0], rows.size() * sizeof(uint64_t));
+    }
+
+    std::memcpy(&buffer[offset], &record, sizeof record);
+
+    return true;
+}
+
+// ------------------------------------------------------------------------- //
+std::shared_ptr<const char> TableFile::MapMemory(int descriptor, size_t size)
+{
+    void* data = mmap(NULL, size, PROT_READ, MAP_SHARED, descriptor, 0);
+
+    if (data == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    return std::shared_ptr<const char>(static_cast<const char*>(data), [size](const char* data) {
+        munmap(const_cast<char*>(data), size);
+    });
+}
+
+// ------------------------------------------------------------------------- //
+std::shared_ptr<const TableFile> TableFile::Map(const std::string& path)
+{
+    int descriptor = open(path.c_str(), O_RDONLY);
+    if (descriptor < 0)
+    {
+        return NULL;
+    }
+
+    struct stat status;
+    std::shared_ptr<const char> mapping;
+
+    if (fstat(descriptor, &status) == 0 && status.st_size >= (off_t)sizeof(Header))
+    {
+        mapping = MapMemory(descriptor, status.st_size);
+    }
+
+    // The mapping stays valid after the file is closed
+    close(descriptor);
+
+    if (!mapping)
+    {
+        return NULL;
+    }
+
+    std::shared_ptr<const TableFile> file = Open(mapping, mapping.get(), status.st_size);
+    if (!file)
+    {
+        log_debug("%s is no valid table file of version %u", path.c_str(), version_);
+    }
+
+    return file;
+}
+
+// ------------------------------------------------------------------------- //
+std::shared_ptr<const TableFile> TableFile::Open(std::shared_ptr<const char> mapping, const char* data, size_t size)
+{
+    if (size < sizeof(Header))
+    {
+        return NULL;
+    }
+
+    std::shared_ptr<TableFile> file(new TableFile(mapping, data, size));
+
+    Header header;
+    std::memcpy(&header, file->data_, sizeof header);
+
+    // The number of tables is bounded first, so the size of the index can
+    // not overflow. Only the index is checksummed here, the checksum of a
+    // table is checked when it is used first, so opening a file does not
+    // read all of it.
+    if (std::memcmp(header.magic, magic, sizeof magic) != 0 || header.version != version_
+        || header.byte_order != byte_order_mark || header.file_size != size
+        || header.number_of_tables > (size - sizeof header) / sizeof(IndexEntry)
+        || !InBounds(sizeof header, header.number_of_tables * sizeof(IndexEntry), size)
+        || header.checksum != Helper::Checksum(file->data_ + sizeof header, header.number_of_tables * sizeof(IndexEntry)))
+    {
+        return NULL;
+    }
+
+    std::vector<IndexEntry> index(header.number_of_tables);
+    if (header.number_of_tables > 0)
+    {
+        std::memcpy(&index[0], file->data_ + sizeof header, header.number_of_tables * sizeof(IndexEntry));
+    }
+
+    for (unsigned int i = 0; i < index.size(); ++i)
+    {
+        // The tables follow each other, a table reaches up to the next one
+        if (!file->IsValid(index[i].offset, false) || (i > 0 && index[i].offset <= index[i - 1].offset))
+        {
+            return NULL;
+        }
+        file->offsets_.push_back(index[i].offset);
+        file->checksums_.push_back(index[i].checksum);
+    }
+    file->checks_ = std::vector<std::atomic<int> >(index.size());
+
+    return file;
+}
+
+// ------------------------------------------------------------------------- //
+bool TableFile::IsValid(uint64_t offset, bool is_row) const
+{
+    if (!InBounds(offset, sizeof(Record), size_))
+    {
+        return false;
+    }
+
+    Record record;
+    std::memcpy(&record, data_ + offset, sizeof record);
+
+    if (record.dimension != 1 && (record.dimension != 2 || is_row))
+    {
+        return false;
+    }
+
+    int romberg_max = Interpolant::romberg_max_;
+    if (record.max < romberg_max)
+    {
+        romberg_max = record.max;
+    }
+
+    if (record.max <= 0 || record.romberg <= 0 || record.romberg > romberg_max || record.rombergY <= 0
+        || record.rombergY > romberg_max)
+    {
+        return false;
+    }
+
+    uint64_t array_size = record.max * sizeof(double);
+    if (!InBounds(record.x, array_size, size_) || !InBounds(record.y, array_size, size_))
+    {
+        return false;
+    }
+
+    if (record.dimension == 2)
+    {
+        if (!InBounds(record.rows, record.max * sizeof(uint64_t), size_))
+        {
+            return false;
+        }
+
+        const uint64_t* rows = reinterpret_cast<const uint64_t*>(data_ + record.rows);
+        for (int i = 0; i < record.max; ++i)
+        {
+            if (!IsValid(rows[i], true))
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// ------------------------------------------------------------------------- //
+std::shared_ptr<const Interpolant> TableFile::GetInterpolant(unsigned int index) const
+{
+    if (index >= offsets_.size())
+    {
+        log_fatal("The table file has only %u tables!", GetNumberOfTables());
+    }
+
+    // Threads checking the same table at once only compute the checksum
+    // twice
+    int check = checks_[index].load();
+    if (check == table_unchecked)
+    {
+        uint64_t end = (index + 1 < offsets_.size()) ? offsets_[index + 1] : size_;
+        check        = (Helper::Checksum(data_ + offsets_[index], end - offsets_[index]) == checksums_[index])
+                    ? table_valid
+                    : table_corrupt;
+        checks_[index].store(check);
+    }
+
+    if (check == table_corrupt)
+    {
+        log_warn("The checksum of table %u of the table file does not match, the table is corrupt!", index);
+        return NULL;
+    }
+
+    return std::shared_ptr<const Interpolant>(CreateInterpolant(offsets_[index]));
+}
+
+// ------------------------------------------------------------------------- //
+Interpolant* TableFile::CreateInterpolant(uint64_t offset) const
+{
+    Record record;
+    std::memcpy(&record, data_ + offset, sizeof record);
+
+    Interpolant* interpolant = new Interpolant();
+
+    interpolant->max_       = record.max;
+    interpolant->romberg_   = record.romberg;
+    interpolant->rombergY_  = record.rombergY;
+    interpolant->row_       = record.row;
+    interpolant->rational_  = record.rational;
+    interpolant->relative_  = record.relative;
+    interpolant->rationalY_ = record.rationalY;
+    interpolant->relativeY_ = record.relativeY;
+    interpolant->self_      = record.self;
+    interpolant->flag_      = record.flag;
+    interpolant->isLog_     = record.isLog;
+    interpolant->logSubst_  = record.logSubst;
+    interpolant->fast_      = true;
+    interpolant->xmin_      = record.xmin;
+    interpolant->xmax_      = record.xmax;
+    interpolant->step_      = record.step;
+
+    interpolant->table_file_ = shared_from_this();
+    interpolant->mapped_x_   = reinterpret_cast<const double*>(data_ + record.x);
+    interpolant->mapped_y_   = reinterpret_cast<const double*>(data_ + record.y);
+
+    if (record.dimension == 2)
+    {
+        const uint64_t* rows = reinterpret_cast<const uint64_t*>(data_ + record.rows);
+
+        interpolant->Interpolant_.resize(record.max);
+        for (int i = 0; i < record.max; ++i)
+        {
+            interpolant->Interpolant_[i] = CreateInterpolant(rows[i]);
+        }
+    }
+
+    return interpolant;
+}
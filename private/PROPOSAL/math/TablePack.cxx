@@ -0,0 +1,493 @@
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "PROPOSAL/Logging.h"
+#include "PROPOSAL/math/TableFile.h"
+#include "PROPOSAL/math/TablePack.h"
+#include "PROPOSAL/methods.h"
+
+using namespace PROPOSAL;
+
+const uint32_t TablePack::version_;
+const char* const TablePack::file_name_ = "tables.pack";
+
+namespace {
+
+const char magic[8]            = { 'P', 'R', 'O', 'P', 'P', 'A', 'C', 'K' };
+const char entry_magic[8]      = { 'P', 'R', 'O', 'P', 'E', 'N', 'T', 'R' };
+const uint32_t byte_order_mark = 0x01020304;
+const uint64_t alignment       = 64;
+
+struct Header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t reserved[6];
+};
+
+struct EntryHeader
+{
+    char magic[8];
+    uint64_t key_size;
+    uint64_t table_size;
+    uint64_t key_checksum;
+    uint64_t reserved[4];
+};
+
+static_assert(sizeof(Header) == 64, "The header of a table pack has to be 64 bytes");
+static_assert(sizeof(EntryHeader) == 64, "The header of an entry has to be 64 bytes");
+
+uint64_t Pad(uint64_t size)
+{
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+// Locks one byte of the lock file of a pack and returns the descriptor
+// holding the lock, -1 if the lock is not available. Open file description
+// locks belong to the descriptor, so they also separate the threads of one
+// process. Closing the descriptor releases the lock.
+int Lock(const std::string& path, uint64_t position, bool shared)
+{
+    std::string lock_path = path + ".lock";
+
+    int descriptor = open(lock_path.c_str(), O_RDWR | O_CREAT, 0666);
+    if (descriptor < 0)
+    {
+        // A pack in a readonly directory is not written
+        descriptor = open(lock_path.c_str(), O_RDONLY);
+    }
+    if (descriptor < 0)
+    {
+        return -1;
+    }
+
+    int result = -1;
+
+#ifdef F_OFD_SETLKW
+    struct flock lock;
+    std::memset(&lock, 0, sizeof lock);
+    lock.l_type   = shared ? F_RDLCK : F_WRLCK;
+    lock.l_whence = SEEK_SET;
+    lock.l_start  = position;
+    lock.l_len    = 1;
+
+    do
+    {
+        result = fcntl(descriptor, F_OFD_SETLKW, &lock);
+    } while (result != 0 && errno == EINTR);
+#else
+    if (position == 0)
+    {
+        result = flock(descriptor, shared ? LOCK_SH : LOCK_EX);
+    }
+#endif
+
+    if (result != 0)
+    {
+        close(descriptor);
+        return -1;
+    }
+
+    return descriptor;
+}
+
+// Lock of the whole pack, shared while it is read
+class PackLock
+{
+public:
+    PackLock(const std::string& path, bool shared)
+        : descriptor_(Lock(path, 0, shared))
+    {
+    }
+
+    ~PackLock()
+    {
+        if (descriptor_ >= 0)
+        {
+            close(descriptor_);
+        }
+    }
+
+    bool IsLocked() const { return descriptor_ >= 0; }
+
+private:
+    PackLock(const PackLock&);
+    PackLock& operator=(const PackLock&);
+
+    int descriptor_;
+};
+
+bool WriteAt(int descriptor, const std::vector<char>& buffer, uint64_t offset)
+{
+    size_t written = 0;
+
+    while (written < buffer.size())
+    {
+        ssize_t result = pwrite(descriptor, &buffer[written], buffer.size() - written, offset + written);
+
+        if (result < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (result <= 0)
+        {
+            return false;
+        }
+        written += result;
+    }
+
+    return true;
+}
+
+void AppendHeader(std::vector<char>& buffer)
+{
+    Header header;
+    std::memset(&header, 0, sizeof header);
+    std::memcpy(header.magic, magic, sizeof magic);
+    header.version    = TablePack::version_;
+    header.byte_order = byte_order_mark;
+
+    const char* begin = reinterpret_cast<const char*>(&header);
+    buffer.insert(buffer.end(), begin, begin + sizeof header);
+}
+
+void AppendEntry(std::vector<char>& buffer, const std::string& key, const char* data, size_t size)
+{
+    EntryHeader entry;
+    std::memset(&entry, 0, sizeof entry);
+    std::memcpy(entry.magic, entry_magic, sizeof entry_magic);
+    entry.key_size     = key.size();
+    entry.table_size   = size;
+    entry.key_checksum = Helper::Checksum(key.data(), key.size());
+
+    const char* begin = reinterpret_cast<const char*>(&entry);
+    buffer.insert(buffer.end(), begin, begin + sizeof entry);
+
+    buffer.insert(buffer.end(), key.begin(), key.end());
+    buffer.resize(Pad(buffer.size()), 0);
+
+    buffer.insert(buffer.end(), data, data + size);
+    buffer.resize(Pad(buffer.size()), 0);
+}
+
+} // namespace
+
+// ------------------------------------------------------------------------- //
+TablePack::TablePack(std::shared_ptr<const char> mapping, size_t size)
+    : mapping_(mapping)
+    , size_(size)
+    , index_()
+{
+}
+
+// ------------------------------------------------------------------------- //
+uint64_t TablePack::ReadIndex(const char* data, size_t size, Index& index)
+{
+    if (size < sizeof(Header))
+    {
+        return 0;
+    }
+
+    Header header;
+    std::memcpy(&header, data, sizeof header);
+
+    if (std::memcmp(header.magic, magic, sizeof magic) != 0 || header.version != version_
+        || header.byte_order != byte_order_mark)
+    {
+        return 0;
+    }
+
+    uint64_t end = sizeof header;
+
+    while (end + sizeof(EntryHeader) <= size)
+    {
+        EntryHeader entry;
+        std::memcpy(&entry, data + end, sizeof entry);
+
+        uint64_t key_offset   = end + sizeof entry;
+        uint64_t table_offset = key_offset + Pad(entry.key_size);
+
+        // The entry of a writer, which did not finish, is left out
+        if (std::memcmp(entry.magic, entry_magic, sizeof entry_magic) != 0 || entry.key_size > size
+            || entry.table_size > size || table_offset > size || Pad(entry.table_size) > size - table_offset
+            || Helper::Checksum(data + key_offset, entry.key_size) != entry.key_checksum)
+        {
+            break;
+        }
+
+        // The first entry of a key is used
+        std::string key(data + key_offset, entry.key_size);
+        index.insert(std::make_pair(key, std::make_pair(table_offset, entry.table_size)));
+
+        end = table_offset + Pad(entry.table_size);
+    }
+
+    return end;
+}
+
+// ------------------------------------------------------------------------- //
+std::shared_ptr<const TablePack> TablePack::Open(const std::string& path)
+{
+    // The last version of every pack, it is mapped again when the file has
+    // been appended to or replaced
+    struct Cached
+    {
+        dev_t device;
+        ino_t inode;
+        off_t size;
+        std::shared_ptr<const TablePack> pack;
+    };
+
+    static std::mutex cache_mutex;
+    static std::map<std::string, Cached> cache;
+
+    PackLock lock(path, true);
+
+    int descriptor = open(path.c_str(), O_RDONLY);
+    if (descriptor < 0)
+    {
+        return NULL;
+    }
+
+    struct stat status;
+    if (fstat(descriptor, &status) != 0 || status.st_size < (off_t)sizeof(Header))
+    {
+        close(descriptor);
+        return NULL;
+    }
+
+    std::lock_guard<std::mutex> cache_lock(cache_mutex);
+
+    auto cached = cache.find(path);
+    if (cached != cache.end() && cached->second.device == status.st_dev && cached->second.inode == status.st_ino
+        && cached->second.size == status.st_size)
+    {
+        close(descriptor);
+        return cached->second.pack;
+    }
+
+    std::shared_ptr<const char> mapping = TableFile::MapMemory(descriptor, status.st_size);
+    close(descriptor);
+
+    if (!mapping)
+    {
+        return NULL;
+    }
+
+    std::shared_ptr<TablePack> pack(new TablePack(mapping, status.st_size));
+    if (ReadIndex(mapping.get(), status.st_size, pack->index_) == 0)
+    {
+        log_warn("%s is no table pack of version %u!", path.c_str(), version_);
+        return NULL;
+    }
+
+    Cached entry = { status.st_dev, status.st_ino, status.st_size, pack };
+    cache[path]  = entry;
+
+    return pack;
+}
+
+// ------------------------------------------------------------------------- //
+bool TablePack::Append(const std::string& path, const std::string& key, const std::vector<const Interpolant*>& tables)
+{
+    std::vector<char> buffer;
+    if (!TableFile::Serialize(tables, buffer))
+    {
+        return false;
+    }
+
+    Entry entry = { key, &buffer[0], buffer.size() };
+    return AppendEntries(path, std::vector<Entry>(1, entry));
+}
+
+// ------------------------------------------------------------------------- //
+bool TablePack::AppendEntries(const std::string& path, const std::vector<Entry>& entries)
+{
+    // Without the lock, appends of other processes may be overwritten
+    PackLock lock(path, false);
+    if (!lock.IsLocked())
+    {
+        return false;
+    }
+
+    int descriptor = open(path.c_str(), O_RDWR | O_CREAT, 0666);
+    if (descriptor < 0)
+    {
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(descriptor, &status) != 0)
+    {
+        close(descriptor);
+        return false;
+    }
+
+    Index index;
+    uint64_t end = 0;
+
+    if (status.st_size > 0)
+    {
+        std::shared_ptr<const char> mapping = TableFile::MapMemory(descriptor, status.st_size);
+        if (mapping)
+        {
+            end = ReadIndex(mapping.get(), status.st_size, index);
+        }
+
+        if (end == 0)
+        {
+            log_warn("%s is no table pack of version %u!", path.c_str(), version_);
+            close(descriptor);
+            return false;
+        }
+    }
+
+    std::vector<char> buffer;
+    if (end == 0)
+    {
+        AppendHeader(buffer);
+    }
+
+    for (const Entry& entry : entries)
+    {
+        if (index.insert(std::make_pair(entry.key, std::make_pair(0, 0))).second)
+        {
+            AppendEntry(buffer, entry.key, entry.data, entry.size);
+        }
+    }
+
+    // An incomplete entry at the end is overwritten. Readers hold the
+    // shared lock while they read the index, and never read behind its end.
+    bool success = buffer.empty() || (ftruncate(descriptor, end) == 0 && WriteAt(descriptor, buffer, end));
+
+    close(descriptor);
+    return success;
+}
+
+// ------------------------------------------------------------------------- //
+bool TablePack::Merge(const std::string& path, const std::vector<std::string>& inputs)
+{
+    std::vector<std::shared_ptr<const TablePack> > packs;
+    std::vector<Entry> entries;
+
+    for (const std::string& input : inputs)
+    {
+        std::shared_ptr<const TablePack> pack = Open(input);
+        if (!pack)
+        {
+            log_warn("Can not read the table pack %s!", input.c_str());
+            return false;
+        }
+        packs.push_back(pack);
+
+        for (const auto& item : pack->index_)
+        {
+            // Corrupt tables are not spread to other packs
+            if (!pack->Find(item.first))
+            {
+                log_warn("The tables %s in %s are corrupt and not merged!", item.first.c_str(), input.c_str());
+                continue;
+            }
+
+            Entry entry = { item.first, pack->mapping_.get() + item.second.first, item.second.second };
+            entries.push_back(entry);
+        }
+    }
+
+    return AppendEntries(path, entries);
+}
+
+// ------------------------------------------------------------------------- //
+bool TablePack::Prune(const std::string& path, const std::vector<std::string>& prefixes)
+{
+    PackLock lock(path, false);
+    if (!lock.IsLocked())
+    {
+        return false;
+    }
+
+    int descriptor = open(path.c_str(), O_RDONLY);
+    if (descriptor < 0)
+    {
+        return false;
+    }
+
+    struct stat status;
+    std::shared_ptr<const char> mapping;
+
+    if (fstat(descriptor, &status) == 0 && status.st_size > 0)
+    {
+        mapping = TableFile::MapMemory(descriptor, status.st_size);
+    }
+    close(descriptor);
+
+    Index index;
+    if (!mapping || ReadIndex(mapping.get(), status.st_size, index) == 0)
+    {
+        log_warn("%s is no table pack of version %u!", path.c_str(), version_);
+        return false;
+    }
+
+    std::vector<char> buffer;
+    AppendHeader(buffer);
+
+    for (const auto& item : index)
+    {
+        bool pruned = false;
+        for (const std::string& prefix : prefixes)
+        {
+            pruned = pruned || item.first.compare(0, prefix.size(), prefix) == 0;
+        }
+
+        if (!pruned)
+        {
+            AppendEntry(buffer, item.first, mapping.get() + item.second.first, item.second.second);
+        }
+    }
+
+    return Helper::WriteFileAtomic(path, &buffer[0], buffer.size());
+}
+
+// ------------------------------------------------------------------------- //
+std::shared_ptr<const TableFile> TablePack::Find(const std::string& key) const
+{
+    Index::const_iterator entry = index_.find(key);
+    if (entry == index_.end())
+    {
+        return NULL;
+    }
+
+    return TableFile::Open(mapping_, mapping_.get() + entry->second.first, entry->second.second);
+}
+
+// ------------------------------------------------------------------------- //
+std::vector<std::string> TablePack::GetKeys() const
+{
+    std::vector<std::string> keys;
+    for (const auto& entry : index_)
+    {
+        keys.push_back(entry.first);
+    }
+    return keys;
+}
+
+// ------------------------------------------------------------------------- //
+TablePack::KeyLock::KeyLock(const std::string& path, const std::string& key)
+    : descriptor_(Lock(path, 1 + Helper::Checksum(key.data(), key.size()) % (uint64_t(1) << 40), false))
+{
+}
+
+TablePack::KeyLock::~KeyLock()
+{
+    if (descriptor_ >= 0)
+    {
+        close(descriptor_);
+    }
+}
@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include "PROPOSAL/Logging.h"
+#include "PROPOSAL/math/TableScheduler.h"
+
+using namespace PROPOSAL;
+
+std::atomic<unsigned int> TableScheduler::additional_threads_(0);
+
+TableScheduler::TableScheduler(unsigned int n_threads)
+    : n_threads_(n_threads)
+    , tasks_()
+    , dependencies_()
+{
+    if (n_threads_ == 0)
+    {
+        n_threads_ = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+}
+
+// ------------------------------------------------------------------------- //
+TableScheduler::Job TableScheduler::Add(std::function<void()> task, const std::vector<Job>& dependencies)
+{
+    Job job = tasks_.size();
+
+    for (Job dependency : dependencies)
+    {
+        if (dependency >= job)
+        {
+            log_fatal("A job can only depend on jobs added before!");
+        }
+    }
+
+    tasks_.push_back(task);
+    dependencies_.push_back(dependencies);
+
+    return job;
+}
+
+// ------------------------------------------------------------------------- //
+void TableScheduler::Run()
+{
+    size_t number_of_jobs = tasks_.size();
+
+    std::vector<unsigned int> missing(number_of_jobs);
+    std::vector<std::vector<Job> > dependents(number_of_jobs);
+    // The ready job added first is started first, so a single thread runs
+    // the jobs in the order they were added
+    std::set<Job> ready;
+
+    for (Job job = 0; job < number_of_jobs; ++job)
+    {
+        missing[job] = dependencies_[job].size();
+        for (Job dependency : dependencies_[job])
+        {
+            dependents[dependency].push_back(job);
+        }
+        if (missing[job] == 0)
+        {
+            ready.insert(job);
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    size_t started = 0;
+    std::exception_ptr exception;
+
+    auto worker = [&]() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+            // Threads without work leave as soon as no further job can
+            // become ready, so an inner scheduler can take them over
+            condition.wait(lock, [&]() { return !ready.empty() || started == number_of_jobs || exception; });
+            if (ready.empty() || exception)
+            {
+                return;
+            }
+
+            Job job = *ready.begin();
+            ready.erase(ready.begin());
+            ++started;
+
+            lock.unlock();
+            try
+            {
+                tasks_[job]();
+            } catch (...)
+            {
+                lock.lock();
+                if (!exception)
+                {
+                    exception = std::current_exception();
+                }
+                condition.notify_all();
+                return;
+            }
+            lock.lock();
+
+            for (Job dependent : dependents[job])
+            {
+                if (--missing[dependent] == 0)
+                {
+                    ready.insert(dependent);
+                }
+            }
+            condition.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    while (threads.size() + 1 < std::min<size_t>(n_threads_, number_of_jobs))
+    {
+        unsigned int additional = additional_threads_.load();
+        if (additional + 1 >= n_threads_)
+        {
+            break;
+        }
+        if (additional_threads_.compare_exchange_weak(additional, additional + 1))
+        {
+            threads.emplace_back([&worker]() {
+                worker();
+                --additional_threads_;
+            });
+        }
+    }
+
+    // The calling thread leaves the worker once the last job has started,
+    // the jobs of the other threads are done after the join
+    worker();
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    tasks_.clear();
+    dependencies_.clear();
+
+    if (exception)
+    {
+        std::rethrow_exception(exception);
+    }
+}
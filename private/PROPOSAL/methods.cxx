@@ -9,12 +9,20 @@
 
 // #include <stdlib.h>
 
+#include <array>
+#include <cerrno>
 #include <climits> // for PATH_MAX
+#include <cstdio>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <limits>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <fcntl.h>
+#include <sys/file.h> // advisory locks of the table files
 #include <sys/stat.h>
 #include <unistd.h>  // check for write permissions
 #include <wordexp.h> // Used to expand path with environment variables
@@ -23,6 +31,9 @@
 
 #include "PROPOSAL/math/Interpolant.h"
 #include "PROPOSAL/math/InterpolantBuilder.h"
+#include "PROPOSAL/math/TableFile.h"
+#include "PROPOSAL/math/TablePack.h"
+#include "PROPOSAL/math/TableScheduler.h"
 
 #include "PROPOSAL/Logging.h"
 #include "PROPOSAL/methods.h"
@@ -35,8 +46,12 @@ InterpolationDef::InterpolationDef(const nlohmann::json& config)
     nodes_continous_randomization
         = config.value("nodes_continous_randomization", 200);
     nodes_cross_section = config.value("nodes_cross_section", 100);
+    quantile_accuracy = config.value("quantile_accuracy", 0.);
+    channel_accuracy = config.value("channel_accuracy", 0.);
+    number_of_threads = config.value("number_of_threads", 1u);
     max_node_energy = config.value("max_node_energy", 1e14);
     do_binary_tables = config.value("do_binary_tables", true);
+    do_table_pack = config.value("do_table_pack", false);
     just_use_readonly_path = config.value("just_use_readonly_path", false);
     order_of_interpolation = config.value("order_of_interpolation", 5);
 
@@ -49,6 +64,12 @@ InterpolationDef::InterpolationDef(const nlohmann::json& config)
     if (!(nodes_cross_section > 4))
         throw std::invalid_argument(
             "At least 3 nodes are required for qubic splines");
+    if (!(quantile_accuracy >= 0))
+        throw std::invalid_argument(
+            "Accuracy of the quantile tables must not be negative.");
+    if (!(channel_accuracy >= 0))
+        throw std::invalid_argument(
+            "Accuracy of the interaction type tables must not be negative.");
     if (!(max_node_energy > 0))
         throw std::invalid_argument("max_node_energy must be larger than "
                                     "highest primary particle energy.");
@@ -235,12 +256,243 @@ namespace Helper {
         }
     }
 
+    // -------------------------------------------------------------------------
+    // //
+    uint64_t Checksum(const char* data, size_t size)
+    {
+        uint64_t checksum = 14695981039346656037ULL;
+
+        for (size_t i = 0; i < size; ++i) {
+            checksum ^= static_cast<unsigned char>(data[i]);
+            checksum *= 1099511628211ULL;
+        }
+
+        return checksum;
+    }
+
+    // -------------------------------------------------------------------------
+    // //
+    bool WriteFileAtomic(const std::string& path, const char* data, size_t size)
+    {
+        // mkstemp creates a new file of a unique name, also if processes on
+        // several hosts write to the same directory
+        std::vector<char> temporary(path.begin(), path.end());
+        const std::string suffix = ".XXXXXX";
+        temporary.insert(temporary.end(), suffix.begin(), suffix.end());
+        temporary.push_back('\0');
+
+        int descriptor = mkstemp(&temporary[0]);
+        if (descriptor < 0) {
+            return false;
+        }
+
+        // Other users sharing the tables may read them
+        bool written = fchmod(descriptor, 0644) == 0;
+
+        size_t position = 0;
+        while (written && position < size) {
+            ssize_t result
+                = write(descriptor, data + position, size - position);
+            if (result < 0 && errno == EINTR) {
+                continue;
+            }
+            written = result > 0;
+            position += written ? result : 0;
+        }
+
+        // The data has to be on the disk before the rename, otherwise a
+        // crash may leave a renamed but empty or partial file
+        written = written && fsync(descriptor) == 0;
+        written = close(descriptor) == 0 && written;
+
+        if (!written || std::rename(&temporary[0], path.c_str()) != 0) {
+            std::remove(&temporary[0]);
+            return false;
+        }
+
+        return true;
+    }
+
+    // -------------------------------------------------------------------------
+    // //
+    FileLock::FileLock(const std::string& path)
+        : descriptor_(open((path + ".lock").c_str(), O_RDWR | O_CREAT, 0666))
+    {
+        if (descriptor_ >= 0 && flock(descriptor_, LOCK_EX) != 0) {
+            close(descriptor_);
+            descriptor_ = -1;
+        }
+    }
+
+    FileLock::~FileLock()
+    {
+        if (descriptor_ >= 0) {
+            flock(descriptor_, LOCK_UN);
+            close(descriptor_);
+        }
+    }
+
+    // -------------------------------------------------------------------------
+    // //
+    static std::vector<std::shared_ptr<Interpolant>> BuildInterpolants(
+        InterpolantBuilderContainer& builder_container,
+        const InterpolationDef& interpolation_def,
+        const std::vector<std::vector<unsigned int>>& dependencies)
+    {
+        std::vector<std::shared_ptr<Interpolant>> interpolants(
+            builder_container.size());
+
+        // The table is set right away, as the following builders may need it
+        auto build = [&builder_container, &interpolants](unsigned int i) {
+            interpolants[i].reset(builder_container[i].first->build());
+            (*builder_container[i].second) = interpolants[i];
+        };
+
+        if (dependencies.empty()) {
+            for (unsigned int i = 0; i < builder_container.size(); ++i) {
+                build(i);
+            }
+            return interpolants;
+        }
+
+        if (dependencies.size() != builder_container.size()) {
+            log_fatal("Every interpolant builder needs its dependencies!");
+        }
+
+        TableScheduler scheduler(interpolation_def.number_of_threads);
+        for (unsigned int i = 0; i < builder_container.size(); ++i) {
+            scheduler.Add(std::bind(build, i), dependencies[i]);
+        }
+        scheduler.Run();
+
+        return interpolants;
+    }
+
+    // Starts the last line of a text table file
+    static const std::string checksum_tag = "checksum ";
+
+    // -------------------------------------------------------------------------
+    // //
+    static bool AssignInterpolants(std::shared_ptr<const TableFile> table_file,
+        InterpolantBuilderContainer& builder_container)
+    {
+        if (!table_file
+            || table_file->GetNumberOfTables() != builder_container.size()) {
+            return false;
+        }
+
+        // The tables read their values directly from the mapped file
+        for (unsigned int i = 0; i < builder_container.size(); ++i) {
+            std::shared_ptr<const Interpolant> table
+                = table_file->GetInterpolant(i);
+            if (!table) {
+                return false;
+            }
+            (*builder_container[i].second) = table;
+        }
+        return true;
+    }
+
+    // -------------------------------------------------------------------------
+    // //
+    static bool ReadPackedInterpolants(const std::string& path,
+        const std::string& key, InterpolantBuilderContainer& builder_container)
+    {
+        std::shared_ptr<const TablePack> pack = TablePack::Open(path);
+        if (!pack) {
+            return false;
+        }
+
+        if (!AssignInterpolants(pack->Find(key), builder_container)) {
+            // Entries are not replaced, so a corrupt one has to be removed
+            if (pack->HasKey(key)) {
+                log_warn("The tables %s in %s are corrupt! Remove them with "
+                         "table_pack prune.",
+                    key.c_str(), path.c_str());
+            }
+            return false;
+        }
+        return true;
+    }
+
+    // -------------------------------------------------------------------------
+    // //
+    static bool ReadInterpolants(const std::string& filename,
+        InterpolantBuilderContainer& builder_container, bool binary_tables)
+    {
+        if (binary_tables) {
+            return AssignInterpolants(
+                TableFile::Map(filename), builder_container);
+        }
+
+        std::ifstream input(filename.c_str());
+        std::stringstream content;
+        content << input.rdbuf();
+        std::string tables = content.str();
+
+        // The last line holds the checksum of the tables before it. Tables
+        // written before the checksum was introduced have no such line, they
+        // are read as they are, e.g. prebuilt tables of a readonly path.
+        size_t trailer = tables.rfind(checksum_tag);
+        uint64_t checksum = 0;
+
+        if (trailer != std::string::npos
+            && (!(std::istringstream(tables.substr(trailer + checksum_tag.size()))
+                    >> std::hex >> checksum)
+                || checksum != Checksum(tables.data(), trailer))) {
+            return false;
+        }
+
+        std::istringstream stream(tables.substr(0, trailer));
+        for (InterpolantBuilderContainer::iterator builder_it
+             = builder_container.begin();
+             builder_it != builder_container.end(); ++builder_it) {
+            std::shared_ptr<Interpolant> interpolant
+                = std::make_shared<Interpolant>();
+            if (!interpolant->Load(stream, binary_tables)) {
+                return false;
+            }
+            (*builder_it->second) = interpolant;
+        }
+        return true;
+    }
+
+    // -------------------------------------------------------------------------
+    // //
+    static bool WriteInterpolants(const std::string& filename,
+        const std::vector<std::shared_ptr<Interpolant>>& interpolants,
+        bool binary_tables)
+    {
+        if (binary_tables) {
+            std::vector<const Interpolant*> tables;
+            for (auto& interpolant : interpolants) {
+                tables.push_back(interpolant.get());
+            }
+            return TableFile::Write(filename, tables);
+        }
+
+        std::ostringstream output;
+        output.precision(std::numeric_limits<double>::max_digits10);
+
+        for (auto& interpolant : interpolants) {
+            interpolant->Save(output, binary_tables);
+        }
+
+        std::string tables = output.str();
+        output << checksum_tag << std::hex
+               << Checksum(tables.data(), tables.size()) << std::endl;
+        tables = output.str();
+
+        return WriteFileAtomic(filename, tables.data(), tables.size());
+    }
+
     // -------------------------------------------------------------------------
     // //
     void InitializeInterpolation(const std::string name,
         InterpolantBuilderContainer& builder_container,
         const std::vector<Parametrization*>& parametrizations,
-        const InterpolationDef interpolation_def)
+        const InterpolationDef interpolation_def,
+        const std::vector<std::vector<unsigned int>>& dependencies)
     {
         log_debug("Initialize %s interpolation.", name.c_str());
 
@@ -266,9 +518,32 @@ namespace Helper {
         }
         hash_combine(hash_digest, interpolation_def.GetHash());
 
-        bool storing_failed = false;
+        // The version of the dNdx tables is raised when their integration
+        // changes their values, so the files of former versions get another
+        // name and are not read.
+        if (name.compare("dNdx") == 0) {
+            const int dndx_table_version = 2;
+            hash_combine(hash_digest, dndx_table_version);
+        }
+
+        // Sectors may be built in parallel. The same table is only built and
+        // written by one of them, the others wait and read it afterwards.
+        // The tables share a fixed number of mutexes, chosen by the hash of
+        // their name, so a process building many tables does not gather a
+        // mutex for each of them. Tables sharing a mutex are built one after
+        // the other.
+        static std::array<std::mutex, 64> table_mutexes;
+
+        std::stringstream table_name;
+        table_name << name << "_" << hash_digest;
+        std::string key = table_name.str();
+
+        std::unique_lock<std::mutex> table_lock(
+            table_mutexes[std::hash<std::string>()(key) % table_mutexes.size()]);
+
         bool reading_worked = false;
         bool binary_tables = interpolation_def.do_binary_tables;
+        bool table_pack = binary_tables && interpolation_def.do_table_pack;
         bool just_use_readonly_path = interpolation_def.just_use_readonly_path;
         std::string pathname;
         std::stringstream filename;
@@ -277,46 +552,34 @@ namespace Helper {
         // // first check the reading paths if one of the reading paths already
         // has the required tables
         pathname = ResolvePath(interpolation_def.path_to_tables_readonly, true);
-        if (!pathname.empty()) {
-            filename << pathname << "/" << name << "_" << hash_digest;
-            if (!binary_tables) {
-                filename << ".txt";
+        if (!pathname.empty() && table_pack) {
+            filename << pathname << "/" << TablePack::file_name_;
+            reading_worked = ReadPackedInterpolants(
+                filename.str(), key, builder_container);
+
+            if (!reading_worked) {
+                log_debug("In the readonly path to the interpolation tables, "
+                          "the pack %s has no tables %s",
+                    filename.str().c_str(), key.c_str());
             }
+        } else if (!pathname.empty()) {
+            filename << pathname << "/" << name << "_" << hash_digest
+                     << (binary_tables ? TableFile::extension_ : ".txt");
             if (FileExist(filename.str())) {
-                std::ifstream input;
-                if (binary_tables) {
-                    input.open(filename.str().c_str(), std::ios::binary);
-                } else {
-                    input.open(filename.str().c_str());
-                }
+                log_debug("%s tables will be read from file: %s", name.c_str(),
+                    filename.str().c_str());
 
-                // check if file is empty
-                // this happens if multiple instances tries to load/create the
-                // tables in parallel and another process already starts to
-                // write this table now just hand over to writing process where
-                // it might saves them in memory if the other instance is still
-                // writing them down in the same path
-                if (input.peek() == std::ifstream::traits_type::eof()) {
-                    log_info("file %s is empty! Another process is presumably "
-                             "writing. "
-                             "Try another reading path or write in memory!",
+                // The files are written in one step, so a file failing the
+                // checks is corrupt
+                reading_worked = ReadInterpolants(
+                    filename.str(), builder_container, binary_tables);
+
+                if (!reading_worked) {
+                    log_warn("file %s is corrupt! Try the writing path or "
+                             "write in memory!",
                         filename.str().c_str());
-                } else {
-                    log_debug("%s tables will be read from file: %s",
-                        name.c_str(), filename.str().c_str());
-
-                    for (InterpolantBuilderContainer::iterator builder_it
-                         = builder_container.begin();
-                         builder_it != builder_container.end(); ++builder_it) {
-                        // TODO(mario): read check Tue 2017/09/05
-                        (*builder_it->second) = new Interpolant();
-                        (*builder_it->second)->Load(input, binary_tables);
-                    }
-                    reading_worked = true;
                 }
 
-                input.close();
-
             } else {
                 log_debug("In the readonly path to the interpolation tables, "
                           "the file %s "
@@ -348,86 +611,114 @@ namespace Helper {
         // clear the stringstream
         filename.str(std::string());
         filename.clear();
-        filename << pathname << "/" << name << "_" << hash_digest;
+        filename << pathname << "/" << name << "_" << hash_digest
+                 << (binary_tables ? TableFile::extension_ : ".txt");
 
-        if (!binary_tables) {
-            filename << ".txt";
-        }
+        if (pathname.empty()) {
+            log_debug("%s tables will be stored in memomy!", name.c_str());
 
-        if (!pathname.empty()) {
-            if (FileExist(filename.str())) {
-                std::ifstream input;
+            BuildInterpolants(
+                builder_container, interpolation_def, dependencies);
 
-                if (binary_tables) {
-                    input.open(filename.str().c_str(), std::ios::binary);
-                } else {
-                    input.open(filename.str().c_str());
-                }
+            log_debug("Initialize %s interpolation done.", name.c_str());
+            return;
+        }
 
-                // check if file is empty
-                // this happens if multiple instances try to write the tables in
-                // parallel now just one is writing them and the other just
-                // saves them in memory
-                if (input.peek() == std::ifstream::traits_type::eof()) {
-                    log_info("file %s is empty! Another process is presumably "
-                             "writing. "
-                             "Save this table in memory!",
-                        filename.str().c_str());
-                    storing_failed = true;
-                } else {
-                    log_debug("%s tables will be read from file: %s",
-                        name.c_str(), filename.str().c_str());
-
-                    for (InterpolantBuilderContainer::iterator builder_it
-                         = builder_container.begin();
-                         builder_it != builder_container.end(); ++builder_it) {
-                        // TODO(mario): read check Tue 2017/09/05
-                        (*builder_it->second) = new Interpolant();
-                        (*builder_it->second)->Load(input, binary_tables);
-                    }
-                }
+        if (table_pack) {
+            filename.str(std::string());
+            filename.clear();
+            filename << pathname << "/" << TablePack::file_name_;
+
+            // Processes and threads sharing the pack build every table once.
+            // Without the lock, the tables are built in memory.
+            TablePack::KeyLock key_lock(filename.str(), key);
+            if (!key_lock.IsLocked()) {
+                log_warn("Can not lock the tables %s in %s! They will be "
+                         "stored in memory.",
+                    key.c_str(), filename.str().c_str());
+            }
 
-                input.close();
+            if (ReadPackedInterpolants(
+                    filename.str(), key, builder_container)) {
+                log_debug("Initialize %s interpolation done.", name.c_str());
+                return;
+            }
+
+            if (!key_lock.IsLocked()) {
+                BuildInterpolants(
+                    builder_container, interpolation_def, dependencies);
             } else {
-                log_debug("%s tables will be saved to file: %s", name.c_str(),
+                log_debug("%s tables will be saved to pack: %s", name.c_str(),
                     filename.str().c_str());
 
-                std::ofstream output;
+                std::vector<std::shared_ptr<Interpolant>> interpolants
+                    = BuildInterpolants(
+                        builder_container, interpolation_def, dependencies);
 
-                if (binary_tables) {
-                    output.open(filename.str().c_str(), std::ios::binary);
-                } else {
-                    output.open(filename.str().c_str());
+                std::vector<const Interpolant*> tables;
+                for (auto& interpolant : interpolants) {
+                    tables.push_back(interpolant.get());
                 }
 
-                if (output.good()) {
-                    output.precision(16);
-
-                    for (InterpolantBuilderContainer::iterator builder_it
-                         = builder_container.begin();
-                         builder_it != builder_container.end(); ++builder_it) {
-                        (*builder_it->second) = builder_it->first->build();
-                        (*builder_it->second)->Save(output, binary_tables);
-                    }
-                } else {
-                    storing_failed = true;
-                    log_warn(
-                        "Can not open file %s for writing! Table will not be "
-                        "stored!",
+                if (!TablePack::Append(filename.str(), key, tables)) {
+                    log_warn("Can not append to the table pack %s! Table "
+                             "will not be stored!",
                         filename.str().c_str());
+                } else {
+                    ReadPackedInterpolants(
+                        filename.str(), key, builder_container);
                 }
-                output.close();
             }
+
+            log_debug("Initialize %s interpolation done.", name.c_str());
+            return;
         }
 
-        if (pathname.empty() || storing_failed) {
-            log_debug("%s tables will be stored in memomy!", name.c_str());
+        // Processes sharing the table directory build every table once, the
+        // others wait for the lock and read the table afterwards. Without the
+        // lock, the table is built in memory.
+        FileLock file_lock(filename.str());
+        if (!file_lock.IsLocked()) {
+            log_warn("Can not lock file %s! The table will be stored in "
+                     "memory.",
+                filename.str().c_str());
+        }
+
+        if (FileExist(filename.str())) {
+            log_debug("%s tables will be read from file: %s", name.c_str(),
+                filename.str().c_str());
 
-            for (InterpolantBuilderContainer::iterator builder_it
-                 = builder_container.begin();
-                 builder_it != builder_container.end(); ++builder_it) {
-                (*builder_it->second) = builder_it->first->build();
+            if (ReadInterpolants(
+                    filename.str(), builder_container, binary_tables)) {
+                log_debug("Initialize %s interpolation done.", name.c_str());
+                return;
             }
+
+            log_warn("file %s is corrupt! The table is built again.",
+                filename.str().c_str());
+        }
+
+        if (!file_lock.IsLocked()) {
+            BuildInterpolants(
+                builder_container, interpolation_def, dependencies);
+
+            log_debug("Initialize %s interpolation done.", name.c_str());
+            return;
+        }
+
+        log_debug("%s tables will be saved to file: %s", name.c_str(),
+            filename.str().c_str());
+
+        std::vector<std::shared_ptr<Interpolant>> interpolants
+            = BuildInterpolants(builder_container, interpolation_def, dependencies);
+
+        if (!WriteInterpolants(filename.str(), interpolants, binary_tables)) {
+            log_warn("Can not write file %s! Table will not be stored!",
+                filename.str().c_str());
+        } else if (binary_tables) {
+            // The built tables are replaced by the mapped ones, which are
+            // shared with the other processes reading the file
+            ReadInterpolants(filename.str(), builder_container, binary_tables);
         }
 
         log_debug("Initialize %s interpolation done.", name.c_str());
@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <cmath>
+#include <functional>
 
 #include <PROPOSAL/crossection/factories/PhotoPairFactory.h>
 #include "PROPOSAL/Logging.h"
@@ -6,8 +9,11 @@
 #include "PROPOSAL/propagation_utility/PropagationUtility.h"
 
 #include "PROPOSAL/crossection/CrossSection.h"
+#include "PROPOSAL/crossection/CrossSectionInterpolant.h"
 #include "PROPOSAL/crossection/parametrization/Parametrization.h"
 
+#include "PROPOSAL/math/TableScheduler.h"
+
 using namespace PROPOSAL;
 
 namespace PROPOSAL {
@@ -37,6 +43,8 @@ std::ostream& operator<<(std::ostream& os, Utility::Definition const& util_defin
  *                            Propagation utility                              *
  ******************************************************************************/
 
+const int Utility::nodes_per_dndx_node_ = 4;
+
 Utility::Definition::Definition()
     // : do_interpolation(true)
     // , interpolation_def()
@@ -179,6 +187,8 @@ Utility::Utility(const ParticleDef& particle_def,
     , medium_(medium)
     , cut_settings_(cut_settings)
     , crosssections_()
+    , log_energy_min_(0)
+    , log_energy_step_(0)
 {
     if(utility_def.brems_def.parametrization!=BremsstrahlungFactory::Enum::None) {
         crosssections_.push_back(BremsstrahlungFactory::Get().CreateBremsstrahlung(
@@ -247,25 +257,39 @@ Utility::Utility(const ParticleDef& particle_def,
     , medium_(medium)
     , cut_settings_(cut_settings)
     , crosssections_()
+    , log_energy_min_(0)
+    , log_energy_step_(0)
 {
+    // The cross sections are independent of each other, so their tables are
+    // built in parallel. The order of crosssections_ is kept.
+    std::vector<std::function<CrossSection*()> > factories;
+
     if(utility_def.brems_def.parametrization!=BremsstrahlungFactory::Enum::None) {
-        crosssections_.push_back(BremsstrahlungFactory::Get().CreateBremsstrahlung(
-                particle_def_, medium_, cut_settings_, utility_def.brems_def, interpolation_def));
+        factories.push_back([&]() {
+            return BremsstrahlungFactory::Get().CreateBremsstrahlung(
+                particle_def_, medium_, cut_settings_, utility_def.brems_def, interpolation_def);
+        });
     }
 
     if(utility_def.photo_def.parametrization!=PhotonuclearFactory::Enum::None) {
-        crosssections_.push_back(PhotonuclearFactory::Get().CreatePhotonuclear(
-                particle_def_, medium_, cut_settings_, utility_def.photo_def, interpolation_def));
+        factories.push_back([&]() {
+            return PhotonuclearFactory::Get().CreatePhotonuclear(
+                particle_def_, medium_, cut_settings_, utility_def.photo_def, interpolation_def);
+        });
     }
 
     if(utility_def.epair_def.parametrization!=EpairProductionFactory::Enum::None) {
-        crosssections_.push_back(EpairProductionFactory::Get().CreateEpairProduction(
-                particle_def_, medium_, cut_settings_, utility_def.epair_def, interpolation_def));
+        factories.push_back([&]() {
+            return EpairProductionFactory::Get().CreateEpairProduction(
+                particle_def_, medium_, cut_settings_, utility_def.epair_def, interpolation_def);
+        });
     }
 
     if(utility_def.ioniz_def.parametrization!=IonizationFactory::Enum::None) {
-        crosssections_.push_back(IonizationFactory::Get().CreateIonization(
-                particle_def_, medium_, cut_settings_, utility_def.ioniz_def, interpolation_def));
+        factories.push_back([&]() {
+            return IonizationFactory::Get().CreateIonization(
+                particle_def_, medium_, cut_settings_, utility_def.ioniz_def, interpolation_def);
+        });
     }else{
         log_debug("No Ionization cross section chosen. For lepton propagation,Initialization may fail because no cross"
                   "section for small energies are available. You may have to enable Ionization or set a higher e_low"
@@ -273,42 +297,74 @@ Utility::Utility(const ParticleDef& particle_def,
     }
 
     if(utility_def.annihilation_def.parametrization!=AnnihilationFactory::Enum::None) {
-        crosssections_.push_back(AnnihilationFactory::Get().CreateAnnihilation(
-                particle_def_, medium_, utility_def.annihilation_def, interpolation_def));
+        factories.push_back([&]() {
+            return AnnihilationFactory::Get().CreateAnnihilation(
+                particle_def_, medium_, utility_def.annihilation_def, interpolation_def);
+        });
         log_debug("Annihilation enabled");
     }
 
     if(utility_def.mupair_def.parametrization!=MupairProductionFactory::Enum::None) {
-        crosssections_.push_back(MupairProductionFactory::Get().CreateMupairProduction(
-                    particle_def_, medium_, cut_settings_, utility_def.mupair_def, interpolation_def));
+        factories.push_back([&]() {
+            return MupairProductionFactory::Get().CreateMupairProduction(
+                particle_def_, medium_, cut_settings_, utility_def.mupair_def, interpolation_def);
+        });
         log_debug("Mupair Production enabled");
     }
 
     if(utility_def.weak_def.parametrization!=WeakInteractionFactory::Enum::None) {
-        crosssections_.push_back(WeakInteractionFactory::Get().CreateWeakInteraction(
-                    particle_def_, medium_, utility_def.weak_def, interpolation_def));
+        factories.push_back([&]() {
+            return WeakInteractionFactory::Get().CreateWeakInteraction(
+                particle_def_, medium_, utility_def.weak_def, interpolation_def);
+        });
         log_debug("Weak Interaction enabled");
     }
 
     // Photon interactions
 
     if(utility_def.compton_def.parametrization!=ComptonFactory::Enum::None) {
-        crosssections_.push_back(ComptonFactory::Get().CreateCompton(
-                particle_def_, medium_, cut_settings_, utility_def.compton_def, interpolation_def));
+        factories.push_back([&]() {
+            return ComptonFactory::Get().CreateCompton(
+                particle_def_, medium_, cut_settings_, utility_def.compton_def, interpolation_def);
+        });
         log_debug("Compton enabled");
     }
 
     if(utility_def.photopair_def.parametrization!=PhotoPairFactory::Enum::None) {
-        crosssections_.push_back(PhotoPairFactory::Get().CreatePhotoPair(
-                particle_def_, medium_, utility_def.photopair_def, interpolation_def));
+        factories.push_back([&]() {
+            return PhotoPairFactory::Get().CreatePhotoPair(
+                particle_def_, medium_, utility_def.photopair_def, interpolation_def);
+        });
         log_debug("PhotoPairProduction enabled");
     }
+
+    std::vector<CrossSection*> crosssections(factories.size(), NULL);
+
+    TableScheduler scheduler(interpolation_def.number_of_threads);
+    for (unsigned int i = 0; i < factories.size(); ++i) {
+        scheduler.Add([&crosssections, &factories, i]() { crosssections[i] = factories[i](); });
+    }
+
+    try {
+        scheduler.Run();
+    } catch (...) {
+        for (CrossSection* crosssection : crosssections) {
+            delete crosssection;
+        }
+        throw;
+    }
+
+    crosssections_ = crosssections;
+
+    InitStochasticLossTables(interpolation_def);
 }
 
 Utility::Utility(const std::vector<CrossSection*>& crosssections) try
     : particle_def_(crosssections.at(0)->GetParametrization().GetParticleDef()),
       medium_(crosssections.at(0)->GetParametrization().GetMedium()),
-      cut_settings_(crosssections.at(0)->GetParametrization().GetEnergyCuts()) {
+      cut_settings_(crosssections.at(0)->GetParametrization().GetEnergyCuts()),
+      log_energy_min_(0),
+      log_energy_step_(0) {
     for (std::vector<CrossSection*>::const_iterator it = crosssections.begin();
          it != crosssections.end(); ++it) {
         if ((*it)->GetParametrization().GetParticleDef() != particle_def_) {
@@ -334,7 +390,13 @@ Utility::Utility(const Utility& collection)
     : particle_def_(collection.particle_def_),
       medium_(collection.medium_),
       cut_settings_(collection.cut_settings_),
-      crosssections_(collection.crosssections_.size(), NULL) {
+      crosssections_(collection.crosssections_.size(), NULL),
+      channels_(collection.channels_),
+      total_rates_(collection.total_rates_),
+      channel_tables_(collection.channel_tables_),
+      exact_bins_(collection.exact_bins_),
+      log_energy_min_(collection.log_energy_min_),
+      log_energy_step_(collection.log_energy_step_) {
     for (unsigned int i = 0; i < crosssections_.size(); ++i) {
         crosssections_[i] = collection.crosssections_[i]->clone();
     }
@@ -384,13 +446,123 @@ CrossSection* Utility::GetCrosssection(int typeId) const {
 }
 
 
+void Utility::InitStochasticLossTables(const InterpolationDef& def)
+{
+    if (def.channel_accuracy <= 0) {
+        return;
+    }
+
+    std::vector<CrossSectionInterpolant*> interpolants;
+    for (CrossSection* crosssection : crosssections_) {
+        CrossSectionInterpolant* interpolant = dynamic_cast<CrossSectionInterpolant*>(crosssection);
+        if (interpolant == nullptr) {
+            log_debug("Not all cross sections are interpolated, the interaction is chosen without tables.");
+            return;
+        }
+        interpolants.push_back(interpolant);
+    }
+
+    // The dNdx tables start at the mass, the propagation stops at low
+    double energy_min = std::max(particle_def_.low, particle_def_.mass);
+
+    if (interpolants.empty() || energy_min <= 0 || energy_min >= def.max_node_energy) {
+        return;
+    }
+
+    for (unsigned int i = 0; i < interpolants.size(); ++i) {
+        for (unsigned int j = 0; j < interpolants[i]->GetNumberOfComponentTables(); ++j) {
+            channels_.push_back(std::make_pair(i, static_cast<int>(j)));
+        }
+    }
+
+    // Rates of all channels, derived classes may switch off the interaction
+    // below a threshold
+    auto calculate_rates = [&](double energy, std::vector<double>& rates) {
+        double total_rate = 0;
+        for (unsigned int i = 0, k = 0; i < interpolants.size(); ++i) {
+            bool enabled = interpolants[i]->CalculatedNdx(energy) > 0;
+            for (unsigned int j = 0; j < interpolants[i]->GetNumberOfComponentTables(); ++j, ++k) {
+                rates[k] = enabled ? interpolants[i]->CalculatedNdxOfComponent(energy, j) : 0;
+                total_rate += rates[k];
+            }
+        }
+        return total_rate;
+    };
+
+    int nodes        = nodes_per_dndx_node_ * (def.nodes_cross_section - 1) + 1;
+    log_energy_min_  = std::log(energy_min);
+    log_energy_step_ = std::log(def.max_node_energy / energy_min) / (nodes - 1);
+
+    std::vector<double> rates(channels_.size());
+    std::vector<double> last_rates(channels_.size());
+    std::vector<double> middle_rates(channels_.size());
+
+    for (int node = 0; node < nodes; ++node) {
+        double total_rate = calculate_rates(std::exp(log_energy_min_ + node * log_energy_step_), rates);
+
+        if (total_rate > 0) {
+            channel_tables_.push_back(AliasTable(rates));
+        } else {
+            // never used, the bins next to this node are exact
+            channel_tables_.push_back(AliasTable(std::vector<double>(channels_.size(), 1.)));
+        }
+        total_rates_.push_back(total_rate);
+
+        if (node > 0) {
+            // In the middle of the bin, the probability of every channel
+            // has to match the exact one within the channel accuracy. This
+            // excludes thresholds and channels, which rise too steep for the
+            // grid.
+            double last_total_rate   = total_rates_[node - 1];
+            double middle_total_rate = calculate_rates(std::exp(log_energy_min_ + (node - 0.5) * log_energy_step_), middle_rates);
+
+            bool exact = total_rate <= 0 || last_total_rate <= 0 || middle_total_rate <= 0;
+
+            for (unsigned int k = 0; k < channels_.size() && !exact; ++k) {
+                double probability = (last_rates[k] + rates[k]) / (last_total_rate + total_rate);
+                double exact_probability = middle_rates[k] / middle_total_rate;
+
+                if (std::abs(probability - exact_probability) > def.channel_accuracy * exact_probability) {
+                    exact = true;
+                }
+            }
+            exact_bins_.push_back(exact);
+        }
+
+        rates.swap(last_rates);
+    }
+}
+
 std::pair<double, int> Utility::StochasticLoss(
     double particle_energy, double rnd1, double rnd2, double rnd3)
 {
+    if (!exact_bins_.empty()) {
+        double x = (std::log(particle_energy) - log_energy_min_) / log_energy_step_;
+
+        if (x >= 0 && x < exact_bins_.size() && !exact_bins_[static_cast<unsigned int>(x)]) {
+            // rnd1 chooses one of the two nodes, weighted with the linear
+            // interpolated total rate, rnd3 the channel at this node. So the
+            // channel rates are interpolated linear between the nodes, too.
+            unsigned int bin = static_cast<unsigned int>(x);
+            double weight    = x - bin;
+            double rate_low  = (1. - weight) * total_rates_[bin];
+            double rate_high = weight * total_rates_[bin + 1];
+
+            unsigned int node = (rnd1 * (rate_low + rate_high) < rate_low) ? bin : bin + 1;
+
+            const std::pair<unsigned int, int>& channel = channels_[channel_tables_[node].Sample(rnd3)];
+            CrossSectionInterpolant* crosssection = static_cast<CrossSectionInterpolant*>(crosssections_[channel.first]);
+
+            return std::make_pair(
+                crosssection->CalculateStochasticLossOfComponent(particle_energy, rnd2, channel.second),
+                crosssection->GetTypeId());
+        }
+    }
+
     double total_rate = 0;
     double total_rate_weighted = 0;
     double rates_sum = 0;
-    std::vector<double> rates;
+    std::vector<double>& rates = rates_;
     rates.resize(crosssections_.size());
 
     // return 0 and unknown, if there is no interaction
@@ -1,7 +1,10 @@
 
+#include <algorithm>
 #include <cmath>
 #include <functional>
+#include <memory>
 
+#include "PROPOSAL/math/FusedInterpolant.h"
 #include "PROPOSAL/math/Interpolant.h"
 #include "PROPOSAL/propagation_utility/PropagationUtilityIntegral.h"
 #include "PROPOSAL/propagation_utility/PropagationUtilityInterpolant.h"
@@ -13,6 +16,7 @@
 
 #include "PROPOSAL/math/InterpolantBuilder.h"
 #include "PROPOSAL/math/MathMethods.h"
+#include "PROPOSAL/math/TableScheduler.h"
 
 using namespace PROPOSAL;
 
@@ -24,8 +28,14 @@ UtilityInterpolant::UtilityInterpolant(
     const Utility& utility, InterpolationDef def)
     : UtilityDecorator(utility)
     , stored_result_(0)
-    , interpolant_(NULL)
-    , interpolant_diff_(NULL)
+    , interpolant_()
+    , interpolant_diff_()
+    , fused_cache_(NULL)
+    , fused_column_(0)
+    , interpolant_inverse_()
+    , lower_integral_(0)
+    , inverse_min_(0)
+    , inverse_energy_min_(0)
     , interpolation_def_(def)
 {
 }
@@ -34,8 +44,14 @@ UtilityInterpolant::UtilityInterpolant(
     const Utility& utility, const UtilityInterpolant& collection)
     : UtilityDecorator(utility)
     , stored_result_(collection.stored_result_)
-    , interpolant_(new Interpolant(*collection.interpolant_))
-    , interpolant_diff_(new Interpolant(*collection.interpolant_diff_))
+    , interpolant_(collection.interpolant_)
+    , interpolant_diff_(collection.interpolant_diff_)
+    , fused_cache_(NULL)
+    , fused_column_(0)
+    , interpolant_inverse_(collection.interpolant_inverse_)
+    , lower_integral_(collection.lower_integral_)
+    , inverse_min_(collection.inverse_min_)
+    , inverse_energy_min_(collection.inverse_energy_min_)
     , interpolation_def_(collection.interpolation_def_)
 {
     if (utility != collection.GetUtility()) {
@@ -46,17 +62,19 @@ UtilityInterpolant::UtilityInterpolant(
 UtilityInterpolant::UtilityInterpolant(const UtilityInterpolant& collection)
     : UtilityDecorator(collection)
     , stored_result_(collection.stored_result_)
-    , interpolant_(new Interpolant(*collection.interpolant_))
-    , interpolant_diff_(new Interpolant(*collection.interpolant_diff_))
+    , interpolant_(collection.interpolant_)
+    , interpolant_diff_(collection.interpolant_diff_)
+    , fused_cache_(NULL)
+    , fused_column_(0)
+    , interpolant_inverse_(collection.interpolant_inverse_)
+    , lower_integral_(collection.lower_integral_)
+    , inverse_min_(collection.inverse_min_)
+    , inverse_energy_min_(collection.inverse_energy_min_)
     , interpolation_def_(collection.interpolation_def_)
 {
 }
 
-UtilityInterpolant::~UtilityInterpolant()
-{
-    delete interpolant_;
-    delete interpolant_diff_;
-}
+UtilityInterpolant::~UtilityInterpolant() {}
 
 bool UtilityInterpolant::compare(
     const UtilityDecorator& utility_decorator) const
@@ -74,18 +92,128 @@ bool UtilityInterpolant::compare(
         return true;
 }
 
+// ------------------------------------------------------------------------- //
+void UtilityInterpolant::SetFusedTable(FusedInterpolantCache* cache, unsigned int column)
+{
+    fused_cache_ = cache;
+    fused_column_ = column;
+}
+
+// ------------------------------------------------------------------------- //
+double UtilityInterpolant::InterpolateIntegral(double energy)
+{
+    if (fused_cache_) {
+        return fused_cache_->Interpolate(energy, fused_column_);
+    }
+    return interpolant_->Interpolate(energy);
+}
+
+// ------------------------------------------------------------------------- //
+double UtilityInterpolant::InterpolateDiff(double energy)
+{
+    if (fused_cache_) {
+        return fused_cache_->Interpolate(energy, fused_column_ + 1);
+    }
+    return interpolant_diff_->Interpolate(energy);
+}
+
 // ------------------------------------------------------------------------- //
 double UtilityInterpolant::GetUpperLimit(double ei, double rnd)
 {
     return std::min(
         std::max(ei
                 + rnd
-                    / interpolant_diff_->Interpolate(
-                          ei + rnd / (2 * interpolant_diff_->Interpolate(ei))),
+                    / InterpolateDiff(
+                          ei + rnd / (2 * InterpolateDiff(ei))),
             utility_.GetParticleDef().low),
         ei);
 }
 
+// ------------------------------------------------------------------------- //
+double UtilityInterpolant::InverseLimit(double ei, double rnd)
+{
+    double remaining = std::abs(InterpolateIntegral(ei) - lower_integral_);
+
+    if (!interpolant_inverse_ || std::abs(rnd) <= remaining * HALF_PRECISION) {
+        return UtilityInterpolant::GetUpperLimit(ei, rnd);
+    }
+
+    const double low = utility_.GetParticleDef().low;
+
+    remaining -= rnd;
+    if (remaining <= 0) {
+        return low;
+    }
+
+    double energy;
+    if (remaining < inverse_min_) {
+        // below the table the integral grows linearly with the energy
+        energy = low + (inverse_energy_min_ - low) * remaining / inverse_min_;
+    } else {
+        energy = interpolant_inverse_->Interpolate(remaining);
+    }
+
+    // A single Newton step on the integral table removes the interpolation
+    // error of the inverse table, which matters if rnd is small compared to
+    // the remaining integral. Integral and integrand share one lookup.
+    energy = std::min(std::max(energy, low), ei);
+    double derivative = std::abs(InterpolateDiff(energy));
+    if (derivative > 0) {
+        energy += (remaining - std::abs(InterpolateIntegral(energy) - lower_integral_)) / derivative;
+    }
+
+    if (std::abs(ei - energy) <= std::abs(ei) * HALF_PRECISION) {
+        return UtilityInterpolant::GetUpperLimit(ei, rnd);
+    }
+
+    return std::min(std::max(energy, low), ei);
+}
+
+// ------------------------------------------------------------------------- //
+void UtilityInterpolant::InitInverseInterpolation()
+{
+    const double low = utility_.GetParticleDef().low;
+    const double high = interpolation_def_.max_node_energy;
+    const int nodes = interpolation_def_.nodes_propagate;
+
+    lower_integral_ = interpolant_->Interpolate(low);
+
+    std::function<double(double)> remaining = [this](double energy) {
+        return std::abs(interpolant_->Interpolate(energy) - lower_integral_);
+    };
+
+    // The inverse table starts at the first node of the integral table
+    inverse_energy_min_ = low * std::pow(high / low, 0.5 / nodes);
+    inverse_min_ = remaining(inverse_energy_min_);
+    double inverse_max = remaining(high);
+
+    if (!(inverse_min_ > 0) || !(inverse_max > inverse_min_)) {
+        // e.g. no decay at all, the midpoint approximation is used instead
+        interpolant_inverse_.reset();
+        return;
+    }
+
+    // The remaining integral rises monotonically with the energy, so the
+    // nodes are found by bisection in log(E)
+    std::function<double(double)> energy = [&remaining, low, high](double integral) {
+        double lower = std::log(low);
+        double upper = std::log(high);
+        for (int i = 0; i < 64; ++i) {
+            double middle = 0.5 * (lower + upper);
+            if (remaining(std::exp(middle)) < integral) {
+                lower = middle;
+            } else {
+                upper = middle;
+            }
+        }
+        return std::exp(0.5 * (lower + upper));
+    };
+
+    interpolant_inverse_ = std::make_shared<const Interpolant>(nodes, inverse_min_,
+        inverse_max, energy, interpolation_def_.order_of_interpolation, false,
+        false, true, interpolation_def_.order_of_interpolation, false, false, true);
+}
+
 // ------------------------------------------------------------------------- //
 void UtilityInterpolant::InitInterpolation(const std::string& name,
     UtilityIntegral& utility, int number_of_sampling_points)
@@ -93,12 +221,42 @@ void UtilityInterpolant::InitInterpolation(const std::string& name,
     Integral integral(IROMB, IMAXS, IPREC2);
     const ParticleDef& particle_def = utility_.GetParticleDef();
 
-    std::vector<std::pair<Interpolant**, std::function<double(double)>>>
+    // Nodes of the integral table, evaluated in the same way as in the
+    // constructor of the 1d Interpolant
+    double log_energy_min = std::log(particle_def.low);
+    double log_energy_step
+        = (std::log(interpolation_def_.max_node_energy) - log_energy_min)
+        / number_of_sampling_points;
+
+    std::vector<double> energies(number_of_sampling_points);
+    double aux = log_energy_min + log_energy_step / 2;
+    for (int i = 0; i < number_of_sampling_points; ++i) {
+        energies[i] = std::exp(aux);
+        aux += log_energy_step;
+    }
+
+    // The sweep is only done, if the table is not read from a file
+    std::vector<double> integrals;
+    std::function<double(double)> integral_at_node = [&](double energy) {
+        if (integrals.empty()) {
+            integrals = SweepIntegral(energies, utility, integral);
+        }
+
+        int i = (int)std::round(
+            (std::log(energy) - log_energy_min) / log_energy_step - 0.5);
+        i = std::min(std::max(i, 0), number_of_sampling_points - 1);
+
+        if (std::abs(energies[i] - energy) <= energy * HALF_PRECISION) {
+            return integrals[i];
+        }
+        return BuildInterpolant(energy, utility, integral);
+    };
+
+    std::vector<std::pair<std::shared_ptr<const Interpolant>*,
+        std::function<double(double)>>>
         interpolants;
 
-    interpolants.push_back(std::make_pair(&interpolant_,
-        std::bind(&UtilityInterpolant::BuildInterpolant, this,
-            std::placeholders::_1, std::ref(utility), std::ref(integral))));
+    interpolants.push_back(std::make_pair(&interpolant_, integral_at_node));
     interpolants.push_back(std::make_pair(&interpolant_diff_,
         std::bind(&UtilityIntegral::FunctionToIntegral, &utility,
             std::placeholders::_1)));
@@ -140,6 +298,76 @@ void UtilityInterpolant::InitInterpolation(const std::string& name,
         name, builder_container, params, interpolation_def_);
 }
 
+// ------------------------------------------------------------------------- //
+std::vector<double> UtilityInterpolant::SweepIntegral(
+    const std::vector<double>& energies, UtilityIntegral& utility,
+    Integral& integral)
+{
+    size_t number_of_steps = energies.size() - 1;
+    std::vector<double> steps(number_of_steps);
+
+    // The steps are split into one job per thread, the scheduler shares
+    // its threads with the schedulers of the enclosing table builds
+    TableScheduler scheduler(interpolation_def_.number_of_threads);
+    unsigned int n_jobs = static_cast<unsigned int>(
+        std::min<size_t>(scheduler.GetNumberOfThreads(), number_of_steps));
+    n_jobs = std::max(n_jobs, 1u);
+
+    // The first job uses the given utility, the others integrate with a
+    // copy, as the cross sections are not thread safe
+    std::vector<std::unique_ptr<Utility>> utility_copies;
+    std::vector<std::unique_ptr<UtilityDecorator>> integrand_copies;
+    for (unsigned int i = 1; i < n_jobs; ++i) {
+        utility_copies.emplace_back(new Utility(utility.GetUtility()));
+        integrand_copies.emplace_back(utility.clone(*utility_copies.back()));
+    }
+
+    for (unsigned int id = 0; id < n_jobs; ++id) {
+        scheduler.Add([&, id]() {
+            UtilityDecorator& integrand
+                = (id == 0) ? utility : *integrand_copies[id - 1];
+
+            // The steps between neighbouring nodes are short and converge
+            // with a lower order of the Romberg integration
+            Integral step_integral(IROMB - 1, IMAXS, IPREC2);
+            for (size_t i = id * number_of_steps / n_jobs;
+                 i < (id + 1) * number_of_steps / n_jobs; ++i) {
+                steps[i] = step_integral.Integrate(energies[i],
+                    energies[i + 1],
+                    std::bind(&UtilityDecorator::FunctionToIntegral,
+                        &integrand, std::placeholders::_1),
+                    4);
+            }
+        });
+    }
+    scheduler.Run();
+
+    std::vector<double> integrals(energies.size());
+    double first = BuildInterpolant(energies.front(), utility, integral);
+    double last = BuildInterpolant(energies.back(), utility, integral);
+
+    // Whether the table rises or falls with the steps follows from its ends
+    double sum = 0;
+    for (double step : steps) {
+        sum += step;
+    }
+    double sign = ((last - first) * sum < 0) ? -1 : 1;
+
+    if (std::abs(first) <= std::abs(last)) {
+        integrals.front() = first;
+        for (size_t i = 1; i <= number_of_steps; ++i) {
+            integrals[i] = integrals[i - 1] + sign * steps[i - 1];
+        }
+    } else {
+        integrals.back() = last;
+        for (size_t i = number_of_steps; i > 0; --i) {
+            integrals[i - 1] = integrals[i] - sign * steps[i - 1];
+        }
+    }
+
+    return integrals;
+}
+
 /******************************************************************************
  *                            Utility Displacement                            *
  ******************************************************************************/
@@ -174,8 +402,8 @@ double UtilityInterpolantDisplacement::Calculate(
     if (std::abs(ei - ef) > std::abs(ei) * HALF_PRECISION) {
         double aux;
 
-        stored_result_ = interpolant_->Interpolate(ei);
-        aux = stored_result_ - interpolant_->Interpolate(ef);
+        stored_result_ = InterpolateIntegral(ei);
+        aux = stored_result_ - InterpolateIntegral(ef);
 
         if (std::abs(aux) > std::abs(stored_result_) * HALF_PRECISION
             && aux >= 0) {
@@ -186,7 +414,7 @@ double UtilityInterpolantDisplacement::Calculate(
     stored_result_ = 0;
 
     return std::max(
-        (interpolant_diff_->Interpolate((ei + ef) / 2)) * (ef - ei), 0.0);
+        (InterpolateDiff((ei + ef) / 2)) * (ef - ei), 0.0);
 }
 
 double UtilityInterpolantDisplacement::Calculate(double ei, double ef,
@@ -198,8 +426,8 @@ double UtilityInterpolantDisplacement::Calculate(double ei, double ef,
         double aux;
         double displacement;
 
-        stored_result_ = interpolant_->Interpolate(ei);
-        aux = stored_result_ - interpolant_->Interpolate(ef);
+        stored_result_ = InterpolateIntegral(ei);
+        aux = stored_result_ - InterpolateIntegral(ef);
 
         try {
             displacement = utility_.GetMedium()->GetDensityDistribution().Correct(
@@ -217,21 +445,12 @@ double UtilityInterpolantDisplacement::Calculate(double ei, double ef,
     stored_result_ = 0;
 
     return std::max(
-        (interpolant_diff_->Interpolate((ei + ef) / 2)) * (ef - ei), 0.0);
+        (InterpolateDiff((ei + ef) / 2)) * (ef - ei), 0.0);
 }
 
-double UtilityInterpolantDisplacement::GetUpperLimit(double ei, double rnd) {
-    f = [&](double ef) { return Calculate(ei, ef, rnd) - rnd; };
-    df = [&](double ef) { return interpolant_diff_->Interpolate(ef); };
-
-    int MaxSteps = 200;
-    try{
-        return std::max(NewtonRaphson(f, df, 0, ei, ei, MaxSteps,
-                                      PARTICLE_POSITION_RESOLUTION), utility_.GetParticleDef().mass);
-    } catch (MathException& e){
-        return utility_.GetParticleDef().mass;
-    }
-
+double UtilityInterpolantDisplacement::GetUpperLimit(double ei, double rnd)
+{
+    return InverseLimit(ei, rnd);
 }
 
 double UtilityInterpolantDisplacement::BuildInterpolant(
@@ -249,6 +468,7 @@ void UtilityInterpolantDisplacement::InitInterpolation(const std::string& name,
 {
     UtilityInterpolant::InitInterpolation(
         name, utility, number_of_sampling_points);
+    InitInverseInterpolation();
 }
 
 /******************************************************************************
@@ -303,7 +523,7 @@ double UtilityInterpolantInteraction::Calculate(
     (void)rnd;
     (void)ef;
 
-    stored_result_ = interpolant_->Interpolate(ei);
+    stored_result_ = InterpolateIntegral(ei);
 
     if (up_) {
         return std::max(stored_result_, 0.0);
@@ -314,21 +534,7 @@ double UtilityInterpolantInteraction::Calculate(
 
 double UtilityInterpolantInteraction::GetUpperLimit(double ei, double rnd)
 {
-    if (std::abs(rnd) > std::abs(stored_result_) * HALF_PRECISION) {
-        double aux;
-
-        if (up_) {
-            aux = interpolant_->FindLimit(stored_result_ - rnd);
-        } else {
-            aux = interpolant_->FindLimit(stored_result_ + rnd);
-        }
-
-        if (std::abs(ei - aux) > std::abs(ei) * HALF_PRECISION) {
-            return std::min(std::max(aux, utility_.GetParticleDef().low), ei);
-        }
-    }
-
-    return UtilityInterpolant::GetUpperLimit(ei, rnd);
+    return InverseLimit(ei, rnd);
 }
 
 double UtilityInterpolantInteraction::BuildInterpolant(
@@ -375,6 +581,7 @@ void UtilityInterpolantInteraction::InitInterpolation(const std::string& name,
         name, utility, number_of_sampling_points);
 
     big_low_ = interpolant_->Interpolate(particle_def.low);
+    InitInverseInterpolation();
 }
 
 /******************************************************************************
@@ -428,7 +635,7 @@ double UtilityInterpolantDecay::Calculate(double ei, double ef, double rnd)
     (void)rnd;
     (void)ef;
 
-    stored_result_ = interpolant_->Interpolate(ei);
+    stored_result_ = InterpolateIntegral(ei);
 
     if (up_) {
         return std::max(stored_result_, 0.0);
@@ -439,17 +646,7 @@ double UtilityInterpolantDecay::Calculate(double ei, double ef, double rnd)
 
 double UtilityInterpolantDecay::GetUpperLimit(double ei, double rnd)
 {
-    if (std::abs(rnd) > std::abs(stored_result_) * HALF_PRECISION) {
-        double aux;
-
-        aux = interpolant_->FindLimit(stored_result_ + rnd);
-
-        if (std::abs(ei - aux) > std::abs(ei) * HALF_PRECISION) {
-            return std::min(std::max(aux, utility_.GetParticleDef().low), ei);
-        }
-    }
-
-    return UtilityInterpolant::GetUpperLimit(ei, rnd);
+    return InverseLimit(ei, rnd);
 }
 
 double UtilityInterpolantDecay::BuildInterpolant(
@@ -489,6 +686,7 @@ void UtilityInterpolantDecay::InitInterpolation(const std::string& name,
         name, utility, number_of_sampling_points);
 
     big_low_ = interpolant_->Interpolate(particle_def.low);
+    InitInverseInterpolation();
 }
 
 /******************************************************************************
@@ -522,15 +720,15 @@ double UtilityInterpolantTime::Calculate(double ei, double ef, double rnd)
     (void)rnd;
 
     if (std::abs(ei - ef) > std::abs(ei) * HALF_PRECISION) {
-        double aux = interpolant_->Interpolate(ei);
-        double aux2 = aux - interpolant_->Interpolate(ef);
+        double aux = InterpolateIntegral(ei);
+        double aux2 = aux - InterpolateIntegral(ef);
 
         if (std::abs(aux2) > std::abs(aux) * HALF_PRECISION) {
             return aux2;
         }
     }
 
-    return interpolant_diff_->Interpolate((ei + ef) / 2) * (ef - ei);
+    return InterpolateDiff((ei + ef) / 2) * (ef - ei);
 }
 
 // ------------------------------------------------------------------------- //
@@ -589,14 +787,14 @@ UtilityInterpolantContRand::~UtilityInterpolantContRand() {}
 double UtilityInterpolantContRand::Calculate(double ei, double ef, double rnd)
 {
     if (std::abs(ei - ef) > std::abs(ei) * HALF_PRECISION) {
-        double aux = interpolant_->Interpolate(ei);
-        double aux2 = aux - interpolant_->Interpolate(ef);
+        double aux = InterpolateIntegral(ei);
+        double aux2 = aux - InterpolateIntegral(ef);
 
         if (std::abs(aux2) > std::abs(aux) * HALF_PRECISION)
             return std::max(aux2, 0.0);
     } else {
         return std::max(
-            interpolant_diff_->Interpolate((ei + ef) / 2) * (ef - ei), 0.0);
+            InterpolateDiff((ei + ef) / 2) * (ef - ei), 0.0);
     }
 
     // If the previous conditions do not hold, create a temporary integral.
@@ -662,16 +860,16 @@ double UtilityInterpolantScattering::Calculate(double ei, double ef, double rnd)
     (void)rnd;
 
     if (std::abs(ei - ef) > std::abs(ei) * HALF_PRECISION) {
-        double aux = interpolant_->Interpolate(ei);
-        double aux2 = aux - interpolant_->Interpolate(ef);
+        double aux = InterpolateIntegral(ei);
+        double aux2 = aux - InterpolateIntegral(ef);
 
         if (std::abs(aux2) > std::abs(aux) * HALF_PRECISION) {
             return aux2;
         } else {
-            return interpolant_diff_->Interpolate((ei + ef) / 2) * (ef - ei);
+            return InterpolateDiff((ei + ef) / 2) * (ef - ei);
         }
     } else {
-        return interpolant_diff_->Interpolate((ei + ef) / 2) * (ef - ei);
+        return InterpolateDiff((ei + ef) / 2) * (ef - ei);
     }
 }
 
@@ -7,6 +7,7 @@
  *   \author Tomasz Fuchs
  **/
 
+#include <algorithm>
 #include <cmath>
 
 #include "PROPOSAL/math/Vector3D.h"
@@ -16,6 +17,43 @@
 
 using namespace PROPOSAL;
 
+namespace {
+
+// Rotates the sampled angles (sx, sy) and (tx, ty) into the frame of the
+// direction. The frame is built from the cartesian coordinates, so it does
+// not need the spherical coordinates of the direction to be up to date.
+// u is the averaged direction of the step, n the direction after it.
+void Rotate(const Vector3D& direction, double sx, double sy, double tx, double ty, double* u, double* n)
+{
+    double x = direction.GetX();
+    double y = direction.GetY();
+    double z = direction.GetZ();
+
+    double rho_sq = x * x + y * y;
+    double rho    = std::sqrt(rho_sq);
+    double r      = std::sqrt(rho_sq + z * z);
+
+    double sinth = r > 0 ? rho / r : 0.;
+    double costh = r > 0 ? z / r : 1.;
+    double sinph = rho > 0 ? y / rho : 0.;
+    double cosph = rho > 0 ? x / rho : 1.;
+
+    double sz = std::sqrt(std::max(1. - (sx * sx + sy * sy), 0.));
+    double tz = std::sqrt(std::max(1. - (tx * tx + ty * ty), 0.));
+
+    // Rotation towards all tree axes with the axes
+    // (costh * cosph, costh * sinph, -sinth) and (-sinph, cosph, 0)
+    u[0] = sz * x + sx * (costh * cosph) + sy * (-sinph);
+    u[1] = sz * y + sx * (costh * sinph) + sy * cosph;
+    u[2] = sz * z + sx * (-sinth);
+
+    n[0] = tz * x + tx * (costh * cosph) + ty * (-sinph);
+    n[1] = tz * y + tx * (costh * sinph) + ty * cosph;
+    n[2] = tz * z + tx * (-sinth);
+}
+
+} // namespace
+
 /******************************************************************************
  *                                  OStream                                    *
  ******************************************************************************/
@@ -98,34 +136,71 @@ Directions Scattering::Scatter(double dr,
         return directions_;
     }
 
-    double sz, tz;
-
     RandomAngles random_angles = CalculateRandomAngle(dr, ei, ef, pos, rnd1, rnd2, rnd3, rnd4);
 
-    sz = std::sqrt(std::max(1. - (random_angles.sx * random_angles.sx + random_angles.sy * random_angles.sy), 0.));
-    tz = std::sqrt(std::max(1. - (random_angles.tx * random_angles.tx + random_angles.ty * random_angles.ty), 0.));
+    double u[3], n_i[3];
+    Rotate(old_direction, random_angles.sx, random_angles.sy, random_angles.tx, random_angles.ty, u, n_i);
+
+    directions_.u_   = Vector3D(u[0], u[1], u[2]);
+    directions_.n_i_ = Vector3D(n_i[0], n_i[1], n_i[2]);
+    directions_.n_i_.CalculateSphericalCoordinates();
+
+    return directions_;
+}
+
+void Scattering::Scatter(size_t n,
+                         const double* dr,
+                         const double* ei,
+                         const double* ef,
+                         Vector3D* positions,
+                         Vector3D* directions,
+                         RandomStream* const* random_streams)
+{
+    random_numbers_.resize(4 * n);
+    random_angles_.resize(n);
+
+    // Draw all numbers first, every particle takes four like the single
+    // particle Scatter, even if it does not move
+    for (size_t i = 0; i < n; ++i) {
+        double* rnd = &random_numbers_[4 * i];
+        for (int j = 0; j < 4; ++j) {
+            rnd[j] = random_streams ? random_streams[i]->RandomDouble() : RandomGenerator::Get().RandomDouble();
+        }
+    }
 
-    double sinth, costh, sinph, cosph;
-    sinth = std::sin(old_direction.GetTheta());
-    costh = std::cos(old_direction.GetTheta());
-    sinph = std::sin(old_direction.GetPhi());
-    cosph = std::cos(old_direction.GetPhi());
+    CalculateRandomAngles(n, dr, ei, ef, positions, random_numbers_.data(), random_angles_.data());
 
-    const Vector3D rotate_vector_x = Vector3D(costh * cosph, costh * sinph, -sinth);
-    const Vector3D rotate_vector_y = Vector3D(-sinph, cosph, 0.);
+    for (size_t i = 0; i < n; ++i) {
+        if (dr[i] <= 0) {
+            // see the single particle Scatter, the averaged direction is zero
+            positions[i] = positions[i] + dr[i] * Vector3D();
+            continue;
+        }
 
-    // Rotation towards all tree axes
-    directions_.u_ = sz * old_direction;
-    directions_.u_ = directions_.u_ + random_angles.sx * rotate_vector_x;
-    directions_.u_ = directions_.u_ + random_angles.sy * rotate_vector_y;
+        const RandomAngles& angles = random_angles_[i];
+        double u[3], n_i[3];
+        Rotate(directions[i], angles.sx, angles.sy, angles.tx, angles.ty, u, n_i);
 
-    // Rotation towards all tree axes
-    directions_.n_i_ = tz * old_direction;
-    directions_.n_i_ = directions_.n_i_ + random_angles.tx * rotate_vector_x;
-    directions_.n_i_ = directions_.n_i_ + random_angles.ty * rotate_vector_y;
-    directions_.n_i_.CalculateSphericalCoordinates();
+        positions[i]  = positions[i] + dr[i] * Vector3D(u[0], u[1], u[2]);
+        directions[i] = Vector3D(n_i[0], n_i[1], n_i[2]);
+        directions[i].CalculateSphericalCoordinates();
+    }
+}
 
-    return directions_;
+void Scattering::CalculateRandomAngles(size_t n,
+                                       const double* dr,
+                                       const double* ei,
+                                       const double* ef,
+                                       const Vector3D* positions,
+                                       const double* rnd,
+                                       RandomAngles* angles)
+{
+    for (size_t i = 0; i < n; ++i) {
+        if (dr[i] > 0) {
+            const double* r = &rnd[4 * i];
+            angles[i] = CalculateRandomAngle(dr[i], ei[i], ef[i], positions[i], r[0], r[1], r[2], r[3]);
+        }
+    }
 }
 
 Scattering::RandomAngles Scattering::CalculateRandomAngle(double dr, double ei, double ef, const Vector3D& pos)
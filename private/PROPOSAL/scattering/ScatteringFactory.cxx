@@ -54,7 +54,7 @@ Scattering* ScatteringFactory::CreateScattering(const std::string& name,
             return new ScatteringHighlandIntegral(particle_def, utility, interpolation_def);
         } else if (*iter == "moliere")
         {
-            return new ScatteringMoliere(particle_def, utility.GetMedium());
+            return new ScatteringMoliere(particle_def, utility.GetMedium(), interpolation_def);
         } else if (*iter == "highland")
         {
             return new ScatteringHighland(particle_def, utility.GetMedium());
@@ -89,7 +89,7 @@ Scattering* ScatteringFactory::CreateScattering(const Enum model,
             return new ScatteringHighlandIntegral(particle_def, utility, interpolation_def);
         } else if (*iter == Moliere)
         {
-            return new ScatteringMoliere(particle_def, utility.GetMedium());
+            return new ScatteringMoliere(particle_def, utility.GetMedium(), interpolation_def);
         } else if (*iter == Highland)
         {
             return new ScatteringHighland(particle_def, utility.GetMedium());
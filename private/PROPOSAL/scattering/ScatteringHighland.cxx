@@ -58,9 +58,13 @@ void ScatteringHighland::print(std::ostream& os) const
 // ------------------------------------------------------------------------- //
 
 double ScatteringHighland::CalculateTheta0(double dr, double ei, const Vector3D& pos) {
+    return CalculateTheta0(dr / medium_->GetRadiationLength(pos), ei);
+}
+
+double ScatteringHighland::CalculateTheta0(double y, double ei) const {
     // eq 6 of Lynch, Dahl
     // Nuclear Instruments and Methods in Physics Research Section B 58 (1991)
-    double y = dr / medium_->GetRadiationLength(pos);
+    // with the thickness y in radiation lengths
     double momentum_Sq = (ei - particle_def_.mass) * (ei + particle_def_.mass);
     double beta_p = momentum_Sq / ei; // beta * p = p^2/sqrt(p^2 + m^2)
     y = 13.6 * std::abs(particle_def_.charge) /
@@ -100,3 +104,52 @@ Scattering::RandomAngles ScatteringHighland::CalculateRandomAngle(double dr,
 
     return random_angles;
 }
+
+//----------------------------------------------------------------------------//
+
+void ScatteringHighland::CalculateRandomAngles(size_t n,
+                                               const double* dr,
+                                               const double* ei,
+                                               const double* ef,
+                                               const Vector3D* positions,
+                                               const double* rnd,
+                                               RandomAngles* angles) {
+    (void)ef;
+
+    theta0_.resize(n);
+    probabilities_.resize(4 * n);
+    gaussians_.resize(4 * n);
+
+    // The radiation length depends on the density distribution, so it is
+    // looked up first and the remaining steps only work on arrays.
+    for (size_t i = 0; i < n; ++i) {
+        theta0_[i] = dr[i] > 0 ? dr[i] / medium_->GetRadiationLength(positions[i]) : 1.;
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        theta0_[i] = CalculateTheta0(theta0_[i], ei[i]);
+    }
+
+    // Particles which do not move keep their numbers out of the inverse
+    // error function, like in the single particle Scatter
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < 4; ++j) {
+            probabilities_[4 * i + j] = dr[i] > 0 ? rnd[4 * i + j] : 0.5;
+        }
+    }
+
+    inverseErrorFunction(probabilities_.data(), gaussians_.data(), 4 * n);
+
+    for (size_t i = 0; i < n; ++i) {
+        const double* gaussian = &gaussians_[4 * i];
+        double rnd1 = theta0_[i] * gaussian[0];
+        double rnd2 = theta0_[i] * gaussian[1];
+        double rnd3 = theta0_[i] * gaussian[2];
+        double rnd4 = theta0_[i] * gaussian[3];
+
+        angles[i].sx = 0.5 * (rnd1 / SQRT3 + rnd2);
+        angles[i].tx = rnd2;
+        angles[i].sy = 0.5 * (rnd3 / SQRT3 + rnd4);
+        angles[i].ty = rnd4;
+    }
+}
@@ -1,16 +1,24 @@
 
 #include <cmath>
+#include <limits>
+#include <map>
+#include <mutex>
 
 #include "PROPOSAL/scattering/ScatteringMoliere.h"
 #include "PROPOSAL/Constants.h"
 #include "PROPOSAL/medium/Components.h"
 #include "PROPOSAL/medium/Medium.h"
 #include "PROPOSAL/math/MathMethods.h"
+#include "PROPOSAL/math/QuantileTable.h"
+#include "PROPOSAL/methods.h"
 #include "PROPOSAL/particle/ParticleDef.h"
 #include "PROPOSAL/scattering/Coefficients.h"
 
 using namespace PROPOSAL;
 
+const double ScatteringMoliere::B_min_ = 4.5;
+const double ScatteringMoliere::B_max_ = 30.;
+
 //----------------------------------------------------------------------------//
 //----------------------------------------------------------------------------//
 //-------------------------public member functions----------------------------//
@@ -36,14 +44,11 @@ Scattering::RandomAngles ScatteringMoliere::CalculateRandomAngle(double dr,
 
     double chi_0 = 0.;
 
-    std::vector<double> chi_A_Sq; // screening angle^2 in rad^2
-    chi_A_Sq.resize(numComp_);
-
     for (int i = 0; i < numComp_; i++) {
         // Calculate Chi_0 * p
         chi_0 = ME * ALPHA * std::pow(Zi_[i] * 128. / (9. * PI * PI), 1. / 3.);
         // Calculate Chi_a^2
-        chi_A_Sq[i] = chi_0 * chi_0 / momentum_Sq *
+        chi_A_Sq_[i] = chi_0 * chi_0 / momentum_Sq *
                       (1.13 + 3.76 * ALPHA * ALPHA * Zi_[i] * Zi_[i] / beta_Sq);
     }
 
@@ -64,14 +69,14 @@ Scattering::RandomAngles ScatteringMoliere::CalculateRandomAngle(double dr,
         double xn = 15.;
 
         for (int n = 0; n < 6; n++) {
-            xn = xn * ((1. - std::log(xn) - std::log(chiCSq_ / chi_A_Sq[i]) -
+            xn = xn * ((1. - std::log(xn) - std::log(chiCSq_ / chi_A_Sq_[i]) -
                         1. + 2. * EULER_MASCHERONI) /
                        (1. - xn));
         }
 
         //  Check for inappropriate values of B. If B < 4.5 it is practical to
         //  assume no deviation.
-        if ((xn < 4.5) || xn != xn) {
+        if ((xn < B_min_) || xn != xn) {
             random_angles.sx = 0;
             random_angles.sy = 0;
             random_angles.tx = 0;
@@ -82,19 +87,25 @@ Scattering::RandomAngles ScatteringMoliere::CalculateRandomAngle(double dr,
         B_[i] = xn;
     }
 
-    double pre_factor = std::sqrt(chiCSq_ * B_[max_weight_index_]);
-
-    rnd1 = GetRandom(pre_factor, rnd1);
-    rnd2 = GetRandom(pre_factor, rnd2);
+    if (quantile_table_) {
+        rnd1 = GetRandomFromTable(rnd1);
+        rnd2 = GetRandomFromTable(rnd2);
+        rnd3 = GetRandomFromTable(rnd3);
+        rnd4 = GetRandomFromTable(rnd4);
+    } else {
+        double pre_factor = std::sqrt(chiCSq_ * B_[max_weight_index_]);
+
+        rnd1 = GetRandom(pre_factor, rnd1);
+        rnd2 = GetRandom(pre_factor, rnd2);
+        rnd3 = GetRandom(pre_factor, rnd3);
+        rnd4 = GetRandom(pre_factor, rnd4);
+    }
 
     random_angles.sx = 0.5 * (rnd1 / SQRT3 + rnd2);
     random_angles.tx = rnd2;
 
-    rnd1 = GetRandom(pre_factor, rnd3);
-    rnd2 = GetRandom(pre_factor, rnd4);
-
-    random_angles.sy = 0.5 * (rnd1 / SQRT3 + rnd2);
-    random_angles.ty = rnd2;
+    random_angles.sy = 0.5 * (rnd3 / SQRT3 + rnd4);
+    random_angles.ty = rnd4;
 
     return random_angles;
 }
@@ -115,7 +126,9 @@ ScatteringMoliere::ScatteringMoliere(const ParticleDef& particle_def, std::share
       weight_ZZ_sum_(0.),
       max_weight_index_(0),
       chiCSq_(0.0),
-      B_(numComp_) {
+      chi_A_Sq_(numComp_),
+      B_(numComp_),
+      quantile_table_(NULL) {
     std::vector<double> Ai(numComp_,
                            0);  // atomic number of different components
     std::vector<double> ki(
@@ -162,6 +175,14 @@ ScatteringMoliere::ScatteringMoliere(const ParticleDef& particle_def, std::share
     }
 }
 
+ScatteringMoliere::ScatteringMoliere(const ParticleDef& particle_def,
+                                     std::shared_ptr<const Medium> medium,
+                                     const InterpolationDef& interpolation_def)
+    : ScatteringMoliere(particle_def, medium) {
+    if (interpolation_def.quantile_accuracy > 0)
+        quantile_table_ = GetQuantileTable(interpolation_def.quantile_accuracy);
+}
+
 ScatteringMoliere::ScatteringMoliere(const ScatteringMoliere& scattering)
     : Scattering(scattering),
       medium_(scattering.medium_),
@@ -172,7 +193,9 @@ ScatteringMoliere::ScatteringMoliere(const ScatteringMoliere& scattering)
       weight_ZZ_sum_(scattering.weight_ZZ_sum_),
       max_weight_index_(scattering.max_weight_index_),
       chiCSq_(scattering.chiCSq_),
-      B_(scattering.B_) {}
+      chi_A_Sq_(scattering.chi_A_Sq_),
+      B_(scattering.B_),
+      quantile_table_(scattering.quantile_table_) {}
 
 ScatteringMoliere::ScatteringMoliere(const ParticleDef& particle_def,
                                      const ScatteringMoliere& scattering)
@@ -185,7 +208,9 @@ ScatteringMoliere::ScatteringMoliere(const ParticleDef& particle_def,
       weight_ZZ_sum_(scattering.weight_ZZ_sum_),
       max_weight_index_(scattering.max_weight_index_),
       chiCSq_(scattering.chiCSq_),
-      B_(scattering.B_) {}
+      chi_A_Sq_(scattering.chi_A_Sq_),
+      B_(scattering.B_),
+      quantile_table_(scattering.quantile_table_) {}
 
 ScatteringMoliere::~ScatteringMoliere() {
 }
@@ -217,6 +242,10 @@ bool ScatteringMoliere::compare(const Scattering& scattering) const {
         return false;
     else if (B_ != scatteringMoliere->B_)
         return false;
+    else if (!quantile_table_ != !scatteringMoliere->quantile_table_)
+        return false;
+    else if (quantile_table_ && *quantile_table_ != *scatteringMoliere->quantile_table_)
+        return false;
     else
         return true;
 }
@@ -407,3 +436,109 @@ double ScatteringMoliere::GetRandom(double pre_factor, double rnd) {
 
     return theta_np1;
 }
+
+//----------------------------------------------------------------------------//
+
+double ScatteringMoliere::GetRandomFromTable(double rnd) {
+    //  Moliere's distribution of the medium is the sum of the distributions
+    //  of its components. The component is chosen by the random number and
+    //  the remaining part of it is the probability within the component.
+    int i = 0;
+    double weight = weight_ZZ_[0] * weight_ZZ_sum_;
+
+    while (i + 1 < numComp_ && rnd >= weight) {
+        rnd -= weight;
+        weight = weight_ZZ_[++i] * weight_ZZ_sum_;
+    }
+
+    double u = std::min(rnd / weight, 1.);
+    double edge = quantile_table_->GetEdgeProbability();
+    double t;
+
+    // the table does not resolve the diverging ends of the quantile function
+    if (B_[i] > B_max_ || u < edge || u > 1. - edge)
+        t = Quantile(B_[i], u);
+    else
+        t = quantile_table_->Interpolate(B_[i], u);
+
+    return std::sqrt(chiCSq_ * B_[i]) * t;
+}
+
+//----------------------------------------------------------------------------//
+//--------------------distribution of a single component----------------------//
+//----------------------------------------------------------------------------//
+
+double ScatteringMoliere::Density(double B, double t) {
+    double x = t * t;
+
+    return std::sqrt(1. / PI) * (std::exp(-x) + f1M(x) / B + f2M(x) / (B * B));
+}
+
+double ScatteringMoliere::CumulativeDistribution(double B, double t) {
+    double x = t * t;
+    double y = 0.5 * std::erf(std::abs(t)) +
+               std::sqrt(1. / PI) * (F1M(x) / B + F2M(x) / (B * B));
+
+    return (t < 0.) ? 0.5 - y : 0.5 + y;
+}
+
+double ScatteringMoliere::Quantile(double B, double u) {
+    //  The distribution is symmetric, so t is determined for the upper half
+    //  with the Newton-Raphson method. Steps which leave the interval known
+    //  to contain t are replaced by bisection, so the iteration converges
+    //  in the tails as well.
+    double p = std::max(u, 1. - u);
+    double lower = 0.;
+    double upper = std::numeric_limits<double>::infinity();
+
+    // guessing an initial value by assuming a gaussian distribution
+    double t = inverseErrorFunction(
+                   std::min(p, 1. - std::numeric_limits<double>::epsilon())) /
+               SQRT2;
+
+    for (int n = 0; n < 100; n++) {
+        double diff = CumulativeDistribution(B, t) - p;
+
+        if (diff == 0.)
+            break;
+        else if (diff < 0.)
+            lower = t;
+        else
+            upper = t;
+
+        double t_new = t - diff / Density(B, t);
+
+        if (!(t_new > lower && t_new < upper))
+            t_new = std::isinf(upper) ? 2. * t + 1. : 0.5 * (lower + upper);
+
+        bool converged = std::abs(t_new - t) <= 1e-10 * t_new;
+        t = t_new;
+
+        if (converged)
+            break;
+    }
+
+    return (u < 0.5) ? -t : t;
+}
+
+//----------------------------------------------------------------------------//
+
+std::shared_ptr<const QuantileTable> ScatteringMoliere::GetQuantileTable(double accuracy) {
+    //  The table depends neither on the medium nor on the particle, so it is
+    //  shared by all instances with the same accuracy.
+    static std::mutex mutex;
+    static std::map<double, std::weak_ptr<const QuantileTable> > tables;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::shared_ptr<const QuantileTable> table = tables[accuracy].lock();
+
+    if (!table) {
+        table = std::make_shared<QuantileTable>(9, B_min_, B_max_, 33,
+                                                &ScatteringMoliere::Quantile,
+                                                &ScatteringMoliere::CumulativeDistribution,
+                                                accuracy, true);
+        tables[accuracy] = table;
+    }
+
+    return table;
+}
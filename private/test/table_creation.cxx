@@ -0,0 +1,247 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+#include "PROPOSAL/PROPOSAL.h"
+#include "PROPOSAL/math/TableScheduler.h"
+
+using namespace PROPOSAL;
+
+namespace {
+
+struct Job
+{
+    std::string config_file;
+    nlohmann::json config;
+    const ParticleDef* particle_def;
+    std::string path;
+    double seconds;
+};
+
+const ParticleDef* FindParticle(const std::string& name)
+{
+    for (const auto& particle : Type_Particle_Map) {
+        if (particle.second.name == name)
+            return &particle.second;
+    }
+    return NULL;
+}
+
+std::vector<std::string> Split(const std::string& list)
+{
+    std::vector<std::string> names;
+    size_t begin = 0;
+    while (begin <= list.size()) {
+        size_t end = std::min(list.find(',', begin), list.size());
+        if (end > begin)
+            names.push_back(list.substr(begin, end - begin));
+        begin = end + 1;
+    }
+    return names;
+}
+
+bool EndsWith(const std::string& name, const std::string& suffix)
+{
+    return name.size() >= suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool CreateDirectory(const std::string& path)
+{
+    for (size_t pos = path.find('/', 1); ; pos = path.find('/', pos + 1)) {
+        std::string parent = path.substr(0, pos);
+        if (mkdir(parent.c_str(), 0755) != 0 && errno != EEXIST)
+            return false;
+        if (pos == std::string::npos)
+            return true;
+    }
+}
+
+// Prints the table files of the directory and their sizes
+void PrintTables(const std::string& path, bool table_pack)
+{
+    if (table_pack) {
+        std::string file = path + "/" + TablePack::file_name_;
+        std::shared_ptr<const TablePack> pack = TablePack::Open(file);
+        if (!pack) {
+            std::cout << file << " is no table pack" << std::endl;
+            return;
+        }
+        std::cout << file << ": " << pack->GetKeys().size() << " tables, " << pack->GetSize() << " bytes" << std::endl;
+        return;
+    }
+
+    std::vector<std::pair<std::string, uint64_t> > files;
+    DIR* directory = opendir(path.c_str());
+    if (directory) {
+        while (dirent* entry = readdir(directory)) {
+            std::string name = entry->d_name;
+            struct stat status;
+            if (!EndsWith(name, TableFile::extension_) && !EndsWith(name, ".txt"))
+                continue;
+            if (stat((path + "/" + name).c_str(), &status) == 0 && S_ISREG(status.st_mode))
+                files.push_back(std::make_pair(name, status.st_size));
+        }
+        closedir(directory);
+    }
+    std::sort(files.begin(), files.end());
+
+    uint64_t total = 0;
+    for (const auto& file : files) {
+        std::cout << std::setw(12) << file.second << "  " << file.first << std::endl;
+        total += file.second;
+    }
+    std::cout << path << ": " << files.size() << " tables, " << total << " bytes" << std::endl;
+}
+
+void PrintUsage(const char* program)
+{
+    std::cerr << "usage: " << program << " [options] <config>..." << std::endl
+              << std::endl
+              << "Builds the interpolation tables of the propagator configs for every" << std::endl
+              << "particle, tables which already exist are not built again." << std::endl
+              << std::endl
+              << "  -p, --particles <names>  comma separated particle names (default MuMinus)," << std::endl
+              << "                           e.g. MuMinus,MuPlus,TauMinus" << std::endl
+              << "  -o, --output <dir>       table directory, replaces the paths of the configs" << std::endl
+              << "  --pack                   write the tables of a directory into one table pack" << std::endl
+              << "  -j, --threads <n>        number of threads, 0 uses all hardware threads" << std::endl
+              << "                           (default 0)" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, const char* argv[])
+{
+    std::vector<std::string> particle_names(1, "MuMinus");
+    std::vector<std::string> config_files;
+    std::string output;
+    bool table_pack = false;
+    unsigned int n_threads = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if ((argument == "-p" || argument == "--particles") && has_value) {
+            particle_names = Split(argv[++i]);
+        } else if ((argument == "-o" || argument == "--output") && has_value) {
+            output = argv[++i];
+        } else if ((argument == "-j" || argument == "--threads") && has_value) {
+            n_threads = std::strtoul(argv[++i], NULL, 10);
+        } else if (argument == "--pack") {
+            table_pack = true;
+        } else if (!argument.empty() && argument[0] != '-') {
+            config_files.push_back(argument);
+        } else {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (config_files.empty() || particle_names.empty()) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    if (!output.empty() && !CreateDirectory(output)) {
+        std::cerr << "Unable to create the directory " << output << std::endl;
+        return 1;
+    }
+
+    std::vector<const ParticleDef*> particle_defs;
+    for (const std::string& name : particle_names) {
+        const ParticleDef* particle_def = FindParticle(name);
+        if (!particle_def) {
+            std::cerr << "Unknown particle " << name << std::endl;
+            return 1;
+        }
+        particle_defs.push_back(particle_def);
+    }
+
+    // One job per config and particle. The tables are written under locks,
+    // so jobs which need the same tables build them only once.
+    std::vector<Job> jobs;
+    for (const std::string& config_file : config_files) {
+        nlohmann::json config;
+        std::ifstream file(Helper::ResolvePath(config_file, true));
+        try {
+            file >> config;
+        } catch (const nlohmann::json::parse_error& e) {
+            std::cerr << "Unable to parse " << config_file << " as json file" << std::endl;
+            return 1;
+        }
+
+        nlohmann::json& interpolation = config["global"]["interpolation"];
+        if (!output.empty()) {
+            interpolation["path_to_tables"] = output;
+            interpolation["path_to_tables_readonly"] = output;
+        }
+        if (table_pack) {
+            interpolation["do_table_pack"] = true;
+            interpolation["do_binary_tables"] = true;
+        }
+        interpolation["number_of_threads"] = n_threads;
+        interpolation["just_use_readonly_path"] = false;
+
+        std::string path;
+        try {
+            path = InterpolationDef(interpolation).path_to_tables;
+        } catch (const std::invalid_argument& e) {
+            std::cerr << config_file << ": " << e.what() << std::endl;
+            return 1;
+        }
+        if (path.empty()) {
+            std::cerr << config_file << " has no table directory, use --output" << std::endl;
+            return 1;
+        }
+
+        for (const ParticleDef* particle_def : particle_defs) {
+            Job job = { config_file, config, particle_def, path, 0 };
+            jobs.push_back(job);
+        }
+    }
+
+    // The schedulers of the propagators share the threads of this one
+    TableScheduler scheduler(n_threads);
+    for (Job& job : jobs) {
+        scheduler.Add([&job]() {
+            auto start = std::chrono::steady_clock::now();
+            Propagator propagator(*job.particle_def, job.config);
+            job.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    try {
+        scheduler.Run();
+    } catch (const std::exception& e) {
+        std::cerr << "Unable to build the tables: " << e.what() << std::endl;
+        return 1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << std::fixed << std::setprecision(2);
+    for (const Job& job : jobs) {
+        std::cout << std::setw(10) << job.seconds << " s  " << job.particle_def->name << "  " << job.config_file << std::endl;
+    }
+    std::cout << std::setw(10) << seconds << " s  total on " << scheduler.GetNumberOfThreads() << " threads" << std::endl
+              << std::endl;
+
+    std::set<std::string> paths;
+    for (const Job& job : jobs) {
+        if (paths.insert(job.path).second)
+            PrintTables(job.path, table_pack || job.config["global"]["interpolation"].value("do_table_pack", false));
+    }
+
+    return 0;
+}
@@ -0,0 +1,51 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "PROPOSAL/PROPOSAL.h"
+
+using namespace PROPOSAL;
+
+// Lists, merges and prunes the table packs written with do_table_pack
+int main(int argc, const char* argv[])
+{
+    std::string command = argc >= 3 ? argv[1] : "";
+    std::vector<std::string> arguments(argv + std::min(argc, 3), argv + argc);
+
+    if (command == "list")
+    {
+        std::shared_ptr<const TablePack> pack = TablePack::Open(argv[2]);
+        if (!pack)
+        {
+            std::cerr << argv[2] << " is no table pack" << std::endl;
+            return 1;
+        }
+
+        for (const std::string& key : pack->GetKeys())
+        {
+            std::cout << key << (pack->Find(key) ? "" : "\tcorrupt") << std::endl;
+        }
+        std::cout << pack->GetKeys().size() << " tables, " << pack->GetSize() << " bytes" << std::endl;
+        return 0;
+    }
+
+    if (command == "merge" && !arguments.empty())
+    {
+        return TablePack::Merge(argv[2], arguments) ? 0 : 1;
+    }
+
+    if (command == "prune")
+    {
+        return TablePack::Prune(argv[2], arguments) ? 0 : 1;
+    }
+
+    std::cerr << "usage: " << argv[0] << " list <pack>" << std::endl
+              << "       " << argv[0] << " merge <pack> <input pack>..." << std::endl
+              << "       " << argv[0] << " prune <pack> [<key prefix>...]" << std::endl
+              << std::endl
+              << "merge appends the tables of the input packs, which are not in the pack." << std::endl
+              << "prune rewrites the pack without the tables whose keys start with one of" << std::endl
+              << "the prefixes, e.g. dNdx_, and without an incomplete table at its end." << std::endl;
+    return 1;
+}
@@ -36,6 +36,7 @@
 #include "PROPOSAL/geometry/Box.h"
 #include "PROPOSAL/geometry/Cylinder.h"
 #include "PROPOSAL/geometry/GeometryFactory.h"
+#include "PROPOSAL/geometry/GeometryIndex.h"
 #include "PROPOSAL/geometry/Sphere.h"
 
 #include "PROPOSAL/crossection/factories/AnnihilationFactory.h"
@@ -98,13 +99,19 @@
 #include "PROPOSAL/medium/density_distr/density_polynomial.h"
 #include "PROPOSAL/medium/density_distr/density_splines.h"
 
+#include "PROPOSAL/math/AliasTable.h"
 #include "PROPOSAL/math/Function.h"
+#include "PROPOSAL/math/FusedInterpolant.h"
 #include "PROPOSAL/math/Integral.h"
 #include "PROPOSAL/math/Interpolant.h"
 #include "PROPOSAL/math/InterpolantBuilder.h"
 #include "PROPOSAL/math/MathMethods.h"
+#include "PROPOSAL/math/QuantileTable.h"
 #include "PROPOSAL/math/RandomGenerator.h"
 #include "PROPOSAL/math/Spline.h"
+#include "PROPOSAL/math/TableFile.h"
+#include "PROPOSAL/math/TablePack.h"
+#include "PROPOSAL/math/TableScheduler.h"
 #include "PROPOSAL/math/TableWriter.h"
 #include "PROPOSAL/math/Vector3D.h"
 
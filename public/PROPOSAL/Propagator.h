@@ -46,12 +46,16 @@
  */
 
 // #include <deque>
+#include <cstdint>
 #include <vector>
 
 #include "PROPOSAL/Sector.h"
+#include "PROPOSAL/geometry/GeometryIndex.h"
 
 namespace PROPOSAL {
 
+class RandomStream;
+
 class Propagator
 {
 public:
@@ -60,6 +64,8 @@ public:
     Propagator(const ParticleDef&, const std::vector<Sector::Definition>&, std::shared_ptr<const Geometry>);
     Propagator(const ParticleDef&, const std::vector<Sector::Definition>&, std::shared_ptr<const Geometry>, const InterpolationDef&);
     Propagator(const ParticleDef&, const std::string&);
+    Propagator(const ParticleDef&, const char*); // a literal is a file name, not a json string
+    Propagator(const ParticleDef&, const nlohmann::json&);
 
     Propagator(const Propagator&);
     ~Propagator();
@@ -77,10 +83,104 @@ public:
     Secondaries Propagate(const DynamicData& particle_condition,
         double max_distance=1e20, double minimal_energy=0.);
 
+    // ----------------------------------------------------------------------------
+    /// @brief Propagates the particle with its own random stream
+    ///
+    /// All random numbers of this propagation are drawn from the given
+    /// stream, which is attached to the calling thread meanwhile. With a
+    /// stream keyed by (seed, event id) the result only depends on the event
+    /// and not on the thread or on previously propagated particles.
+    ///
+    /// @param random_stream
+    /// @param MaxDistance_cm
+    ///
+    /// @return Secondary data
+    // ----------------------------------------------------------------------------
+    Secondaries Propagate(const DynamicData& particle_condition, RandomStream& random_stream,
+        double max_distance=1e20, double minimal_energy=0.);
+
+    // ----------------------------------------------------------------------------
+    /// @brief Propagates the particle and streams the losses into a sink
+    ///
+    /// The sink receives the losses in the same order as Propagate stores
+    /// them in the Secondaries, as well as the entry, exit and closest
+    /// approach points. The propagator itself buffers none of them.
+    ///
+    /// @param loss_sink
+    /// @param MaxDistance_cm
+    ///
+    /// @return final particle state
+    // ----------------------------------------------------------------------------
+    DynamicData Propagate(const DynamicData& particle_condition, LossSink& loss_sink,
+        double max_distance=1e20, double minimal_energy=0.);
+    DynamicData Propagate(const DynamicData& particle_condition,
+        const LossFunctionSink::Function& loss_function,
+        double max_distance=1e20, double minimal_energy=0.);
+
+    // ----------------------------------------------------------------------------
+    /// @brief Propagates a batch of particles on several threads
+    ///
+    /// Every worker thread propagates with its own copy of the sectors,
+    /// which share the interpolation tables with this propagator, so the
+    /// tables exist only once in memory. Each worker owns a contiguous range
+    /// of events and idle workers steal half of the remaining events of a
+    /// busy one. Event i is propagated with RandomStream(seed, first_event_id + i),
+    /// so the result does not depend on the number of threads or on the
+    /// scheduling.
+    ///
+    /// @param particle_conditions
+    /// @param n_threads: number of worker threads, 0 uses all hardware threads
+    /// @param seed
+    /// @param first_event_id: event id of the first particle of the batch
+    /// @param MaxDistance_cm
+    ///
+    /// @return Secondary data of every particle in input order
+    // ----------------------------------------------------------------------------
+    std::vector<Secondaries> PropagateBatch(const std::vector<DynamicData>& particle_conditions,
+        unsigned int n_threads=0, uint64_t seed=0, uint64_t first_event_id=0,
+        double max_distance=1e20, double minimal_energy=0.);
+
+    // ----------------------------------------------------------------------------
+    /// @brief Propagates a batch of particles together as one wavefront
+    ///
+    /// All particles are advanced sector step by sector step. The particles
+    /// inside the same sector are handed over to the sector at once, which
+    /// evaluates its tables for all of them in turn (see
+    /// Sector::Propagate(Wavefront&)). Event i is propagated with
+    /// RandomStream(seed, first_event_id + i), so the results are identical
+    /// to the ones of PropagateBatch.
+    ///
+    /// @param particle_conditions
+    /// @param seed
+    /// @param first_event_id: event id of the first particle of the batch
+    /// @param MaxDistance_cm
+    ///
+    /// @return Secondary data of every particle in input order
+    // ----------------------------------------------------------------------------
+    std::vector<Secondaries> PropagateWavefront(const std::vector<DynamicData>& particle_conditions,
+        uint64_t seed=0, uint64_t first_event_id=0,
+        double max_distance=1e20, double minimal_energy=0.);
+
     // --------------------------------------------------------------------- //
     // Getter
     // --------------------------------------------------------------------- //
 
+    // ----------------------------------------------------------------------------
+    /// @brief Trace straight tracks once through all sectors
+    ///
+    /// If enabled, the sectors, the detector entry and exit and the closest
+    /// approach along the initial direction are computed once at the start
+    /// of each track and the steps only look them up. As soon as the
+    /// direction of the particle changes, e.g. by scattering or a
+    /// stochastic deflection, the track falls back to the geometric lookup
+    /// at every step. Worth it for NoScattering and through-going tracks.
+    /// The segments of the plan end where the steps of the geometric lookup
+    /// end, so both draw the same random numbers and give the same losses
+    /// up to rounding.
+    // ----------------------------------------------------------------------------
+    void SetCrossingPlan(bool use_crossing_plan) { use_crossing_plan_ = use_crossing_plan; };
+    bool GetCrossingPlan() const { return use_crossing_plan_; };
+
     const Sector* GetCurrentSector() const { return current_sector_; }
     const std::vector<Sector*> GetSectors() const { return sectors_; }
 
@@ -93,8 +193,53 @@ public:
 
 private:
 
+    // ----------------------------------------------------------------------------
+    /// @brief State of a propagated particle between two sector steps
+    // ----------------------------------------------------------------------------
+    struct CrossingSegment {
+        Sector* sector;
+        double entry;     //!< distance along the track where the segment starts
+        double exit;      //!< distance along the track where the segment ends
+        bool in_detector;
+    };
+
+    struct Track {
+        Track(const DynamicData& initial_condition);
+
+        DynamicData condition;
+        Sector* sector;
+        double distance;
+        bool starts_in_detector;
+        bool was_in_detector;
+        bool propagationstep_till_closest_approach;
+        bool already_reached_closest_approach;
+
+        // straight line crossing plan, empty if the steps use the geometry
+        std::vector<CrossingSegment> crossing_plan;
+        size_t plan_segment;
+        double plan_start;            //!< propagated distance at the start of the plan
+        double plan_closest_approach; //!< distance along the track to the closest approach
+        Vector3D plan_direction;
+    };
+
     Propagator& operator=(const Propagator& propagator);
 
+    // ----------------------------------------------------------------------------
+    /// @brief Steps of Propagate shared by the scalar and the wavefront loop
+    ///
+    /// PrepareStep chooses the sector and the distance of the next step and
+    /// returns false if the particle has left all sectors. FinishStep is
+    /// called with the particle state at the end of the sector step and
+    /// returns true if the propagation is finished. PlanCrossings traces the
+    /// straight line from the current particle state through all sectors.
+    // ----------------------------------------------------------------------------
+    void PlanCrossings(Track&);
+    void StartTrack(Track&, LossSink&);
+    bool PrepareStep(Track&, LossSink&, double max_distance);
+    bool FinishStep(Track&, LossSink&, double max_distance, double minimal_energy);
+    void FinishTrack(Track&, LossSink&);
+    void UpdateProducedParticleMoments(const Secondaries&);
+
     // ----------------------------------------------------------------------------
     /// @brief Simple wrapper to initialize propagator from config file
     ///
@@ -134,9 +279,18 @@ private:
     // ----------------------------------------------------------------------------
     std::shared_ptr<const Geometry> ParseGeometryConfig(const std::string& json_object_str);
 
+    // ----------------------------------------------------------------------------
+    /// @brief Index the sector geometries grouped by the sector location
+    ///
+    /// Has to be called whenever the sectors are changed.
+    // ----------------------------------------------------------------------------
+    void InitSectorIndex();
+
     // ----------------------------------------------------------------------------
     /// @brief Choose the current sector the particle is in.
     ///
+    /// The candidates are looked up in the sector index.
+    ///
     /// @param particle_position
     /// @param particle_direction
     // ----------------------------------------------------------------------------
@@ -198,9 +352,12 @@ private:
 
     std::vector<Sector*> sectors_;
     Sector* current_sector_;
+    std::vector<int> crossed_sector_; //!< buffer reused by ChooseCurrentSector
+    GeometryIndex sector_index_;      //!< sector geometries grouped by location
 
     ParticleDef particle_def_;
     std::shared_ptr<const Geometry> detector_;
+    bool use_crossing_plan_ {false};
 
     std::pair<double,double> produced_particle_moments_ {100., 10000.};
     unsigned int n_th_call_ {1};
@@ -27,6 +27,7 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -39,25 +40,114 @@ namespace PROPOSAL {
 
 class Geometry;
 
-class Secondaries {
+// ----------------------------------------------------------------------------
+/// @brief Read only view on one column of the Secondaries
+///
+/// The view points into the memory of the Secondaries and is invalidated
+/// by every operation which adds particles to them.
+// ----------------------------------------------------------------------------
+template <typename T>
+class ColumnView {
+public:
+    ColumnView(const T* data, size_t size) : data_(data), size_(size) {}
+
+    const T& operator[](size_t idx) const { return data_[idx]; }
+    const T* data() const { return data_; }
+    size_t size() const { return size_; }
+    const T* begin() const { return data_; }
+    const T* end() const { return data_ + size_; }
+
+private:
+    const T* data_;
+    size_t size_;
+};
+
+// ----------------------------------------------------------------------------
+/// @brief Receiver of the losses produced while propagating
+///
+/// The propagation hands over every loss, in the order it is produced, as
+/// soon as it is sampled. Nothing is buffered in between, so a sink which
+/// writes the losses to its own output needs constant memory per track.
+/// Secondaries is the sink collecting all losses.
+// ----------------------------------------------------------------------------
+class LossSink {
+public:
+    virtual ~LossSink() {};
 
+    virtual void push_back(const DynamicData& loss) = 0;
+
+    virtual void SetEntryPoint(const DynamicData&) {};
+    virtual void SetExitPoint(const DynamicData&) {};
+    virtual void SetClosestApproachPoint(const DynamicData&) {};
+};
+
+// ----------------------------------------------------------------------------
+/// @brief LossSink calling a function for every loss
+///
+/// The sink keeps its own copy of the function, so it may be created from
+/// a temporary, e.g. a lambda.
+// ----------------------------------------------------------------------------
+class LossFunctionSink : public LossSink {
 public:
+    typedef std::function<void(const DynamicData&)> Function;
+
+    LossFunctionSink(const Function& function) : function_(function) {};
+
+    void push_back(const DynamicData& loss) override { function_(loss); };
+
+private:
+    Function function_;
+};
+
+// ----------------------------------------------------------------------------
+/// @brief Particles produced while propagating, stored column by column
+///
+/// All floating point columns live in one arena, so adding a particle
+/// only writes into it and the arena grows geometrically. clear() keeps
+/// the arena, so reused Secondaries do not allocate at all. Only the
+/// cartesian coordinates of the positions are stored, the directions are
+/// stored completely, since the scattering needs their spherical
+/// coordinates.
+// ----------------------------------------------------------------------------
+class Secondaries : public LossSink {
+
+public:
+    enum Column {
+        X = 0,
+        Y,
+        Z,
+        DirectionX,
+        DirectionY,
+        DirectionZ,
+        DirectionRadius,
+        DirectionAzimuth,
+        DirectionZenith,
+        Energy,
+        ParentParticleEnergy,
+        Time,
+        PropagatedDistance,
+        NumberOfColumns
+    };
+
     Secondaries();
     Secondaries(std::shared_ptr<ParticleDef>);
 
     void reserve(size_t number_secondaries);
-    void clear() { secondaries_.clear(); };
+    void clear() { size_ = 0; };
 
-    DynamicData& operator[](std::size_t idx) { return secondaries_[idx]; };
+    DynamicData operator[](std::size_t idx) const;
+    DynamicData back() const { return (*this)[size_ - 1]; };
+    void Set(std::size_t idx, const DynamicData& particle);
 
-    void push_back(const DynamicData& continuous_loss);
+    void push_back(const DynamicData& continuous_loss) override;
+    void push_back(const Secondaries& secondaries, std::size_t idx);
     void emplace_back(const int& type);
     void emplace_back(const int& type, const Vector3D& position,
         const Vector3D& direction, const double& energy,
         const double& parent_particle_energy, const double& time,
         const double& distance);
 
-    void append(Secondaries& secondaries);
+    void append(const Secondaries& secondaries);
 
     Secondaries Query(const int&) const;
     Secondaries Query(const std::string&) const;
@@ -65,18 +155,21 @@ public:
 
     void DoDecay();
 
+    // zero copy access to the columns
+    ColumnView<int> GetTypeColumn() const { return ColumnView<int>(type_.data(), size_); };
+    ColumnView<double> GetColumn(Column column) const
+    {
+        return ColumnView<double>(arena_.data() + column * capacity_, size_);
+    };
+
     std::vector<Vector3D> GetPosition() const;
     std::vector<Vector3D> GetDirection() const;
     std::vector<double> GetEnergy() const;
     std::vector<double> GetParentParticleEnergy() const;
     std::vector<double> GetTime() const;
     std::vector<double> GetPropagatedDistance() const;
-    std::vector<DynamicData> GetSecondaries() const { return secondaries_; };
-    std::vector<DynamicData>& GetModifyableSecondaries()
-    {
-        return secondaries_;
-    };
-    unsigned int GetNumberOfParticles() const { return secondaries_.size(); };
+    std::vector<DynamicData> GetSecondaries() const;
+    unsigned int GetNumberOfParticles() const { return size_; };
     Secondaries GetOnlyLostInsideDetector() const;
 
     // TODO: Prelimary, see note below
@@ -84,12 +177,22 @@ public:
     DynamicData GetEntryPoint() const;
     DynamicData GetExitPoint() const;
     DynamicData GetClosestApproachPoint() const;
-    void SetEntryPoint(const DynamicData& entry_point);
-    void SetExitPoint(const DynamicData& exit_point);
-    void SetClosestApproachPoint(const DynamicData& closest_approach_point);
+    void SetEntryPoint(const DynamicData& entry_point) override;
+    void SetExitPoint(const DynamicData& exit_point) override;
+    void SetClosestApproachPoint(const DynamicData& closest_approach_point) override;
+
+private:
+    double* column(Column column) { return arena_.data() + column * capacity_; };
+    const double* column(Column column) const { return arena_.data() + column * capacity_; };
+    void Grow(size_t capacity);
+    void append(const Secondaries& secondaries, size_t begin, size_t end);
+    std::vector<double> GetColumnCopy(Column) const;
+
+    size_t size_;
+    size_t capacity_;
+    std::vector<int> type_;
+    std::vector<double> arena_; //!< NumberOfColumns columns of capacity_ entries each
 
-// private:
-    std::vector<DynamicData> secondaries_;
     std::shared_ptr<ParticleDef> primary_def_;
 
     // TODO: Entry and Exit point must not necessary be saved.
@@ -43,6 +43,9 @@
 namespace PROPOSAL {
 
 class ContinuousRandomizer;
+class FusedInterpolant;
+class FusedInterpolantCache;
+class RandomStream;
 // class CrossSection;
 // class Medium;
 // class EnergyCutSettings;
@@ -110,6 +113,35 @@ public:
         std::shared_ptr<const Geometry> geometry_;
     };
 
+    // ----------------------------------------------------------------------------
+    /// @brief States of particles propagated together through a sector
+    ///
+    /// Every quantity is stored in its own array (structure of arrays), the
+    /// particle i is described by the i-th entry of all arrays. Each particle
+    /// draws its random numbers from its own stream and hands its losses to
+    /// its own LossSink.
+    // ----------------------------------------------------------------------------
+    struct Wavefront {
+        void push_back(const DynamicData& particle_condition, double border_distance,
+            RandomStream& random_stream, LossSink& loss_sink);
+        void clear();
+        void reserve(size_t size);
+        size_t size() const { return energy.size(); }
+        DynamicData GetParticleCondition(size_t idx) const;
+
+        std::vector<int> type;
+        std::vector<Vector3D> position;
+        std::vector<Vector3D> direction;
+        std::vector<double> energy;
+        std::vector<double> parent_particle_energy;
+        std::vector<double> time;
+        std::vector<double> propagated_distance;
+        std::vector<double> border_distance;
+        std::vector<double> displacement;
+        std::vector<RandomStream*> random_stream;
+        std::vector<LossSink*> loss_sink;
+    };
+
 public:
     Sector(const ParticleDef&, const Definition&);
     Sector(const ParticleDef&, const Definition&, const InterpolationDef&);
@@ -142,6 +174,8 @@ public:
     // Utilites
     double CalculateTime(const DynamicData& p_condition,
         const double final_energy, const double displacement);
+    double CalculateTime(const double time, const double initial_energy,
+        const Vector3D& position, const double final_energy, const double displacement);
     void Scatter(const double displacement, const double initial_energy,
         const double final_energy, Vector3D& position, Vector3D& direction);
     double ContinuousRandomize(
@@ -158,15 +192,38 @@ public:
     int maximizeEnergy(const std::array<double, 4>& LossEnergies);
 
 
-    std::shared_ptr<DynamicData> DoInteraction(const DynamicData&);
-    std::shared_ptr<DynamicData> DoDecay(const DynamicData&);
-    std::shared_ptr<DynamicData> DoContinuous(
-        const DynamicData&, double, double);
+    // The Do methods update the particle state in place, so the step loop
+    // works on a single DynamicData and does not allocate.
+    void DoInteraction(DynamicData&);
+    void DoDecay(DynamicData&);
+    void DoContinuous(DynamicData&, double, double);
     /* std::shared_ptr<DynamicData> DoBorder(const DynamicData& ); */
 
     Secondaries Propagate(const DynamicData& particle_condition,
         double max_distance=1e20, double minimal_energy=0.);
 
+    // ----------------------------------------------------------------------------
+    /// @brief Propagates the particle and streams the losses into the sink
+    ///
+    /// The sink receives the same sequence of losses which Propagate
+    /// returns as Secondaries, ending with the final particle state.
+    ///
+    /// @return final particle state
+    // ----------------------------------------------------------------------------
+    DynamicData Propagate(const DynamicData& particle_condition,
+        double max_distance, double minimal_energy, LossSink& loss_sink);
+
+    // ----------------------------------------------------------------------------
+    /// @brief Propagates all particles of the wavefront through the sector
+    ///
+    /// All particles are advanced one step at a time. Each step evaluates
+    /// one table after the other for all particles which are still inside
+    /// the sector, finished particles are compacted away after every step.
+    /// The losses of each particle are handed to its LossSink exactly as the
+    /// scalar Propagate would produce them with the same random stream. Afterwards the wavefront holds the final particle states.
+    // ----------------------------------------------------------------------------
+    void Propagate(Wavefront& wavefront, double minimal_energy=0.);
+
     /**
      *  Makes Stochastic Energyloss
      *
@@ -197,6 +254,10 @@ public:
 protected:
     Sector& operator=(const Sector&); // Undefined & not allowed
 
+    // Lets the tracking calculators evaluate their tables through one fused
+    // table. Without a table, a new one is built from their own tables.
+    void InitFusedTables(std::shared_ptr<const FusedInterpolant> table);
+
     // --------------------------------------------------------------------- //
     // Protected members
     // --------------------------------------------------------------------- //
@@ -204,12 +265,14 @@ protected:
     Definition sector_def_;
 
     ParticleDef particle_def_;
+    std::shared_ptr<ParticleDef> secondaries_particle_def_; //!< shared by the returned Secondaries
 
     Utility utility_;
     std::shared_ptr<UtilityDecorator> displacement_calculator_;
     std::shared_ptr<UtilityDecorator> interaction_calculator_;
     std::shared_ptr<UtilityDecorator> decay_calculator_;
     std::shared_ptr<UtilityDecorator> exact_time_calculator_;
+    std::shared_ptr<FusedInterpolantCache> fused_tables_; //!< own cache of the shared fused table, interpolation only
 
     std::shared_ptr<ContinuousRandomizer> cont_rand_;
     std::shared_ptr<Scattering> scattering_;
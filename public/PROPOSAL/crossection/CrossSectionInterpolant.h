@@ -29,6 +29,10 @@
 
 #pragma once
 
+#include <functional>
+#include <map>
+#include <memory>
+
 #include "PROPOSAL/crossection/CrossSection.h"
 #include "PROPOSAL/methods.h"
 
@@ -36,6 +40,7 @@ namespace PROPOSAL {
 
 class Integral;
 class Interpolant;
+class QuantileTable;
 
 class CrossSectionInterpolant : public CrossSection
 {
@@ -52,23 +57,122 @@ public:
     virtual double CalculatedNdx(double energy, double rnd);
     virtual double CalculateStochasticLoss(double energy, double rnd1, double rnd2);
 
+    // ----------------------------------------------------------------------------
+    /// @brief Number of dNdx tables, one per medium component for most
+    /// cross sections
+    // ----------------------------------------------------------------------------
+    virtual unsigned int GetNumberOfComponentTables() const { return dndx_interpolant_1d_.size(); }
+
+    // ----------------------------------------------------------------------------
+    /// @brief Contribution of one dNdx table to CalculatedNdx(energy)
+    // ----------------------------------------------------------------------------
+    double CalculatedNdxOfComponent(double energy, int component) const;
+
+    // ----------------------------------------------------------------------------
+    /// @brief Stochastic loss on a dNdx table chosen by the caller
+    ///
+    /// Skips the choice of the medium component, e.g. if the Utility has
+    /// already chosen the cross section and the component in one step. rnd
+    /// samples the loss.
+    // ----------------------------------------------------------------------------
+    double CalculateStochasticLossOfComponent(double energy, double rnd, int component);
+
     // Needed to initialize interpolation
     virtual double FunctionToBuildDNdxInterpolant(double energy, int component);
     virtual double FunctionToBuildDNdxInterpolant2D(double energy, double v, Integral&, int component);
+    double FunctionToBuildDNdxQuantile(double energy, double rnd, int component);
+    double FunctionToValidateDNdxQuantile(double energy, double v, int component);
     virtual double CalculateCumulativeCrossSection(double energy, int component, double v);
 
 protected:
     virtual bool compare(const CrossSection&) const;
 
-    typedef std::vector<Interpolant*> InterpolantVec;
+    typedef std::vector<std::shared_ptr<const Interpolant> > InterpolantVec;
 
     virtual double CalculateStochasticLoss(double energy, double rnd1);
     virtual void InitdNdxInterpolation(const InterpolationDef& def);
 
-    Interpolant* dedx_interpolant_;
-    Interpolant* de2dx_interpolant_;
+    // ----------------------------------------------------------------------------
+    /// @brief Integral of dNdx from v_min to v for the 2d dNdx table
+    ///
+    /// The 2d builder fills the table row by row, so the nodes of one energy
+    /// are reached with increasing v. The integral of the last node at this
+    /// energy is reused and only the part up to v is integrated by
+    /// integrate(v_low, v_high), which makes the v direction a single
+    /// cumulative pass.
+    // ----------------------------------------------------------------------------
+    double IntegratedNdxCumulative(double energy,
+                                   double v_min,
+                                   double v,
+                                   int component,
+                                   const std::function<double(double, double)>& integrate);
+
+    // ----------------------------------------------------------------------------
+    /// @brief Integral to build the 2d dNdx table of a component
+    ///
+    /// The 2d table is integrated cumulative between neighbouring nodes.
+    /// These short pieces converge with a lower order of the Romberg
+    /// integration.
+    // ----------------------------------------------------------------------------
+    static Integral CreatedNdxIntegral();
+
+    // ----------------------------------------------------------------------------
+    /// @brief Reads or builds the dNdx tables and their quantile tables
+    ///
+    /// Calls Helper::InitializeInterpolation for the dNdx builders with the
+    /// given dependencies and drops the partial integrals of the cumulative
+    /// integration afterwards. The quantile tables start at energy_min.
+    // ----------------------------------------------------------------------------
+    void InitdNdxTables(const InterpolationDef& def,
+                        Helper::InterpolantBuilderContainer& builder_container,
+                        const std::vector<std::vector<unsigned int> >& dependencies,
+                        double energy_min);
+
+    // ----------------------------------------------------------------------------
+    /// @brief Cross sections to evaluate the 2d dNdx table of each component
+    ///
+    /// The parametrization keeps the current component, so the tables of
+    /// the components can only be built at the same time on copies. If the
+    /// tables are built on a single thread, this is used for all components.
+    /// The copies are owned by copies.
+    // ----------------------------------------------------------------------------
+    std::vector<CrossSectionInterpolant*> GetdNdxBuilders(const InterpolationDef& def,
+                                                          std::vector<std::unique_ptr<CrossSection> >& copies);
+
+    // ----------------------------------------------------------------------------
+    /// @brief Dependencies of the dNdx tables for Helper::InitializeInterpolation
+    ///
+    /// The 2d tables come first and are independent, the 1d table of each
+    /// component is read from its 2d table.
+    // ----------------------------------------------------------------------------
+    std::vector<std::vector<unsigned int> > GetdNdxDependencies() const;
+
+    // ----------------------------------------------------------------------------
+    /// @brief Builds the quantile tables of the dNdx interpolation
+    ///
+    /// The tables are derived from the already initialized 2d dNdx tables,
+    /// which start at energy_min.
+    // ----------------------------------------------------------------------------
+    void InitdNdxQuantileInterpolation(const InterpolationDef& def, double energy_min);
+
+    // ----------------------------------------------------------------------------
+    /// @brief Position on the second axis of the 2d dNdx table, where the
+    /// cumulative rate of the component reaches rnd * rate
+    ///
+    /// rate has to be the total rate of the component at this energy. Above
+    /// the threshold the quantile table is used, otherwise FindLimit.
+    // ----------------------------------------------------------------------------
+    double FindLimitdNdx(double energy, double rnd, double rate, int component) const;
+
+    std::shared_ptr<const Interpolant> dedx_interpolant_;
+    std::shared_ptr<const Interpolant> de2dx_interpolant_;
     InterpolantVec dndx_interpolant_1d_; // Stochastic dNdx()
     InterpolantVec dndx_interpolant_2d_; // Stochastic dNdx()
+    std::vector<std::shared_ptr<const QuantileTable> > dndx_quantile_; // Inverse of dndx_interpolant_2d_
+    std::vector<double> quantile_energy_min_;
+
+    // Last v and integral for each energy node, only used while building
+    std::vector<std::map<double, std::pair<double, double> > > dndx_partial_integrals_;
 };
 
 } // namespace PROPOSAL
@@ -52,6 +52,10 @@ public:
     virtual double CalculatedNdx(double energy);
     virtual double CalculatedNdx(double energy, double rnd);
 
+    // The rate does not depend on the medium component, only the first
+    // table is used
+    unsigned int GetNumberOfComponentTables() const { return 1; }
+
     // Needed to initialize interpolation
     double FunctionToBuildDNdxInterpolant(double energy, int component);
     virtual double FunctionToBuildDNdxInterpolant2D(double energy, double v, Integral&, int component);
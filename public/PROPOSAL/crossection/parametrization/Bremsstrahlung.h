@@ -143,7 +143,7 @@ private:
     virtual bool compare(const Parametrization&) const;
 
     static const std::string name_;
-    Interpolant* interpolant_;
+    std::shared_ptr<const Interpolant> interpolant_;
 };
 
 #undef BREMSSTRAHLUNG_DEF
@@ -170,7 +170,7 @@ template<class Param = EpairKelnerKokoulinPetrukhin>
 class EpairProductionRhoInterpolant : public Param
 {
 public:
-    typedef std::vector<Interpolant*> InterpolantVec;
+    typedef std::vector<std::shared_ptr<const Interpolant> > InterpolantVec;
 
 public:
     EpairProductionRhoInterpolant(const ParticleDef&,
@@ -210,7 +210,7 @@ EpairProductionRhoInterpolant<Param>::EpairProductionRhoInterpolant(const Partic
                                               bool lpm,
                                               InterpolationDef def)
     : Param(particle_def, medium, cuts, multiplier, lpm)
-    , interpolant_(this->medium_->GetNumComponents(), NULL)
+    , interpolant_(this->medium_->GetNumComponents())
 {
     std::vector<Interpolant2DBuilder> builder2d(this->components_.size());
     Helper::InterpolantBuilderContainer builder_container2d(this->components_.size());
@@ -248,25 +248,13 @@ EpairProductionRhoInterpolant<Param>::EpairProductionRhoInterpolant(const Partic
 template<class Param>
 EpairProductionRhoInterpolant<Param>::EpairProductionRhoInterpolant(const EpairProductionRhoInterpolant& photo)
     : Param(photo)
-    , interpolant_()
+    , interpolant_(photo.interpolant_)
 {
-    interpolant_.resize(photo.interpolant_.size());
-
-    for (unsigned int i = 0; i < photo.interpolant_.size(); ++i)
-    {
-        interpolant_[i] = new Interpolant(*photo.interpolant_[i]);
-    }
 }
 
 template<class Param>
 EpairProductionRhoInterpolant<Param>::~EpairProductionRhoInterpolant()
 {
-    for (std::vector<Interpolant*>::const_iterator iter = interpolant_.begin(); iter != interpolant_.end(); ++iter)
-    {
-        delete *iter;
-    }
-
-    interpolant_.clear();
 }
 
 template<class Param>
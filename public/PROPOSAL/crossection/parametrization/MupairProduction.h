@@ -149,7 +149,7 @@ template<class Param = MupairKelnerKokoulinPetrukhin>
 class MupairProductionRhoInterpolant : public Param
 {
 public:
-    typedef std::vector<Interpolant*> InterpolantVec;
+    typedef std::vector<std::shared_ptr<const Interpolant> > InterpolantVec;
 
 public:
     MupairProductionRhoInterpolant(const ParticleDef&,
@@ -189,7 +189,7 @@ MupairProductionRhoInterpolant<Param>::MupairProductionRhoInterpolant(const Part
                                               bool particle_output,
                                               InterpolationDef def)
     : Param(particle_def, medium, cuts, multiplier, particle_output)
-    , interpolant_(this->medium_->GetNumComponents(), NULL)
+    , interpolant_(this->medium_->GetNumComponents())
 {
     std::vector<Interpolant2DBuilder> builder2d(this->components_.size());
     Helper::InterpolantBuilderContainer builder_container2d(this->components_.size());
@@ -227,25 +227,13 @@ MupairProductionRhoInterpolant<Param>::MupairProductionRhoInterpolant(const Part
 template<class Param>
 MupairProductionRhoInterpolant<Param>::MupairProductionRhoInterpolant(const MupairProductionRhoInterpolant& photo)
     : Param(photo)
-    , interpolant_()
+    , interpolant_(photo.interpolant_)
 {
-    interpolant_.resize(photo.interpolant_.size());
-
-    for (unsigned int i = 0; i < photo.interpolant_.size(); ++i)
-    {
-        interpolant_[i] = new Interpolant(*photo.interpolant_[i]);
-    }
 }
 
 template<class Param>
 MupairProductionRhoInterpolant<Param>::~MupairProductionRhoInterpolant()
 {
-    for (std::vector<Interpolant*>::const_iterator iter = interpolant_.begin(); iter != interpolant_.end(); ++iter)
-    {
-        delete *iter;
-    }
-
-    interpolant_.clear();
 }
 
 template<class Param>
@@ -139,7 +139,7 @@ private:
     double MeasuredSgN(double e);
 
     static const std::string name_;
-    Interpolant* interpolant_;
+    std::shared_ptr<const Interpolant> interpolant_;
 };
 
 #undef Q2_PHOTO_PARAM_INTEGRAL_DEC
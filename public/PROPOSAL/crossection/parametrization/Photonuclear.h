@@ -95,7 +95,7 @@ private:
     virtual bool compare(const RealPhoton&) const;
 
     static std::vector<double> x;
-    std::vector<Interpolant*> interpolant_;
+    std::vector<std::shared_ptr<const Interpolant> > interpolant_;
 
     static const std::string name_;
 };
@@ -132,6 +132,16 @@ public:
     // ----------------------------------------------------------------------------
     virtual void SetUniformSampling(bool uniform) {(void) uniform;};
 
+    // ----------------------------------------------------------------------------
+    /// @brief Precompute the sampling tables for decays of the given parent
+    ///
+    /// Called by the decay table on the first decay of its parent particle.
+    /// Decays of other parents are still sampled, but without the tables.
+    ///
+    /// @param parent
+    // ----------------------------------------------------------------------------
+    virtual void BuildTables(const ParticleDef& parent) {(void) parent;};
+
     virtual const std::string& GetName() const = 0;
 
 protected:
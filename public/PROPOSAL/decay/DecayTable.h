@@ -30,6 +30,8 @@
 #pragma once
 
 #include <map>
+#include <memory>
+#include <mutex>
 #include <ostream>
 #include <vector>
 
@@ -37,6 +39,7 @@ namespace PROPOSAL {
 
 class DecayChannel;
 class DecayTable;
+struct ParticleDef;
 
 void swap(DecayTable&, DecayTable&);
 
@@ -60,8 +63,11 @@ public:
     // ----------------------------------------------------------------------------
     /// @brief Get a decay channel
     ///
-    /// The Decay channels will be sampled from the previous given branching ratios
+    /// The Decay channels will be sampled from the previous given branching ratios.
+    /// The channel is looked up in an alias table built when the channels are
+    /// added, so the selection takes constant time for any number of channels.
     ///
+    /// @param rnd uniform random number in [0, 1)
     /// @return Sampled Decay channel
     // ----------------------------------------------------------------------------
     DecayChannel& SelectChannel(double rnd) const;
@@ -98,10 +104,33 @@ public:
     // ----------------------------------------------------------------------------
     void SetUniformSampling(bool uniform) const;
 
+    // ----------------------------------------------------------------------------
+    /// @brief Precomputes the sampling tables of the decay channels
+    ///
+    /// The tables depend on the mass of the parent particle. They are built
+    /// once, on the first decay of the parent, so the static ParticleDefs do
+    /// not build them during the static initialization. Further calls do
+    /// nothing until the channels are changed.
+    ///
+    /// @param parent
+    // ----------------------------------------------------------------------------
+    void BuildTables(const ParticleDef& parent) const;
+
 private:
     void clearTable();
+    void BuildAliasTable();
 
     DecayMap channels_;
+
+    // Walker's alias table of the channels, a bin i holds channel
+    // alias_channels_[i] with probability alias_probabilities_[i] and
+    // alias_channels_[alias_indices_[i]] otherwise
+    std::vector<DecayChannel*> alias_channels_;
+    std::vector<double> alias_probabilities_;
+    std::vector<size_t> alias_indices_;
+
+    // Set once the sampling tables of the channels are built
+    std::shared_ptr<std::once_flag> tables_built_;
 };
 
 std::ostream& operator<<(std::ostream&, PROPOSAL::DecayTable const&);
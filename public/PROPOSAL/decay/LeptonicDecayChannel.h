@@ -28,12 +28,15 @@
 
 #pragma once
 
+#include <memory>
+
 #include "PROPOSAL/decay/DecayChannel.h"
 #include "PROPOSAL/particle/ParticleDef.h"
 
 namespace PROPOSAL {
 
 class Particle;
+class QuantileTable;
 
 class LeptonicDecayChannelApprox : public DecayChannel
 {
@@ -46,14 +49,29 @@ public:
 
     Secondaries Decay(const ParticleDef&, const DynamicData&);
 
+    // ----------------------------------------------------------------------------
+    /// @brief Tabulates the quantile function of the lepton energy
+    ///
+    /// Afterwards, the lepton energy of decays of this parent is looked up
+    /// instead of solving the decay rate for it.
+    // ----------------------------------------------------------------------------
+    void BuildTables(const ParticleDef& parent);
+
     const std::string& GetName() const { return name_; }
 
+    // Probability accuracy of the lepton energy table
+    static const double energy_table_accuracy_;
+
 protected:
     ParticleDef massive_lepton_;
     ParticleDef neutrino_;
     ParticleDef anti_neutrino_;
     static const std::string name_;
 
+    // Quantile function of x = E / E_max for decays of a parent of the given mass
+    std::shared_ptr<const QuantileTable> energy_table_;
+    double energy_table_parent_mass_;
+
     LeptonicDecayChannelApprox& operator=(const LeptonicDecayChannelApprox&); // Undefined & not allowed
 
     bool compare(const DecayChannel&) const;
@@ -69,7 +87,7 @@ protected:
     // ----------------------------------------------------------------------------
     virtual double DifferentialDecayRate(double x, double parent_mass, double E_max);
 
-    double FindRoot(double min, double parent_mass, double E_max, double right_side);
+    double FindRoot(double min, double parent_mass, double E_max, double right_side, int max_steps = 40, double accuracy = 1e-3);
 };
 
 class LeptonicDecayChannel : public LeptonicDecayChannelApprox
@@ -29,8 +29,13 @@
 
 #pragma once
 
-#include <unordered_map>
+#include <atomic>
 #include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
 
 #include "PROPOSAL/decay/DecayChannel.h"
 #include "PROPOSAL/particle/ParticleDef.h"
@@ -51,12 +56,14 @@ public:
 
     struct PhaseSpaceKinematics
     {
+        std::vector<double> randoms; // sorted random numbers of the virtual masses
         std::vector<double> virtual_masses;
         std::vector<double> momenta;
         double weight;
     };
 
-    typedef std::unordered_map<ParticleDef, PhaseSpaceParameters> ParameterMap;
+    // The parameters depend on the parent only through its type and mass
+    typedef std::map<std::pair<int, double>, PhaseSpaceParameters> ParameterMap;
     typedef std::function<double(const DynamicData&, const std::vector<DynamicData>&)> MatrixElementFunction;
     typedef std::function<void(PhaseSpaceParameters&, const ParticleDef&)> EstimateFunction;
 
@@ -79,6 +86,14 @@ public:
     // ----------------------------------------------------------------------------
     Secondaries Decay(const ParticleDef& p_def, const DynamicData& p_condition);
 
+    // ----------------------------------------------------------------------------
+    /// @brief Estimates the normalization and maximum weight for the parent
+    ///
+    /// The parameters are shared by all copies of this channel, so the
+    /// estimate runs only once per parent.
+    // ----------------------------------------------------------------------------
+    void BuildTables(const ParticleDef& parent);
+
     // ----------------------------------------------------------------------------
     /// @brief Evalutate the matrix element of this channel
     ///
@@ -167,7 +182,8 @@ private:
     /// @param parent
     ///
     /// For every particle definition the normalization and maximum weight is unique.
-    /// Both values will be created and stored in an hash table.
+    /// Both values will be created and stored in a map shared by all copies
+    /// of the channel.
     ///
     /// @return struct containing the normalization and maximum weight
     // ----------------------------------------------------------------------------
@@ -177,13 +193,13 @@ private:
     // ----------------------------------------------------------------------------
     /// @brief Calculate the kinematics for the use in the raubold lynch algorithm
     ///
+    /// @param kinematics struct to fill with the weight of the phase space point,
+    ///        intermediate momenta and virtual masses for the algorithm. Its
+    ///        vectors are reused, so candidates do not allocate.
     /// @param normalization
     /// @param parent_mass
-    ///
-    /// @return struct containing the weight of the phase space point,
-    ///         intermediate momenta and virtual masses for the algorithm.
     // ----------------------------------------------------------------------------
-    PhaseSpaceKinematics CalculateKinematics(double normalization, double parent_mass);
+    void CalculateKinematics(PhaseSpaceKinematics& kinematics, double normalization, double parent_mass);
 
     bool compare(const DecayChannel&) const;
     void print(std::ostream&) const;
@@ -202,7 +218,20 @@ private:
 
     static const std::string name_;
 
-    ParameterMap parameter_map_;
+    // The parameters are looked up without a lock in the latest snapshot.
+    // A missing parent is added under the mutex to a copy, which replaces the
+    // snapshot. The cache keeps all snapshots, so a snapshot stays valid while
+    // other threads read it, and there is one snapshot per parent only.
+    struct ParameterCache
+    {
+        ParameterCache() : parameters(NULL) {}
+
+        std::mutex mutex;
+        std::atomic<const ParameterMap*> parameters;
+        std::vector<std::unique_ptr<const ParameterMap> > snapshots;
+    };
+
+    std::shared_ptr<ParameterCache> parameter_cache_;
 };
 
 class ManyBodyPhaseSpace::Builder
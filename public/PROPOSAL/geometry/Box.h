@@ -53,6 +53,7 @@ public:
 
     // Methods
     std::pair<double, double> DistanceToBorder(const Vector3D& position, const Vector3D& direction) const override;
+    std::pair<Vector3D, Vector3D> GetBoundingBox() const override;
 
     // Getter & Setter
     double GetX() const { return x_; }
@@ -51,6 +51,8 @@ public:
 
     // Methods
     std::pair<double, double> DistanceToBorder(const Vector3D& position, const Vector3D& direction) const override;
+    std::pair<Vector3D, Vector3D> GetBoundingBox() const override;
+    std::pair<Vector3D, Vector3D> GetCavityBox() const override;
 
     // Getter & Setter
     double GetInnerRadius() const { return inner_radius_; }
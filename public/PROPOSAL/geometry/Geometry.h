@@ -96,6 +96,18 @@ public:
      */
     double DistanceToClosestApproach(const Vector3D& position, const Vector3D& direction) const;
 
+    /*!
+     * Axis aligned box enclosing the geometry, given by its lower and upper corner.
+     */
+    virtual std::pair<Vector3D, Vector3D> GetBoundingBox() const = 0;
+
+    /*!
+     * Axis aligned box inside the cavity of a hollow geometry, so no point of
+     * this box belongs to the geometry. Geometries without a cavity return
+     * an empty box, whose lower corner is above the upper one.
+     */
+    virtual std::pair<Vector3D, Vector3D> GetCavityBox() const;
+
     // void swap(Geometry &geometry);
 
     // ----------------------------------------------------------------- //
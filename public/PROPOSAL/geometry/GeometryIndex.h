@@ -0,0 +1,129 @@
+/******************************************************************************
+ *                                                                            *
+ * This file is part of the simulation tool PROPOSAL.                         *
+ *                                                                            *
+ * Copyright (C) 2017 TU Dortmund University, Department of Physics,          *
+ *                    Chair Experimental Physics 5b                           *
+ *                                                                            *
+ * This software may be modified and distributed under the terms of a         *
+ * modified GNU Lesser General Public Licence version 3 (LGPL),               *
+ * copied verbatim in the file "LICENSE".                                     *
+ *                                                                            *
+ * Modifcations to the LGPL License:                                          *
+ *                                                                            *
+ *      1. The user shall acknowledge the use of PROPOSAL by citing the       *
+ *         following reference:                                               *
+ *                                                                            *
+ *         J.H. Koehne et al.  Comput.Phys.Commun. 184 (2013) 2070-2090 DOI:  *
+ *         10.1016/j.cpc.2013.04.001                                          *
+ *                                                                            *
+ *      2. The user should report any bugs/errors or improvments to the       *
+ *         current maintainer of PROPOSAL or open an issue on the             *
+ *         GitHub webpage                                                     *
+ *                                                                            *
+ *         "https://github.com/tudo-astroparticlephysics/PROPOSAL"            *
+ *                                                                            *
+ ******************************************************************************/
+
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "PROPOSAL/geometry/Geometry.h"
+
+namespace PROPOSAL {
+
+/*!
+ * Bounding volume hierarchy over a list of geometries.
+ *
+ * Every node stores the box enclosing all of its geometries and the box
+ * which lies inside the cavities of all of them. A point or a ray is only
+ * tested against the geometries of a node if it touches the enclosing box
+ * and leaves the common cavity. Nested shells are split by their size, so
+ * the layers around a point are found in logarithmic time, too.
+ *
+ * Each geometry is added with a group, and the queries only return
+ * geometries of the requested group. The index refers to the geometries
+ * by their position in the list given to the constructor.
+ */
+class GeometryIndex
+{
+public:
+    GeometryIndex();
+    GeometryIndex(const std::vector<std::shared_ptr<const Geometry>>& geometries,
+        const std::vector<int>& groups);
+
+    // ----------------------------------------------------------------- //
+    // Member functions
+    // ----------------------------------------------------------------- //
+
+    /*!
+     * Fills inside with the indices of all geometries of the group which
+     * contain the position, in the sense of Geometry::IsInside, in
+     * ascending order. The vector is cleared first; once it has reached
+     * its final capacity no memory is allocated.
+     */
+    void FindInside(const Vector3D& position, const Vector3D& direction,
+        int group, std::vector<int>& inside) const;
+
+    /*!
+     * Returns the smallest positive distance to the border of a geometry of
+     * the group with a hierarchy of at least min_hierarchy, or max_distance
+     * if no border is closer than max_distance.
+     */
+    double DistanceToBorder(const Vector3D& position, const Vector3D& direction,
+        int group, unsigned int min_hierarchy, double max_distance) const;
+
+    size_t size() const { return entries_.size(); }
+
+private:
+    struct AxisAlignedBox
+    {
+        AxisAlignedBox();
+        AxisAlignedBox(const std::pair<Vector3D, Vector3D>& corners);
+
+        bool IsEmpty() const;
+        bool Contains(const double point[3]) const;
+        void Enclose(const AxisAlignedBox&);
+        void Intersect(const AxisAlignedBox&);
+        void Widen(double margin);
+
+        // distances along the ray at which the ray enters and leaves the box
+        std::pair<double, double> RayIntersection(const double origin[3], const double inverse_direction[3]) const;
+
+        double lower[3];
+        double upper[3];
+    };
+
+    struct Entry
+    {
+        std::shared_ptr<const Geometry> geometry;
+        int group;
+        unsigned int hierarchy;
+        AxisAlignedBox bounds;
+        AxisAlignedBox cavity;
+    };
+
+    struct Node
+    {
+        AxisAlignedBox bounds; //!< encloses all geometries of the node
+        AxisAlignedBox cavity; //!< lies inside the cavities of all geometries of the node
+        int left;              //!< index of the children, -1 for leafs
+        int right;
+        int first;             //!< range of the leaf in order_
+        int count;
+    };
+
+    int Build(int first, int count);
+
+    std::vector<Entry> entries_;
+    std::vector<int> order_;
+    std::vector<Node> nodes_;
+
+    static const int max_leaf_size_ = 2;
+    static const int max_depth_ = 64;
+};
+
+} // namespace PROPOSAL
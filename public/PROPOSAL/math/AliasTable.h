@@ -0,0 +1,59 @@
+
+/******************************************************************************
+ *                                                                            *
+ * This file is part of the simulation tool PROPOSAL.                         *
+ *                                                                            *
+ * Copyright (C) 2017 TU Dortmund University, Department of Physics,          *
+ *                    Chair Experimental Physics 5b                           *
+ *                                                                            *
+ * This software may be modified and distributed under the terms of a         *
+ * modified GNU Lesser General Public Licence version 3 (LGPL),               *
+ * copied verbatim in the file "LICENSE".                                     *
+ *                                                                            *
+ * Modifcations to the LGPL License:                                          *
+ *                                                                            *
+ *      1. The user shall acknowledge the use of PROPOSAL by citing the       *
+ *         following reference:                                               *
+ *                                                                            *
+ *         J.H. Koehne et al.  Comput.Phys.Commun. 184 (2013) 2070-2090 DOI:  *
+ *         10.1016/j.cpc.2013.04.001                                          *
+ *                                                                            *
+ *      2. The user should report any bugs/errors or improvments to the       *
+ *         current maintainer of PROPOSAL or open an issue on the             *
+ *         GitHub webpage                                                     *
+ *                                                                            *
+ *         "https://github.com/tudo-astroparticlephysics/PROPOSAL"            *
+ *                                                                            *
+ ******************************************************************************/
+#pragma once
+
+#include <vector>
+
+namespace PROPOSAL {
+
+// ----------------------------------------------------------------------------
+/// @brief Walker's alias method for a discrete distribution
+///
+/// The weights do not need to be normalized. After the setup, an index is
+/// sampled with one random number in constant time: its integer part chooses
+/// a column, its fractional part decides between the column and its alias.
+// ----------------------------------------------------------------------------
+class AliasTable
+{
+public:
+    AliasTable(const std::vector<double>& weights);
+
+    bool operator==(const AliasTable&) const;
+    bool operator!=(const AliasTable&) const;
+
+    // rnd has to be in [0, 1)
+    unsigned int Sample(double rnd) const;
+
+    unsigned int GetSize() const { return probability_.size(); }
+
+private:
+    std::vector<double> probability_;
+    std::vector<unsigned int> alias_;
+};
+
+} // namespace PROPOSAL
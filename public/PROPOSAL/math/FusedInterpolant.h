@@ -0,0 +1,114 @@
+
+/******************************************************************************
+ *                                                                            *
+ * This file is part of the simulation tool PROPOSAL.                         *
+ *                                                                            *
+ * Copyright (C) 2017 TU Dortmund University, Department of Physics,          *
+ *                    Chair Experimental Physics 5b                           *
+ *                                                                            *
+ * This software may be modified and distributed under the terms of a         *
+ * modified GNU Lesser General Public Licence version 3 (LGPL),               *
+ * copied verbatim in the file "LICENSE".                                     *
+ *                                                                            *
+ * Modifcations to the LGPL License:                                          *
+ *                                                                            *
+ *      1. The user shall acknowledge the use of PROPOSAL by citing the       *
+ *         following reference:                                               *
+ *                                                                            *
+ *         J.H. Koehne et al.  Comput.Phys.Commun. 184 (2013) 2070-2090 DOI:  *
+ *         10.1016/j.cpc.2013.04.001                                          *
+ *                                                                            *
+ *      2. The user should report any bugs/errors or improvments to the       *
+ *         current maintainer of PROPOSAL or open an issue on the             *
+ *         GitHub webpage                                                     *
+ *                                                                            *
+ *         "https://github.com/tudo-astroparticlephysics/PROPOSAL"            *
+ *                                                                            *
+ ******************************************************************************/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+namespace PROPOSAL {
+
+class Interpolant;
+
+// ----------------------------------------------------------------------------
+/// @brief Several 1d interpolation tables on one common grid
+///
+/// The values of all tables are stored interleaved, node by node, so the
+/// Romberg vicinity of an x value is one contiguous block of memory. One
+/// evaluation locates x on the grid once and interpolates all tables in a
+/// single Neville scheme. The results are identical to evaluating every
+/// table on its own.
+///
+/// The tables have to be built on the same grid with the same settings and
+/// must not use the log substitution of the function values.
+// ----------------------------------------------------------------------------
+class FusedInterpolant
+{
+public:
+    FusedInterpolant(const std::vector<const Interpolant*>& interpolants);
+
+    bool operator==(const FusedInterpolant&) const;
+    bool operator!=(const FusedInterpolant&) const;
+
+    // ----------------------------------------------------------------------------
+    /// @brief Interpolates all tables at x
+    ///
+    /// @param values array of GetNumberOfColumns() results, in the order
+    ///        the tables have been passed to the constructor
+    // ----------------------------------------------------------------------------
+    void Interpolate(double x, double* values) const;
+
+    unsigned int GetNumberOfColumns() const { return columns_; }
+
+    // Upper bound of the number of fused tables, the Neville scheme keeps
+    // its working arrays on the stack.
+    static const unsigned int max_columns_ = 8;
+
+private:
+    unsigned int columns_;
+    int romberg_;
+    int max_;
+    double xmin_, step_;
+    bool rational_;
+    bool isLog_;
+
+    std::vector<double> iX_;
+    std::vector<double> iY_; //!< iY_[node * columns_ + column]
+};
+
+// ----------------------------------------------------------------------------
+/// @brief Remembers the last two evaluations of a fused table
+///
+/// A propagation step evaluates the tables at the initial energy and at a
+/// few trial final energies, alternating between both. Keeping two results
+/// means each of these energies is looked up in the table only once.
+///
+/// The cache is not thread safe. Each owner, e.g. each copy of a Sector,
+/// needs its own cache, while the table itself is shared.
+// ----------------------------------------------------------------------------
+class FusedInterpolantCache
+{
+public:
+    FusedInterpolantCache(std::shared_ptr<const FusedInterpolant>);
+    FusedInterpolantCache(const FusedInterpolantCache&);
+
+    double Interpolate(double x, unsigned int column);
+
+    std::shared_ptr<const FusedInterpolant> GetTable() const { return table_; }
+
+private:
+    FusedInterpolantCache& operator=(const FusedInterpolantCache&); // Undefined & not allowed
+
+    std::shared_ptr<const FusedInterpolant> table_;
+
+    double x_[2];
+    int newest_;
+    std::vector<double> values_; //!< values_[slot * columns + column]
+};
+
+} // namespace PROPOSAL
@@ -34,9 +34,12 @@
 #include <fstream>
 
 #include <functional>
+#include <memory>
 
 namespace PROPOSAL {
 
+class TableFile;
+
 /**
  *\class Interpolant
  *
@@ -62,6 +65,11 @@ private:
     const static double bigNumber_;
     const static double aBigNumber_;
 
+    // Upper bound of the interpolation order. The Neville scheme keeps its
+    // working arrays on the stack, so evaluating a table never writes to it
+    // and one table can be shared between copies and threads.
+    static const int romberg_max_ = 16;
+
     int romberg_, rombergY_;
 
     std::vector<double> iX_;
@@ -69,9 +77,6 @@ private:
 
     std::vector<std::vector<double> > iY2_;
 
-    std::vector<double> c_;
-    std::vector<double> d_;
-
     int max_;
     double xmin_, xmax_, step_;
     bool rational_, relative_;
@@ -80,31 +85,52 @@ private:
     std::function<double(double, double)> function2d_;
     std::vector<Interpolant*> Interpolant_;
 
-    int row_, starti_;
+    int row_; // Only used while the 2d table is filled
     bool rationalY_, relativeY_;
 
-    bool reverse_, self_, flag_; // Self is setted to true in constructor
+    bool self_, flag_; // Self is setted to true in constructor
     bool isLog_, logSubst_;
 
-    double precision_, worstX_;
-    double precision2_, worstX2_;
-    double precisionY_, worstY_;
-
     bool fast_; // Is setted to true in constructor
 
-    double x_save_, y_save_; // Is setted to 1 and 0 in constructor
+    // Tables loaded from a TableFile read their nodes and values from the
+    // mapped file instead of iX_ and iY_, the file stays mapped as long as
+    // one of its tables exists.
+    std::shared_ptr<const TableFile> table_file_;
+    const double* mapped_x_;
+    const double* mapped_y_;
+
+    const double* GetX() const { return mapped_x_ ? mapped_x_ : iX_.data(); }
+    const double* GetY() const { return mapped_y_ ? mapped_y_ : iY_.data(); }
+    int GetNumberOfX() const { return mapped_x_ ? max_ : iX_.size(); }
+    int GetNumberOfY() const { return mapped_y_ ? max_ : iY_.size(); }
+
+    // Copies the mapped nodes and values into iX_ and iY_ before they are
+    // changed
+    void Unmap();
 
     //----------------------------------------------------------------------------//
     // Memberfunctions
 
     /*!
-     * interpolates f(x) based on the values iY[i]=f(iX[i]) in the romberg-vicinity of x
+     * interpolates f(x) based on the values ys[i]=f(xs[i]) in the romberg-vicinity of x
      *
      * \param   x        position of the function
-     * \param   start    start position of the sampling points for interpolation
+     * \param   xs       sampling points, starting at the first point used for the interpolation
+     * \param   ys       function values at the sampling points
+     * \param   romberg  number of sampling points used
+     * \param   num      index (relative to xs) of the sampling point closest to x
+     * \param   rational interpolate with rational function
+     * \param   reverse  check for log substituted values which are cut off
      * \return  Interpolation result
      */
-    double Interpolate(double x, int start);
+    double Interpolate(double x,
+                       const double* xs,
+                       const double* ys,
+                       int romberg,
+                       int num,
+                       bool rational,
+                       bool reverse) const;
 
     //----------------------------------------------------------------------------//
 
@@ -118,7 +144,7 @@ private:
      * \return   exp(x) OR 0;
      */
 
-    double Exp(double x);
+    static double Exp(double x);
 
     //----------------------------------------------------------------------------//
 
@@ -132,18 +158,7 @@ private:
      * \return   log(x) OR bigNumber;
      */
 
-    double Log(double x);
-
-    //----------------------------------------------------------------------------//
-
-    /**
-     * Log it again.
-     *
-     * \param    x
-     * \return   log(x) OR y_save;
-     */
-
-    double Slog(double x);
+    static double Log(double x);
 
     //----------------------------------------------------------------------------//
 
@@ -194,6 +209,12 @@ private:
 
     //----------------------------------------------------------------------------//
 
+    // Copies the grid and the values of several tables into one
+    friend class FusedInterpolant;
+
+    // Writes the tables and creates them from the mapped file
+    friend class TableFile;
+
 public:
     Interpolant(const Interpolant&);
     Interpolant& operator=(const Interpolant&);
@@ -350,7 +371,7 @@ public:
      * \return   interpolated value f(x)
      */
 
-    double Interpolate(double x);
+    double Interpolate(double x) const;
 
     //----------------------------------------------------------------------------//
 
@@ -362,7 +383,7 @@ public:
      * \return   interpolated value f(x1,x2)
      */
 
-    double Interpolate(double x1, double x2);
+    double Interpolate(double x1, double x2) const;
 
     //----------------------------------------------------------------------------//
 
@@ -373,7 +394,7 @@ public:
      * \return   interpolated value f(x)
      */
 
-    double InterpolateArray(double x);
+    double InterpolateArray(double x) const;
 
     //----------------------------------------------------------------------------//
 
@@ -385,7 +406,7 @@ public:
      * \return   interpolated value f(x1,x2)
      */
 
-    double InterpolateArray(double x1, double x2);
+    double InterpolateArray(double x1, double x2) const;
 
     //----------------------------------------------------------------------------//
 
@@ -398,7 +419,7 @@ public:
      * \return   interpolated value x(y);
      */
 
-    double FindLimit(double y);
+    double FindLimit(double y) const;
 
     //----------------------------------------------------------------------------//
 
@@ -412,7 +433,7 @@ public:
      * \return   interpolated value x(y);
      */
 
-    double FindLimit(double x1, double y);
+    double FindLimit(double x1, double y) const;
 
     //----------------------------------------------------------------------------//
 
@@ -427,7 +448,7 @@ public:
      */
 
     bool Save(std::string Path, bool binary_tables = false);
-    bool Save(std::ofstream& out, bool binary_tables = false);
+    bool Save(std::ostream& out, bool binary_tables = false);
 
     //----------------------------------------------------------------------------//
 
@@ -439,7 +460,7 @@ public:
      */
 
     bool Load(std::string Path, bool binary_tables = false);
-    bool Load(std::ifstream& in, bool binary_tables = false);
+    bool Load(std::istream& in, bool binary_tables = false);
 
     //----------------------------------------------------------------------------//
     //----------------------------------------------------------------------------//
@@ -457,13 +478,9 @@ public:
 
     int GetRomberg() const { return romberg_; }
 
-    std::vector<double> GetIX() const { return iX_; }
-
-    std::vector<double> GetIY() const { return iY_; }
-
-    std::vector<double> GetC() const { return c_; }
+    std::vector<double> GetIX() const { return std::vector<double>(GetX(), GetX() + GetNumberOfX()); }
 
-    std::vector<double> GetD() const { return d_; }
+    std::vector<double> GetIY() const { return std::vector<double>(GetY(), GetY() + GetNumberOfY()); }
 
     int GetMax() const { return max_; }
 
@@ -479,8 +496,6 @@ public:
 
     int GetRow() const { return row_; }
 
-    int GetStarti() const { return starti_; }
-
     bool GetRationalY() const { return rationalY_; }
 
     bool GetRelativeY() const { return relativeY_; }
@@ -489,28 +504,12 @@ public:
 
     bool GetFlag() const { return flag_; }
 
-    bool GetReverse() const { return reverse_; }
-
     bool GetIsLog() const { return isLog_; }
 
     bool GetLogSubst() const { return logSubst_; }
 
-    double GetPrecision() const { return precision_; }
-
-    double GetWorstX() const { return worstX_; }
-
-    double GetWorstX2() const { return worstX2_; }
-
-    double GetWorstY() const { return worstY_; }
-
-    double GetPrecisionY() const { return precisionY_; }
-
     bool GetFast() const { return fast_; }
 
-    double GetX_save() const { return x_save_; }
-
-    double GetY_save() const { return y_save_; }
-
     //----------------------------------------------------------------------------//
     // Setter
 
@@ -518,8 +517,6 @@ public:
     void SetRomberg(int romberg);
     void SetIX(const std::vector<double>& iX);
     void SetIY(const std::vector<double>& iY);
-    void SetC(const std::vector<double>& c);
-    void SetD(const std::vector<double>& d);
     void SetMax(int max);
     void SetXmin(double xmin);
     void SetXmax(double xmax);
@@ -527,22 +524,13 @@ public:
     void SetRelative(bool relative);
     void SetRational(bool rational);
     void SetRow(int row);
-    void SetStarti(int starti);
     void SetRationalY(bool rationalY);
     void SetRelativeY(bool relativeY);
     void SetSelf(bool self);
     void SetFlag(bool flag);
-    void SetReverse(bool reverse);
     void SetIsLog(bool isLog);
     void SetLogSubst(bool logSubst);
-    void SetPrecision(double precision);
-    void SetWorstX(double worstX);
-    void SetWorstX2(double worstX2);
-    void SetWorstY(double worstY);
-    void SetPrecisionY(double precisionY);
     void SetFast(bool fast);
-    void SetX_save(double x_save);
-    void SetY_save(double y_save);
     /*!
      * Destructor
      */
@@ -0,0 +1,98 @@
+
+/******************************************************************************
+ *                                                                            *
+ * This file is part of the simulation tool PROPOSAL.                         *
+ *                                                                            *
+ * Copyright (C) 2017 TU Dortmund University, Department of Physics,          *
+ *                    Chair Experimental Physics 5b                           *
+ *                                                                            *
+ * This software may be modified and distributed under the terms of a         *
+ * modified GNU Lesser General Public Licence version 3 (LGPL),               *
+ * copied verbatim in the file "LICENSE".                                     *
+ *                                                                            *
+ * Modifcations to the LGPL License:                                          *
+ *                                                                            *
+ *      1. The user shall acknowledge the use of PROPOSAL by citing the       *
+ *         following reference:                                               *
+ *                                                                            *
+ *         J.H. Koehne et al.  Comput.Phys.Commun. 184 (2013) 2070-2090 DOI:  *
+ *         10.1016/j.cpc.2013.04.001                                          *
+ *                                                                            *
+ *      2. The user should report any bugs/errors or improvments to the       *
+ *         current maintainer of PROPOSAL or open an issue on the             *
+ *         GitHub webpage                                                     *
+ *                                                                            *
+ *         "https://github.com/tudo-astroparticlephysics/PROPOSAL"            *
+ *                                                                            *
+ ******************************************************************************/
+
+#pragma once
+
+#include <functional>
+#include <vector>
+
+namespace PROPOSAL {
+
+// ----------------------------------------------------------------------------
+/// @brief Tabulated quantile function t(x1, u) of a family of distributions
+///
+/// The quantiles are stored on a regular grid in x1 (logarithmic, if isLog1
+/// is set) and on a grid in the probability u in [0, 1], which is dense at
+/// both ends. A lookup interpolates bilinear, so sampling needs no search.
+///
+/// The grid is refined until the cumulative distribution function, evaluated
+/// at the interpolated quantile, deviates from u by less than the given
+/// accuracy in the middle of the grid cells. The accuracy is a bound on the
+/// probability error of the sampled values, so steep parts of the quantile
+/// function with little probability do not enforce a fine grid. A direction
+/// is no longer refined once halving its step does not reduce the error,
+/// then the resolution of the tabulated function itself is reached. If the
+/// table would grow beyond max_size nodes, the refinement stops with a
+/// warning. With max1 = 1, the table holds the single distribution at x1min
+/// and x1 is ignored by the lookup.
+// ----------------------------------------------------------------------------
+class QuantileTable
+{
+public:
+    QuantileTable(int max1,
+                  double x1min,
+                  double x1max,
+                  int max2,
+                  std::function<double(double, double)> quantile,
+                  std::function<double(double, double)> cdf,
+                  double accuracy,
+                  bool isLog1,
+                  int max_size = max_size_);
+
+    bool operator==(const QuantileTable&) const;
+    bool operator!=(const QuantileTable&) const;
+
+    double Interpolate(double x1, double u) const;
+
+    // Largest deviation of the cumulative distribution function from u found
+    // in the last validation of the grid.
+    double GetAccuracy() const { return accuracy_; }
+    int GetMax1() const { return max1_; }
+    int GetMax2() const { return max2_; }
+
+    // Probability of the first and of the last cell in u. A quantile function
+    // which diverges at the ends is only resolved outside of these cells.
+    double GetEdgeProbability() const;
+
+    static const int max_size_ = 1 << 18;
+
+    // Factor by which halving a step has to reduce the error at least
+    static const double min_improvement_;
+
+private:
+    void Fill(const std::function<double(double, double)>& quantile);
+
+    int max1_, max2_;
+    double x1min_, x1max_, step1_, step2_;
+    bool isLog1_;
+    double accuracy_;
+
+    std::vector<double> values_; // values_[i1 * max2_ + i2]
+};
+
+} // namespace PROPOSAL
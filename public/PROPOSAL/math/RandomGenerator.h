@@ -29,6 +29,8 @@
 
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <functional>
 #include <random>
 #include <iostream>
@@ -40,8 +42,88 @@
 
 namespace PROPOSAL {
 
+// ----------------------------------------------------------------------------
+/// @brief Counter based random number stream
+///
+/// Philox4x32-10 generator (Salmon et al., SC11) keyed by the seed and the
+/// number of the event. The n-th random number of an event is a pure function
+/// of (seed, event id, n), so an event is reproducible independent of the
+/// thread it is propagated in and of the events propagated before.
+/// A stream is cheap to create and holds no shared state.
+// ----------------------------------------------------------------------------
+class RandomStream
+{
+public:
+    typedef std::array<uint32_t, 4> Counter;
+    typedef std::array<uint32_t, 2> Key;
+
+    RandomStream(uint64_t seed = 0, uint64_t event_id = 0);
+
+    // ----------------------------------------------------------------------------
+    /// @brief Next uniformly distributed random number in [0, 1)
+    // ----------------------------------------------------------------------------
+    double RandomDouble()
+    {
+        if (buffered_ == 0)
+        {
+            Counter block = Philox4x32(NextCounter(), key_);
+            buffer_[0]    = ToDouble(block[0], block[1]);
+            buffer_[1]    = ToDouble(block[2], block[3]);
+            buffered_     = 2;
+        }
+        return buffer_[2 - buffered_--];
+    }
+
+    // ----------------------------------------------------------------------------
+    /// @brief Restart the stream for another event
+    // ----------------------------------------------------------------------------
+    void Reset(uint64_t seed, uint64_t event_id);
+
+    uint64_t GetSeed() const { return seed_; }
+    uint64_t GetEventId() const { return event_id_; }
+    uint64_t GetNumberOfBlocks() const { return block_; }
+
+    // ----------------------------------------------------------------------------
+    /// @brief Philox4x32 bijection with 10 rounds
+    ///
+    /// @param counter: 128 bit counter
+    /// @param key: 64 bit key
+    ///
+    /// @return 128 random bits
+    // ----------------------------------------------------------------------------
+    static Counter Philox4x32(Counter counter, Key key);
+
+private:
+    Counter NextCounter()
+    {
+        Counter counter = { { static_cast<uint32_t>(block_),
+                              static_cast<uint32_t>(block_ >> 32),
+                              static_cast<uint32_t>(event_id_),
+                              static_cast<uint32_t>(event_id_ >> 32) } };
+        ++block_;
+        return counter;
+    }
+
+    static double ToDouble(uint32_t low, uint32_t high)
+    {
+        // use the upper 53 bits to fill the mantissa
+        return ((static_cast<uint64_t>(high) << 32 | low) >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    uint64_t seed_;
+    uint64_t event_id_;
+    uint64_t block_;
+    Key key_;
+    double buffer_[2];
+    int buffered_;
+};
+
 // ----------------------------------------------------------------------------
 /// @brief Random number generator
+///
+/// If a RandomStream is attached to the calling thread, all random numbers
+/// of this thread are drawn from that stream. Otherwise the global generator
+/// (or the custom random function) is used.
 // ----------------------------------------------------------------------------
 class RandomGenerator
 {
@@ -61,6 +143,16 @@ public:
 
     void SetSeed(int seed);
 
+    // ----------------------------------------------------------------------------
+    /// @brief Attach a random stream to the calling thread
+    ///
+    /// @param stream: stream to draw from, NULL detaches the current one
+    ///
+    /// @return the previously attached stream
+    // ----------------------------------------------------------------------------
+    static RandomStream* SetThreadStream(RandomStream* stream);
+    static RandomStream* GetThreadStream() { return thread_stream_; }
+
     // ----------------------------------------------------------------------------
     /// @brief Serialize the rng to a stream
     ///
@@ -105,6 +197,7 @@ private:
 
     static double DefaultRandomDouble();
 
+    static thread_local RandomStream* thread_stream_;
     static std::mt19937 rng_;
     static std::uniform_real_distribution<double> uniform_distribution;
     std::function<double()> random_function;
@@ -113,4 +206,23 @@ private:
 #endif
 };
 
+// ----------------------------------------------------------------------------
+/// @brief Attach a stream to the current thread for the lifetime of the scope
+// ----------------------------------------------------------------------------
+class RandomStreamScope
+{
+public:
+    RandomStreamScope(RandomStream& stream)
+        : previous_(RandomGenerator::SetThreadStream(&stream))
+    {
+    }
+    ~RandomStreamScope() { RandomGenerator::SetThreadStream(previous_); }
+
+private:
+    RandomStreamScope(const RandomStreamScope&);
+    RandomStreamScope& operator=(const RandomStreamScope&);
+
+    RandomStream* previous_;
+};
+
 } // namespace PROPOSAL
@@ -0,0 +1,143 @@
+
+/******************************************************************************
+ *                                                                            *
+ * This file is part of the simulation tool PROPOSAL.                         *
+ *                                                                            *
+ * Copyright (C) 2017 TU Dortmund University, Department of Physics,          *
+ *                    Chair Experimental Physics 5b                           *
+ *                                                                            *
+ * This software may be modified and distributed under the terms of a         *
+ * modified GNU Lesser General Public Licence version 3 (LGPL),               *
+ * copied verbatim in the file "LICENSE".                                     *
+ *                                                                            *
+ * Modifcations to the LGPL License:                                          *
+ *                                                                            *
+ *      1. The user shall acknowledge the use of PROPOSAL by citing the       *
+ *         following reference:                                               *
+ *                                                                            *
+ *         J.H. Koehne et al.  Comput.Phys.Commun. 184 (2013) 2070-2090 DOI:  *
+ *         10.1016/j.cpc.2013.04.001                                          *
+ *                                                                            *
+ *      2. The user should report any bugs/errors or improvments to the       *
+ *         current maintainer of PROPOSAL or open an issue on the             *
+ *         GitHub webpage                                                     *
+ *                                                                            *
+ *         "https://github.com/tudo-astroparticlephysics/PROPOSAL"            *
+ *                                                                            *
+ ******************************************************************************/
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace PROPOSAL {
+
+class Interpolant;
+
+// ----------------------------------------------------------------------------
+/// @brief Interpolation tables in a file, which is mapped into memory
+///
+/// The file is mapped read-only, the interpolants read their nodes directly
+/// from the mapped pages without parsing or copying. Processes on the same
+/// node therefore share the tables through the page cache.
+///
+/// Layout, all numbers in the byte order of the writing machine:
+///  - header of 64 bytes with magic, version, byte order mark, file size,
+///    number of tables and the checksum of the index
+///  - index with the offset of every table from the start of the file and
+///    the checksum of the table, which reaches up to the next table
+///  - the tables, each a Record followed by its nodes, values and, for 2d
+///    tables, the offsets of its rows, which are 1d tables
+/// Every record and array starts at a multiple of 64 bytes.
+///
+/// A file from another version, another byte order or with a wrong size or
+/// checksum of the index is rejected by Map, as is a file with a record or
+/// array outside of it. The checksum of a table is checked once, when the
+/// table is used first, so mapping a file does not read all of it.
+// ----------------------------------------------------------------------------
+class TableFile : public std::enable_shared_from_this<TableFile>
+{
+public:
+    static const uint32_t version_ = 4;
+    static const char* const extension_; //!< appended to the file name
+
+    // ----------------------------------------------------------------------------
+    /// @brief Writes the tables in the layout of the mapped files
+    ///
+    /// The 2d tables created from arrays keep further values and can not be
+    /// written, all other tables, as the ones of the builders, can. The file
+    /// is replaced atomically, see Helper::WriteFileAtomic.
+    ///
+    /// @return false if a table can not be written or the file can not be
+    ///         opened
+    // ----------------------------------------------------------------------------
+    static bool Write(const std::string& path, const std::vector<const Interpolant*>& tables);
+
+    // ----------------------------------------------------------------------------
+    /// @brief Maps a table file into memory
+    ///
+    /// @return NULL if the file can not be mapped or is no valid table file
+    ///         of this version
+    // ----------------------------------------------------------------------------
+    static std::shared_ptr<const TableFile> Map(const std::string& path);
+
+    // ----------------------------------------------------------------------------
+    /// @brief Table file at data inside of a larger mapping, as the entries
+    ///        of a TablePack
+    ///
+    /// @param mapping keeps the memory alive as long as one of the tables
+    ///        exists
+    ///
+    /// @return NULL if the memory is no valid table file of this version
+    // ----------------------------------------------------------------------------
+    static std::shared_ptr<const TableFile> Open(std::shared_ptr<const char> mapping, const char* data, size_t size);
+
+    // ----------------------------------------------------------------------------
+    /// @brief Writes the tables in the layout of the files into the buffer
+    ///
+    /// @return false if a table can not be written
+    // ----------------------------------------------------------------------------
+    static bool Serialize(const std::vector<const Interpolant*>& tables, std::vector<char>& buffer);
+
+    // ----------------------------------------------------------------------------
+    /// @brief Maps size bytes of the open file read-only into memory
+    ///
+    /// @return memory which is unmapped with the last copy, NULL on failure
+    // ----------------------------------------------------------------------------
+    static std::shared_ptr<const char> MapMemory(int descriptor, size_t size);
+
+    unsigned int GetNumberOfTables() const { return offsets_.size(); }
+
+    // ----------------------------------------------------------------------------
+    /// @brief Table with the given index, which keeps the mapping alive
+    ///
+    /// @return NULL if the checksum of the table does not match
+    // ----------------------------------------------------------------------------
+    std::shared_ptr<const Interpolant> GetInterpolant(unsigned int index) const;
+
+private:
+    TableFile(std::shared_ptr<const char> mapping, const char* data, size_t size);
+
+    // Appends the record and the arrays of a table, false if it can not be
+    // written. offset is set to the position of the record.
+    static bool AppendTable(std::vector<char>& buffer, const Interpolant& table, uint64_t& offset);
+
+    // Checks the record at offset and the records of its rows
+    bool IsValid(uint64_t offset, bool is_row) const;
+
+    // Creates an interpolant reading from the record at offset
+    Interpolant* CreateInterpolant(uint64_t offset) const;
+
+    std::shared_ptr<const char> mapping_;
+    const char* data_;
+    size_t size_;
+    std::vector<uint64_t> offsets_;
+    std::vector<uint64_t> checksums_;
+    mutable std::vector<std::atomic<int> > checks_; //!< tables whose checksum is checked
+};
+
+} // namespace PROPOSAL
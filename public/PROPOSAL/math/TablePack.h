@@ -0,0 +1,167 @@
+
+/******************************************************************************
+ *                                                                            *
+ * This file is part of the simulation tool PROPOSAL.                         *
+ *                                                                            *
+ * Copyright (C) 2017 TU Dortmund University, Department of Physics,          *
+ *                    Chair Experimental Physics 5b                           *
+ *                                                                            *
+ * This software may be modified and distributed under the terms of a         *
+ * modified GNU Lesser General Public Licence version 3 (LGPL),               *
+ * copied verbatim in the file "LICENSE".                                     *
+ *                                                                            *
+ * Modifcations to the LGPL License:                                          *
+ *                                                                            *
+ *      1. The user shall acknowledge the use of PROPOSAL by citing the       *
+ *         following reference:                                               *
+ *                                                                            *
+ *         J.H. Koehne et al.  Comput.Phys.Commun. 184 (2013) 2070-2090 DOI:  *
+ *         10.1016/j.cpc.2013.04.001                                          *
+ *                                                                            *
+ *      2. The user should report any bugs/errors or improvments to the       *
+ *         current maintainer of PROPOSAL or open an issue on the             *
+ *         GitHub webpage                                                     *
+ *                                                                            *
+ *         "https://github.com/tudo-astroparticlephysics/PROPOSAL"            *
+ *                                                                            *
+ ******************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace PROPOSAL {
+
+class Interpolant;
+class TableFile;
+
+// ----------------------------------------------------------------------------
+/// @brief All tables of a table directory in one file
+///
+/// The pack holds table files (see TableFile), each under a key such as
+/// dNdx_<hash>. Entries are only appended, so a pack which is read by other
+/// processes stays valid. The pack is mapped into memory and an entry is
+/// found through the index, which is read when the pack is opened.
+///
+/// Layout, all numbers in the byte order of the writing machine:
+///  - header of 64 bytes with magic, version and byte order mark
+///  - the entries, each a header of 64 bytes with the sizes of the key and
+///    the table file and the checksum of the key, followed by the key and
+///    the table file
+/// Every entry, key and table file starts at a multiple of 64 bytes.
+///
+/// Readers and writers of a pack synchronize through open file description
+/// locks (fcntl) on the file path + ".lock", so the threads of one process
+/// are separated as well. Where these locks are not available, flock is
+/// used for the pack and tables may be built by several processes.
+// ----------------------------------------------------------------------------
+class TablePack
+{
+public:
+    static const uint32_t version_ = 1;
+    static const char* const file_name_; //!< name of the pack in a table directory
+
+    // ----------------------------------------------------------------------------
+    /// @brief Current content of the pack
+    ///
+    /// The pack is mapped once per process as long as the file does not
+    /// change. An incomplete entry at the end, left by a writer which did not
+    /// finish, is ignored.
+    ///
+    /// @return NULL if the file does not exist or is no pack of this version
+    // ----------------------------------------------------------------------------
+    static std::shared_ptr<const TablePack> Open(const std::string& path);
+
+    // ----------------------------------------------------------------------------
+    /// @brief Appends the tables under the key, the file is created if needed
+    ///
+    /// A key, which is already in the pack, is not appended again.
+    ///
+    /// @return false if a table can not be written, the file is no pack or
+    /// can not be locked
+    // ----------------------------------------------------------------------------
+    static bool Append(const std::string& path, const std::string& key, const std::vector<const Interpolant*>& tables);
+
+    // ----------------------------------------------------------------------------
+    /// @brief Appends the entries of the input packs, which are not yet in
+    ///        the pack at path
+    ///
+    /// @return false if an input can not be read or the pack not be written
+    // ----------------------------------------------------------------------------
+    static bool Merge(const std::string& path, const std::vector<std::string>& inputs);
+
+    // ----------------------------------------------------------------------------
+    /// @brief Rewrites the pack without the entries whose keys start with one
+    ///        of the prefixes and without an incomplete entry at the end
+    ///
+    /// The pack is replaced atomically, processes which mapped it keep the
+    /// former version.
+    ///
+    /// @return false if the pack can not be locked, read or written
+    // ----------------------------------------------------------------------------
+    static bool Prune(const std::string& path, const std::vector<std::string>& prefixes);
+
+    // ----------------------------------------------------------------------------
+    /// @brief Tables of the key, which keep the pack mapped
+    ///
+    /// @return NULL if the key is not in the pack or the entry is corrupt
+    // ----------------------------------------------------------------------------
+    std::shared_ptr<const TableFile> Find(const std::string& key) const;
+
+    bool HasKey(const std::string& key) const { return index_.count(key) > 0; }
+
+    std::vector<std::string> GetKeys() const;
+
+    size_t GetSize() const { return size_; }
+
+    // ----------------------------------------------------------------------------
+    /// @brief Exclusive lock of a key of a pack
+    ///
+    /// Held while the tables of the key are built, so every table is built by
+    /// one process and thread and the others wait to read it afterwards.
+    // ----------------------------------------------------------------------------
+    class KeyLock
+    {
+    public:
+        KeyLock(const std::string& path, const std::string& key);
+        ~KeyLock();
+
+        bool IsLocked() const { return descriptor_ >= 0; }
+
+    private:
+        KeyLock(const KeyLock&);
+        KeyLock& operator=(const KeyLock&);
+
+        int descriptor_;
+    };
+
+private:
+    // Position and size of the table file of an entry
+    typedef std::map<std::string, std::pair<uint64_t, uint64_t> > Index;
+
+    TablePack(std::shared_ptr<const char> mapping, size_t size);
+
+    // Reads the entries of the pack, the end of the last complete entry is
+    // returned, 0 if the data is no pack
+    static uint64_t ReadIndex(const char* data, size_t size, Index& index);
+
+    struct Entry
+    {
+        std::string key;
+        const char* data;
+        size_t size;
+    };
+
+    // Appends the entries whose keys are not yet in the pack
+    static bool AppendEntries(const std::string& path, const std::vector<Entry>& entries);
+
+    std::shared_ptr<const char> mapping_;
+    size_t size_;
+    Index index_;
+};
+
+} // namespace PROPOSAL
@@ -0,0 +1,80 @@
+
+/******************************************************************************
+ *                                                                            *
+ * This file is part of the simulation tool PROPOSAL.                         *
+ *                                                                            *
+ * Copyright (C) 2017 TU Dortmund University, Department of Physics,          *
+ *                    Chair Experimental Physics 5b                           *
+ *                                                                            *
+ * This software may be modified and distributed under the terms of a         *
+ * modified GNU Lesser General Public Licence version 3 (LGPL),               *
+ * copied verbatim in the file "LICENSE".                                     *
+ *                                                                            *
+ * Modifcations to the LGPL License:                                          *
+ *                                                                            *
+ *      1. The user shall acknowledge the use of PROPOSAL by citing the       *
+ *         following reference:                                               *
+ *                                                                            *
+ *         J.H. Koehne et al.  Comput.Phys.Commun. 184 (2013) 2070-2090 DOI:  *
+ *         10.1016/j.cpc.2013.04.001                                          *
+ *                                                                            *
+ *      2. The user should report any bugs/errors or improvments to the       *
+ *         current maintainer of PROPOSAL or open an issue on the             *
+ *         GitHub webpage                                                     *
+ *                                                                            *
+ *         "https://github.com/tudo-astroparticlephysics/PROPOSAL"            *
+ *                                                                            *
+ ******************************************************************************/
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+namespace PROPOSAL {
+
+// ----------------------------------------------------------------------------
+/// @brief Runs the jobs to build interpolation tables on several threads
+///
+/// A job starts as soon as all jobs it depends on are done, jobs added
+/// earlier first, so a single thread runs them in the order they were
+/// added. The calling thread takes part in the work. Schedulers may be
+/// nested, e.g. the tables of a sector are built inside the job of a
+/// propagator. All schedulers together start at most n_threads - 1
+/// additional threads, so the threads which are idle at the outer level are
+/// taken over by the inner ones.
+///
+/// If a job throws, no further jobs are started and the first exception is
+/// rethrown by Run.
+// ----------------------------------------------------------------------------
+class TableScheduler
+{
+public:
+    typedef unsigned int Job;
+
+    // n_threads: maximal number of threads, 0 uses all hardware threads
+    TableScheduler(unsigned int n_threads);
+
+    // ----------------------------------------------------------------------------
+    /// @brief Adds a job, which starts after the given jobs are done
+    ///
+    /// Only jobs added before can be dependencies, so there are no cycles.
+    // ----------------------------------------------------------------------------
+    Job Add(std::function<void()> task, const std::vector<Job>& dependencies = std::vector<Job>());
+
+    // ----------------------------------------------------------------------------
+    /// @brief Runs all jobs added so far and returns after they are done
+    // ----------------------------------------------------------------------------
+    void Run();
+
+    unsigned int GetNumberOfThreads() const { return n_threads_; }
+
+private:
+    unsigned int n_threads_;
+    std::vector<std::function<void()> > tasks_;
+    std::vector<std::vector<Job> > dependencies_;
+
+    static std::atomic<unsigned int> additional_threads_; //!< threads started by all schedulers
+};
+
+} // namespace PROPOSAL
@@ -29,10 +29,12 @@
 
 #pragma once
 
+#include <cstdint>
 #include <deque>
 #include <vector>
 #include <functional>
 #include <map>
+#include <memory>
 #include "PROPOSAL/json.hpp"
 
 #define PROPOSAL_MAKE_HASHABLE(type, ...) \
@@ -80,7 +82,11 @@ struct InterpolationDef
         , nodes_cross_section(100) // number of interpolation in cross section
         , nodes_continous_randomization(200) // number of interpolation in continuous randomization
         , nodes_propagate(1000) // number of interpolation in propagate
+        , quantile_accuracy(0) // accuracy of the stochastic loss sampling tables, 0 disables them
+        , channel_accuracy(0) // relative accuracy of the interaction type sampling tables, 0 disables them
+        , number_of_threads(1) // threads to build the tables, 0 uses all hardware threads
         , do_binary_tables(true)
+        , do_table_pack(false) // binary tables of a path in one TablePack
         , just_use_readonly_path(false)
     {
     }
@@ -94,7 +100,11 @@ struct InterpolationDef
     int nodes_cross_section;
     int nodes_continous_randomization;
     int nodes_propagate;
+    double quantile_accuracy;
+    double channel_accuracy;
+    unsigned int number_of_threads;
     bool do_binary_tables;
+    bool do_table_pack;
     bool just_use_readonly_path;
 
     size_t GetHash() const;
@@ -148,6 +158,45 @@ std::string ResolvePath(const std::string&, bool checkReadonly=false);
 // ----------------------------------------------------------------------------
 bool FileExist(const std::string path);
 
+// ----------------------------------------------------------------------------
+/// @brief Checksum (64 bit FNV-1a) to detect corrupt table files
+// ----------------------------------------------------------------------------
+uint64_t Checksum(const char* data, size_t size);
+
+// ----------------------------------------------------------------------------
+/// @brief Writes a file under a temporary name and renames it afterwards
+///
+/// The temporary file is created by mkstemp in the directory of the file and
+/// synced to the disk before the rename. The rename replaces the file in one
+/// step, so readers never see a partly written file and a file, which another
+/// process still reads or maps, is not truncated.
+///
+/// @return false if the file could not be written
+// ----------------------------------------------------------------------------
+bool WriteFileAtomic(const std::string& path, const char* data, size_t size);
+
+// ----------------------------------------------------------------------------
+/// @brief Exclusive advisory lock (flock) of a table file
+///
+/// The lock is taken on path + ".lock" and held until the object is
+/// destroyed, other processes asking for it wait until then. The lock file
+/// is not removed, as processes could otherwise lock different files.
+// ----------------------------------------------------------------------------
+class FileLock
+{
+public:
+    explicit FileLock(const std::string& path);
+    ~FileLock();
+
+    bool IsLocked() const { return descriptor_ >= 0; }
+
+private:
+    FileLock(const FileLock&);
+    FileLock& operator=(const FileLock&);
+
+    int descriptor_;
+};
+
 // ----------------------------------------------------------------------------
 /// @brief Center string
 ///
@@ -159,21 +208,33 @@ bool FileExist(const std::string path);
 // ----------------------------------------------------------------------------
 std::string Centered(int width, const std::string& str, char fill = '=');
 
-typedef std::vector<std::pair<InterpolantBuilder*, Interpolant**> > InterpolantBuilderContainer;
+// The interpolation tables are immutable after initialization and are shared
+// between copies of the cross sections and propagation utilities.
+typedef std::vector<std::pair<InterpolantBuilder*, std::shared_ptr<const Interpolant>*> > InterpolantBuilderContainer;
 
 // ----------------------------------------------------------------------------
 /// @brief Helper for interpolation initialization
 ///
+/// Without dependencies, the tables are built one after another in the
+/// order of the container, so a builder may use all tables before it.
+/// With dependencies, the tables are built on
+/// InterpolationDef::number_of_threads threads and a table is only built
+/// after the tables it depends on.
+///
 /// @param name: subject of resulting file name
 /// @param InterpolantBuilderContainer:
 ///        vector of builder, pointer to Interplant pairs
 /// @param std::vector: vector of parametrizations used to create
 ///        the interpolation tables with
+/// @param dependencies: for every builder, the indices of the builders
+///        whose tables it needs
 // ----------------------------------------------------------------------------
 void InitializeInterpolation(const std::string name,
                              InterpolantBuilderContainer&,
                              const std::vector<Parametrization*>&,
-                             const InterpolationDef);
+                             const InterpolationDef,
+                             const std::vector<std::vector<unsigned int> >& dependencies
+                             = std::vector<std::vector<unsigned int> >());
 
 // ----------------------------------------------------------------------------
 /// @brief Simple map structure where keys and values can be used for indexing
@@ -92,6 +92,7 @@ public:
     // --------------------------------------------------------------------- //
 
     // Setter
+    void SetType(int type) { type_ = type; }
     void SetPosition(const Vector3D& position) { position_ = position; }
     void SetDirection(const Vector3D& direction) { direction_ = direction; }
 
@@ -41,6 +41,7 @@
 #include "PROPOSAL/crossection/factories/AnnihilationFactory.h"
 
 #include "PROPOSAL/EnergyCutSettings.h"
+#include "PROPOSAL/math/AliasTable.h"
 #include "PROPOSAL/medium/Medium.h"
 #include "PROPOSAL/particle/ParticleDef.h"
 #include "PROPOSAL/particle/Particle.h"
@@ -115,7 +116,33 @@ class Utility {
     std::shared_ptr<const Medium> medium_;
     EnergyCutSettings cut_settings_;
 
+    // --------------------------------------------------------------------- //
+    /// @brief Builds the tables to choose the interaction of StochasticLoss
+    /// in constant time
+    ///
+    /// A channel is a pair of a cross section and one of its dNdx tables.
+    /// On a logarithmic energy grid, the total rate and an alias table of
+    /// the channel rates are stored for every node. Between two nodes, the
+    /// rates are interpolated linear. Bins in which a channel starts, or in
+    /// which the probability of a channel differs by more than
+    /// InterpolationDef::channel_accuracy from the exact one, are left to the
+    /// exact calculation. Only possible if all cross sections are
+    /// interpolated.
+    // --------------------------------------------------------------------- //
+    void InitStochasticLossTables(const InterpolationDef&);
+
     std::vector<CrossSection*> crosssections_;
+    std::vector<double> rates_; //!< buffer reused by StochasticLoss
+
+    std::vector<std::pair<unsigned int, int> > channels_; //!< cross section and dNdx table
+    std::vector<double> total_rates_;                     //!< total rate at the nodes
+    std::vector<AliasTable> channel_tables_;              //!< channels at the nodes
+    std::vector<bool> exact_bins_;                        //!< bins with a threshold
+    double log_energy_min_;
+    double log_energy_step_;
+
+    // Nodes of the channel tables per node of the dNdx tables
+    static const int nodes_per_dndx_node_;
 };
 
 class UtilityDecorator {
@@ -61,6 +61,7 @@ class UtilityIntegral;
 namespace PROPOSAL {
 
 class Interpolant;
+class FusedInterpolantCache;
 
 class UtilityInterpolant : public UtilityDecorator
 {
@@ -78,17 +79,70 @@ public:
     virtual double Calculate(double ei, double ef, double rnd) = 0;
     virtual double GetUpperLimit(double ei, double rnd);
 
+    std::shared_ptr<const Interpolant> GetInterpolant() const { return interpolant_; }
+    std::shared_ptr<const Interpolant> GetInterpolantDiff() const { return interpolant_diff_; }
+
+    // ----------------------------------------------------------------------------
+    /// @brief Evaluates the tables through a fused table
+    ///
+    /// The integral is taken from the given column of the fused table, its
+    /// integrand from the next one. The cache belongs to the owner of the
+    /// decorator, so it is not passed on to copies.
+    // ----------------------------------------------------------------------------
+    void SetFusedTable(FusedInterpolantCache* cache, unsigned int column);
+
 protected:
     UtilityInterpolant& operator=(const UtilityInterpolant&); // Undefined & not allowed
 
     virtual bool compare(const UtilityDecorator&) const;
 
+    double InterpolateIntegral(double energy);
+    double InterpolateDiff(double energy);
+
+    // ----------------------------------------------------------------------------
+    /// @brief Tabulates the energy as function of the remaining integral
+    ///
+    /// The remaining integral is the integral from an energy down to the
+    /// lower energy limit. The table is derived from the integral table
+    /// after that one has been built or read.
+    // ----------------------------------------------------------------------------
+    void InitInverseInterpolation();
+
+    // ----------------------------------------------------------------------------
+    /// @brief Final energy, at which the remaining integral of ei has decreased by rnd
+    ///
+    /// One lookup of the inverse table, without root finding.
+    // ----------------------------------------------------------------------------
+    double InverseLimit(double ei, double rnd);
+
+    // ----------------------------------------------------------------------------
+    /// @brief Evaluates BuildInterpolant at all given energies in one sweep
+    ///
+    /// BuildInterpolant integrates from an energy to a fixed limit, but it is
+    /// only called at both ends. The other values are accumulated from the
+    /// integrals between neighbouring energies, starting at the end closer to
+    /// the limit. These short integrals are independent and are split into
+    /// jobs of a TableScheduler with interpolation_def_.number_of_threads
+    /// threads, each with its own copy of the utility.
+    ///
+    /// @param energies: ascending energies
+    // ----------------------------------------------------------------------------
+    std::vector<double> SweepIntegral(const std::vector<double>& energies, UtilityIntegral&, Integral&);
+
     virtual double BuildInterpolant(double, UtilityIntegral&, Integral&)                                = 0;
     virtual void InitInterpolation(const std::string&, UtilityIntegral&, int number_of_sampling_points) = 0;
 
     double stored_result_;
-    Interpolant* interpolant_;
-    Interpolant* interpolant_diff_;
+    std::shared_ptr<const Interpolant> interpolant_;
+    std::shared_ptr<const Interpolant> interpolant_diff_;
+
+    FusedInterpolantCache* fused_cache_;
+    unsigned int fused_column_;
+
+    std::shared_ptr<const Interpolant> interpolant_inverse_;
+    double lower_integral_;     //!< integral table at the lower energy limit
+    double inverse_min_;        //!< smallest remaining integral of the inverse table
+    double inverse_energy_min_; //!< energy belonging to inverse_min_
 
     InterpolationDef interpolation_def_;
 };
@@ -152,9 +206,6 @@ private:
     double BuildInterpolant(double, UtilityIntegral&, Integral&);
     void InitInterpolation(const std::string&, UtilityIntegral&, int number_of_sampling_points);
 
-    std::function<double(double)> f;
-    std::function<double(double)> df;
-
     double big_low_;
     double up_;
 };
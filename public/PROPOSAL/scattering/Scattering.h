@@ -28,13 +28,16 @@
 
 
 #pragma once
+#include <cstddef>
 #include <utility>
 #include <memory>
+#include <vector>
 #include "PROPOSAL/math/Vector3D.h"
 
 namespace PROPOSAL {
 
 struct ParticleDef;
+class RandomStream;
 class Utility;
 
 struct Directions : std::enable_shared_from_this<Directions>
@@ -72,6 +75,31 @@ public:
                         double rnd3,
                         double rnd4);
 
+    // ----------------------------------------------------------------------------
+    /// @brief Scatters a batch of particles in place
+    ///
+    /// Particle i is moved by dr[i] along its averaged direction and gets the
+    /// direction after the step, exactly as the single particle Scatter
+    /// would do it with the same random numbers. Each particle draws its four
+    /// random numbers from random_streams[i], or from the RandomGenerator if
+    /// no streams are given, also if dr[i] <= 0.
+    ///
+    /// @param n: number of particles
+    /// @param dr: displacements
+    /// @param ei: initial energies
+    /// @param ef: final energies
+    /// @param positions: positions before the step, replaced by the positions after it
+    /// @param directions: directions before the step, replaced by the directions after it
+    /// @param random_streams: random stream of every particle or NULL
+    // ----------------------------------------------------------------------------
+    void Scatter(size_t n,
+                 const double* dr,
+                 const double* ei,
+                 const double* ef,
+                 Vector3D* positions,
+                 Vector3D* directions,
+                 RandomStream* const* random_streams = NULL);
+
     const ParticleDef& GetParticleDef() const { return particle_def_; }
 
 protected:
@@ -96,7 +124,28 @@ protected:
                                               double rnd3,
                                               double rnd4) = 0;
 
+    // ----------------------------------------------------------------------------
+    /// @brief Random angles of a batch of particles
+    ///
+    /// The random numbers of particle i are rnd[4 * i] to rnd[4 * i + 3].
+    /// The angles of particles with dr[i] <= 0 are not used. The default
+    /// calls CalculateRandomAngle for every particle, models override it
+    /// with a version which can be vectorized.
+    // ----------------------------------------------------------------------------
+    virtual void CalculateRandomAngles(size_t n,
+                                       const double* dr,
+                                       const double* ei,
+                                       const double* ef,
+                                       const Vector3D* positions,
+                                       const double* rnd,
+                                       RandomAngles* angles);
+
     const ParticleDef& particle_def_;
+
+private:
+    // Buffers of the batch Scatter, kept to not allocate in every step
+    std::vector<double> random_numbers_;
+    std::vector<RandomAngles> random_angles_;
 };
 
 } // namespace PROPOSAL
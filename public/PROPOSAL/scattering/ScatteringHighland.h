@@ -62,9 +62,22 @@ private:
     void print(std::ostream&) const override;
 
     RandomAngles CalculateRandomAngle(double dr, double ei, double ef, const Vector3D& pos, double rnd1, double rnd2, double rnd3, double rnd4) override;
+    void CalculateRandomAngles(size_t n,
+                               const double* dr,
+                               const double* ei,
+                               const double* ef,
+                               const Vector3D* positions,
+                               const double* rnd,
+                               RandomAngles* angles) override;
     double CalculateTheta0(double dr, double ei, const Vector3D& pos);
+    double CalculateTheta0(double y, double ei) const;
 
     std::shared_ptr<const Medium> medium_;
+
+    // Buffers of the batch CalculateRandomAngles
+    std::vector<double> theta0_;
+    std::vector<double> probabilities_;
+    std::vector<double> gaussians_;
 };
 
 } // namespace PROPOSAL
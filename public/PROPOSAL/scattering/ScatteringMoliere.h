@@ -29,6 +29,7 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include "PROPOSAL/scattering/Scattering.h"
@@ -36,12 +37,27 @@
 namespace PROPOSAL {
 
 class Medium;
-
+class QuantileTable;
+struct InterpolationDef;
+
+// ----------------------------------------------------------------------------
+/// @brief Scattering angles following Moliere's distribution
+///
+/// By default, every angle is found with the Newton-Raphson method on the
+/// distribution of the medium. If InterpolationDef::quantile_accuracy is
+/// set above 0, the distribution is sampled as the mixture of the
+/// distributions of the components: a component is chosen with its weight and the angle is
+/// taken from a table of the quantiles of one component in (B, u). The
+/// table does not depend on the medium, it is built once per process and
+/// its probability error is bounded by InterpolationDef::quantile_accuracy.
+/// The far tails and B above the table are solved exactly.
+// ----------------------------------------------------------------------------
 class ScatteringMoliere : public Scattering
 {
 public:
     // constructor
     ScatteringMoliere(const ParticleDef&, std::shared_ptr<const Medium>);
+    ScatteringMoliere(const ParticleDef&, std::shared_ptr<const Medium>, const InterpolationDef&);
     ScatteringMoliere(const ParticleDef&, const ScatteringMoliere&);
     ScatteringMoliere(const ScatteringMoliere&);
     ~ScatteringMoliere();
@@ -72,24 +88,38 @@ private:
 
     // scattering parameters
     double chiCSq_; // characteristic angle² in rad²
+    std::vector<double> chi_A_Sq_; // screening angle^2 in rad^2
     std::vector<double> B_;
 
     //----------------------------------------------------------------------------//
     //----------------------------------------------------------------------------//
 
-    double f1M(double x);
-    double f2M(double x);
+    static double f1M(double x);
+    static double f2M(double x);
 
     double f(double theta);
 
-    double F1M(double x);
-    double F2M(double x);
+    static double F1M(double x);
+    static double F2M(double x);
 
     double F(double theta);
 
+    // Distribution of t = theta / sqrt(chi_c^2 B) of one component
+    static double Density(double B, double t);
+    static double CumulativeDistribution(double B, double t);
+    static double Quantile(double B, double u);
+
     //----------------------------------------------------------------------------//
     //----------------------------------------------------------------------------//
 
     double GetRandom(double pre_factor, double rnd);
+    double GetRandomFromTable(double rnd);
+
+    static std::shared_ptr<const QuantileTable> GetQuantileTable(double accuracy);
+
+    static const double B_min_; // below, the particle is not deflected
+    static const double B_max_; // upper end of the quantile table
+
+    std::shared_ptr<const QuantileTable> quantile_table_; // NULL without interpolation
 };
 } // namespace PROPOSAL
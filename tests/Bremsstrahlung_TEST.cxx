@@ -549,6 +549,42 @@ TEST(Bremsstrahlung, Test_of_e_Interpolant)
     }
 }
 
+TEST(Bremsstrahlung, Test_of_e_Quantile_Tables)
+{
+    // The quantile tables replace FindLimit to sample the loss. Both have to
+    // agree within the accuracy of the tables, measured in units of the
+    // cumulative distribution.
+    ParticleDef particle_def = MuMinusDef::Get();
+    auto medium = std::make_shared<const StandardRock>();
+    EnergyCutSettings ecuts(500, 0.05);
+
+    BremsKelnerKokoulinPetrukhin param(particle_def, medium, ecuts, 1., true);
+
+    InterpolationDef InterpolDef_quantile;
+    InterpolDef_quantile.quantile_accuracy = 1e-2;
+    InterpolationDef InterpolDef_find_limit;
+
+    BremsInterpolant Brems_quantile(param, InterpolDef_quantile);
+    BremsInterpolant Brems_find_limit(param, InterpolDef_find_limit);
+
+    RandomGenerator::Get().SetSeed(0);
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        double energy = 1e3 * std::pow(1e7, RandomGenerator::Get().RandomDouble());
+        double rnd1   = RandomGenerator::Get().RandomDouble();
+        double rnd2   = RandomGenerator::Get().RandomDouble();
+
+        double loss_quantile   = Brems_quantile.CalculateStochasticLoss(energy, rnd1, rnd2);
+        double loss_find_limit = Brems_find_limit.CalculateStochasticLoss(energy, rnd1, rnd2);
+        double rate            = Brems_quantile.CalculatedNdx(energy);
+
+        EXPECT_NEAR(Brems_quantile.CalculateCumulativeCrossSection(energy, 0, loss_quantile / energy) / rate,
+                    Brems_find_limit.CalculateCumulativeCrossSection(energy, 0, loss_find_limit / energy) / rate,
+                    InterpolDef_quantile.quantile_accuracy);
+    }
+}
+
 int main(int argc, char** argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
@@ -1,6 +1,10 @@
 
 #include "gtest/gtest.h"
+#include "KolmogorovSmirnov.h"
+#include <algorithm>
+#include <cmath>
 #include <fstream>
+#include <thread>
 #include <PROPOSAL/particle/Particle.h>
 
 #include "PROPOSAL/decay/DecayChannel.h"
@@ -921,6 +925,135 @@ TEST(DecaySpectrum, TauMinus_energy){
     in.close();
 }
 
+TEST(DecaySpectrum, Leptonic_Energy_Table){
+    // With tables, the lepton energy is looked up, otherwise the decay rate
+    // is solved for it
+    std::vector<std::pair<ParticleDef, LeptonicDecayChannelApprox*> > channels;
+    channels.push_back(std::make_pair(mu, new LeptonicDecayChannelApprox(EMinusDef::Get(), NuMuDef::Get(), NuEBarDef::Get())));
+    channels.push_back(std::make_pair(tau, new LeptonicDecayChannel(MuMinusDef::Get(), NuTauDef::Get(), NuMuBarDef::Get())));
+    channels.push_back(std::make_pair(tau, new LeptonicDecayChannelApprox(EMinusDef::Get(), NuTauDef::Get(), NuEBarDef::Get())));
+
+    int statistic = 10000;
+
+    for (auto& channel : channels)
+    {
+        const ParticleDef& parent = channel.first;
+        DecayChannel* table = channel.second->clone();
+        table->BuildTables(parent);
+
+        DynamicData parent_condition(parent.particle_type, Vector3D(), Vector3D(0, 0, 1), parent.mass, parent.mass, 0., 0.);
+
+        for (int i = 0; i < statistic; ++i)
+        {
+            RandomGenerator::Get().SetSeed(i);
+            Secondaries products_table = table->Decay(parent, parent_condition);
+            RandomGenerator::Get().SetSeed(i);
+            Secondaries products_exact = channel.second->Decay(parent, parent_condition);
+
+            // the decay rate is solved with an accuracy of 1e-3 in E / E_max,
+            // with E_max about half of the parent mass
+            EXPECT_NEAR(products_table[0].GetEnergy(), products_exact[0].GetEnergy(), 1e-3 * parent.mass);
+        }
+
+        delete table;
+        delete channel.second;
+    }
+}
+
+TEST(DecaySpectrum, ManyBody_Rejection){
+    // With the default matrix element, the candidates are rejected before
+    // their momenta are generated. A constant custom matrix element takes
+    // the generic path, which generates every candidate.
+    ManyBodyPhaseSpace::Builder builder;
+    builder.addDaughter(PiMinusDef::Get()).addDaughter(Pi0Def::Get()).addDaughter(NuTauDef::Get());
+
+    ManyBodyPhaseSpace default_me = builder.build();
+    ManyBodyPhaseSpace constant_me = builder.setMatrixElement(ManyBodyPhaseSpace::DefaultEvaluate).build();
+
+    DynamicData tau_condition(tau.particle_type, Vector3D(), Vector3D(0, 0, 1), tau.mass, tau.mass, 0., 0.);
+
+    int statistic = 20000;
+    std::vector<double> energies_default(statistic), energies_constant(statistic);
+
+    RandomGenerator::Get().SetSeed(1234);
+    for (int i = 0; i < statistic; ++i)
+    {
+        Secondaries products = default_me.Decay(tau, tau_condition);
+        energies_default[i] = products[0].GetEnergy();
+
+        // energy and momentum are conserved
+        double energy = 0;
+        Vector3D momentum(0, 0, 0);
+        for (unsigned int j = 0; j < products.GetNumberOfParticles(); ++j)
+        {
+            energy += products[j].GetEnergy();
+            momentum = momentum + products[j].GetMomentum() * products[j].GetDirection();
+        }
+        EXPECT_NEAR(energy, tau.mass, 1e-9 * tau.mass);
+        EXPECT_NEAR(std::sqrt(momentum * momentum), 0., 1e-9 * tau.mass);
+
+        energies_constant[i] = constant_me.Decay(tau, tau_condition)[0].GetEnergy();
+    }
+
+    EXPECT_LT(KolmogorovSmirnovDistance(energies_default, energies_constant), KolmogorovSmirnovCriticalDistance(statistic));
+
+    // The maximum weight is estimated from its own random stream, so copies
+    // of the channel sample the same decays
+    DecayChannel* copy = constant_me.clone();
+    for (int i = 0; i < 100; ++i)
+    {
+        RandomGenerator::Get().SetSeed(i);
+        double energy = constant_me.Decay(tau, tau_condition)[0].GetEnergy();
+        RandomGenerator::Get().SetSeed(i);
+        EXPECT_EQ(energy, copy->Decay(tau, tau_condition)[0].GetEnergy());
+    }
+    delete copy;
+}
+
+TEST(DecaySpectrum, ManyBody_Parallel){
+    // Threads decaying with a fresh channel look up the maximum weight,
+    // while it is estimated by one of them, and sample the same decays as
+    // a single thread with the same random streams
+    ManyBodyPhaseSpace::Builder builder;
+    builder.addDaughter(PiMinusDef::Get()).addDaughter(Pi0Def::Get()).addDaughter(NuTauDef::Get());
+    builder.setMatrixElement(ManyBodyPhaseSpace::DefaultEvaluate);
+
+    DynamicData tau_condition(tau.particle_type, Vector3D(), Vector3D(0, 0, 1), tau.mass, tau.mass, 0., 0.);
+
+    const int number_of_threads = 4;
+    const int statistic = 1000;
+
+    auto decay = [&tau_condition](DecayChannel& channel, uint64_t event_id, std::vector<double>& energies) {
+        RandomStream stream(7, event_id);
+        RandomStreamScope scope(stream);
+        for (auto& energy : energies)
+        {
+            energy = channel.Decay(tau, tau_condition)[0].GetEnergy();
+        }
+    };
+
+    ManyBodyPhaseSpace reference = builder.build();
+    std::vector<std::vector<double> > expected(number_of_threads, std::vector<double>(statistic));
+    for (int i = 0; i < number_of_threads; ++i)
+    {
+        decay(reference, i, expected[i]);
+    }
+
+    ManyBodyPhaseSpace shared = builder.build();
+    std::vector<std::vector<double> > energies(number_of_threads, std::vector<double>(statistic));
+    std::vector<std::thread> threads;
+    for (int i = 0; i < number_of_threads; ++i)
+    {
+        threads.emplace_back(decay, std::ref(shared), i, std::ref(energies[i]));
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_EQ(energies, expected);
+}
+
 int main(int argc, char** argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
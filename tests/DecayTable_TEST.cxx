@@ -173,6 +173,53 @@ TEST(SelectChannel, Tau)
     EXPECT_TRUE(twobody_count > 0);
 }
 
+TEST(SelectChannel, Branching_Ratios)
+{
+    // The fractions of a uniform grid of random numbers must reproduce the
+    // branching ratios, channels without branching ratio are never selected
+    LeptonicDecayChannel leptonic(EMinusDef::Get(), NuMuDef::Get(), NuEBarDef::Get());
+    TwoBodyPhaseSpace two_body(PiMinusDef::Get(), NuTauDef::Get());
+    StableChannel stable;
+
+    DecayTable table;
+    table.addChannel(0.0, stable);
+    table.addChannel(0.17, leptonic);
+    table.addChannel(0.51, two_body);
+
+    int n              = 100000;
+    int leptonic_count = 0;
+    int twobody_count  = 0;
+    int stable_count   = 0;
+
+    for (int i = 0; i < n; ++i)
+    {
+        DecayChannel& dc = table.SelectChannel((i + 0.5) / n);
+
+        if (dc == leptonic)
+        {
+            leptonic_count++;
+        } else if (dc == two_body)
+        {
+            twobody_count++;
+        } else if (dc == stable)
+        {
+            stable_count++;
+        }
+    }
+
+    EXPECT_EQ(stable_count, 0);
+    EXPECT_EQ(leptonic_count + twobody_count, n);
+    EXPECT_NEAR(static_cast<double>(leptonic_count) / n, 0.17 / 0.68, 1e-4);
+
+    // The selection must not depend on the channel pointers of the original
+    DecayTable copy(table);
+    for (int i = 0; i < 1000; ++i)
+    {
+        double rnd = RandomGenerator::Get().RandomDouble();
+        EXPECT_TRUE(copy.SelectChannel(rnd) == table.SelectChannel(rnd));
+    }
+}
+
 int main(int argc, char** argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
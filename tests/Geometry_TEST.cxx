@@ -9,6 +9,7 @@
 #include "PROPOSAL/geometry/Box.h"
 #include "PROPOSAL/geometry/Cylinder.h"
 #include "PROPOSAL/geometry/Geometry.h"
+#include "PROPOSAL/geometry/GeometryIndex.h"
 #include "PROPOSAL/geometry/Sphere.h"
 #include "PROPOSAL/math/RandomGenerator.h"
 
@@ -1265,6 +1266,78 @@ TEST(DistanceTo, Box)
     }
 }
 
+TEST(GeometryIndex, LinearSearch)
+{
+    // dozens of nested shells and some smaller volumes spread between them
+    std::vector<std::shared_ptr<const Geometry>> geometries;
+    std::vector<int> groups;
+    for (int i = 0; i < 40; ++i) {
+        Sphere shell(Vector3D(), 10 * (i + 1), 10 * i);
+        shell.SetHierarchy(i % 3);
+        geometries.push_back(shell.create());
+        groups.push_back(i % 2);
+    }
+    for (int i = 0; i < 20; ++i) {
+        double x = 300. * std::cos(0.3 * i), y = 300. * std::sin(0.3 * i);
+        if (i % 2 == 0) {
+            Box box(Vector3D(x, y, 5. * i - 50.), 20, 30, 40);
+            box.SetHierarchy(1 + i % 2);
+            geometries.push_back(box.create());
+        } else {
+            Cylinder cylinder(Vector3D(x, y, 5. * i - 50.), 15, 5 * (i % 3), 25);
+            cylinder.SetHierarchy(1 + i % 2);
+            geometries.push_back(cylinder.create());
+        }
+        groups.push_back(i % 3 == 0);
+    }
+
+    GeometryIndex index(geometries, groups);
+    EXPECT_EQ(index.size(), geometries.size());
+
+    Vector3D position, direction;
+    std::vector<int> inside, expected_inside;
+    for (int n = 0; n < 20000; ++n) {
+        double rnd_r = RandomGenerator::Get().RandomDouble();
+        double rnd_theta = RandomGenerator::Get().RandomDouble();
+        double rnd_phi = RandomGenerator::Get().RandomDouble();
+
+        // every tenth particle is placed onto a shell border
+        double radius = 45000. * rnd_r;
+        if (n % 10 == 0)
+            radius = 1000. * std::floor(45. * rnd_r);
+
+        position.SetSphericalCoordinates(radius, rnd_phi * 2 * PI, rnd_theta * PI);
+        position.CalculateCartesianFromSpherical();
+
+        rnd_theta = RandomGenerator::Get().RandomDouble();
+        rnd_phi = RandomGenerator::Get().RandomDouble();
+        direction.SetSphericalCoordinates(1, rnd_phi * 2 * PI, rnd_theta * PI);
+        direction.CalculateCartesianFromSpherical();
+
+        int group = n % 2;
+        unsigned int min_hierarchy = n % 3;
+
+        expected_inside.clear();
+        double expected_distance = 1e20;
+        for (unsigned int i = 0; i < geometries.size(); ++i) {
+            if (groups[i] != group)
+                continue;
+            if (geometries[i]->IsInside(position, direction))
+                expected_inside.push_back(i);
+            if (geometries[i]->GetHierarchy() >= min_hierarchy) {
+                double distance = geometries[i]->DistanceToBorder(position, direction).first;
+                if (distance > 0)
+                    expected_distance = std::min(expected_distance, distance);
+            }
+        }
+
+        index.FindInside(position, direction, group, inside);
+        EXPECT_EQ(inside, expected_inside);
+        EXPECT_EQ(index.DistanceToBorder(position, direction, group, min_hierarchy, 1e20),
+            expected_distance);
+    }
+}
+
 int main(int argc, char** argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
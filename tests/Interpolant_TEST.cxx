@@ -1,7 +1,22 @@
 
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
 #include "gtest/gtest.h"
+#include "PROPOSAL/math/AliasTable.h"
+#include "PROPOSAL/math/FusedInterpolant.h"
 #include "PROPOSAL/math/Interpolant.h"
+#include "PROPOSAL/math/QuantileTable.h"
+#include "PROPOSAL/math/TableFile.h"
+#include "PROPOSAL/math/TablePack.h"
+#include "PROPOSAL/math/TableScheduler.h"
 
 using namespace PROPOSAL;
 
@@ -36,6 +51,8 @@ bool isLog2    = false;
 
 std::string File1DTest = "Interpol1D_Save.txt";
 std::string File2DTest = "Interpol2D_Save.txt";
+std::string FileMappedTest = "Interpol_Mapped.tbl";
+std::string FilePackTest   = "Interpol_Tables.pack";
 
 TEST(Comparison, Comparison_equal)
 {
@@ -159,8 +176,10 @@ TEST(Comparison, Comparison_not_equal)
                                      true);
 
     EXPECT_TRUE(A != *B);
-    EXPECT_TRUE(*B != *C);
     EXPECT_TRUE(*D != *E);
+
+    // Interpolating does not change the table
+    EXPECT_TRUE(*B == *C);
 }
 
 TEST(Assignment, Copyconstructor)
@@ -805,6 +824,453 @@ TEST(_2D_Interpol, All_On)
     delete Pol2;
 }
 
+TEST(Shared, Const_Evaluation)
+{
+    std::shared_ptr<const Interpolant> Pol2 = std::make_shared<Interpolant>(max,
+                                                                            xmin,
+                                                                            xmax,
+                                                                            max2,
+                                                                            x2min,
+                                                                            x2max,
+                                                                            X_YY,
+                                                                            romberg,
+                                                                            rational,
+                                                                            relative,
+                                                                            isLog,
+                                                                            romberg2,
+                                                                            rational2,
+                                                                            relative2,
+                                                                            isLog2,
+                                                                            rombergY,
+                                                                            rationalY,
+                                                                            relativeY,
+                                                                            logSubst);
+    Interpolant Copy(*Pol2);
+
+    int n_points = 1000;
+    std::vector<double> reference(n_points);
+    std::vector<double> reference_limit(n_points);
+
+    for (int i = 0; i < n_points; ++i)
+    {
+        double x1 = xmin + (xmax - xmin) * i / n_points;
+        double x2 = x2min + (x2max - x2min) * i / n_points;
+
+        reference[i]       = Pol2->Interpolate(x1, x2);
+        reference_limit[i] = Pol2->FindLimit(x1, reference[i]);
+    }
+
+    // Evaluation does not touch the table
+    EXPECT_TRUE(*Pol2 == Copy);
+
+    // The same table can be evaluated concurrently
+    std::vector<double> result_a(n_points), result_b(n_points);
+    auto evaluate = [&](std::vector<double>& result) {
+        for (int i = 0; i < n_points; ++i)
+        {
+            double x1 = xmin + (xmax - xmin) * i / n_points;
+            result[i] = Pol2->FindLimit(x1, Pol2->Interpolate(x1, x2min + (x2max - x2min) * i / n_points));
+        }
+    };
+
+    std::thread thread_a(evaluate, std::ref(result_a));
+    std::thread thread_b(evaluate, std::ref(result_b));
+    thread_a.join();
+    thread_b.join();
+
+    for (int i = 0; i < n_points; ++i)
+    {
+        EXPECT_EQ(result_a[i], reference_limit[i]);
+        EXPECT_EQ(result_b[i], reference_limit[i]);
+    }
+}
+
+TEST(Shared, Romberg_Clamped)
+{
+    // The interpolation keeps its scratch on the stack, the orders are
+    // clamped to the maximum it has room for
+    Interpolant Pol1(max, xmin, xmax, X2, romberg, rational, relative, isLog, rombergY, rationalY, relativeY, logSubst);
+    Pol1.SetRomberg(100);
+    Pol1.SetRombergY(100);
+
+    EXPECT_EQ(Pol1.GetRomberg(), 16);
+    EXPECT_EQ(Pol1.GetRombergY(), 16);
+    EXPECT_NEAR(Pol1.Interpolate(7.), X2(7.), 1e-6 * X2(7.));
+    EXPECT_NEAR(Pol1.FindLimit(X2(7.)), 7., 1e-4);
+
+    Pol1.SetRomberg(0);
+    EXPECT_EQ(Pol1.GetRomberg(), 1);
+}
+
+TEST(Fused, Same_As_Single_Tables)
+{
+    std::function<double(double)> functions[] = { X2,
+                                                  [](double x) { return std::log(x) / x; },
+                                                  [](double x) { return -std::sqrt(x); } };
+
+    for (bool rational_on : { false, true })
+    {
+        std::vector<std::shared_ptr<const Interpolant>> tables;
+        std::vector<const Interpolant*> pointers;
+        for (auto& function : functions)
+        {
+            tables.push_back(std::make_shared<Interpolant>(
+                max, xmin, xmax, function, romberg, rational_on, relative, true, rombergY, rationalY, relativeY, false));
+            pointers.push_back(tables.back().get());
+        }
+
+        auto fused = std::make_shared<const FusedInterpolant>(pointers);
+        ASSERT_EQ(fused->GetNumberOfColumns(), 3u);
+
+        FusedInterpolantCache cache(fused);
+        double values[3];
+
+        // includes the nodes and points outside of the table
+        int n_points = 1000;
+        for (int i = 0; i <= n_points; ++i)
+        {
+            double x = std::exp(std::log(0.5 * xmin) + std::log(4 * xmax / xmin) * i / n_points);
+            fused->Interpolate(x, values);
+
+            for (unsigned int j = 0; j < 3; ++j)
+            {
+                EXPECT_EQ(values[j], tables[j]->Interpolate(x));
+                EXPECT_EQ(cache.Interpolate(x, j), values[j]);
+                EXPECT_EQ(cache.Interpolate(xmin, j), tables[j]->Interpolate(xmin));
+            }
+        }
+    }
+}
+
+TEST(Mapped, Same_As_Built_Tables)
+{
+    Interpolant Pol1(max, xmin, xmax, X2, romberg, rational, relative, true, rombergY, rationalY, relativeY, true);
+    Interpolant Pol2(max,
+                     xmin,
+                     xmax,
+                     max2,
+                     x2min,
+                     x2max,
+                     X_YY,
+                     romberg,
+                     true,
+                     relative,
+                     isLog,
+                     romberg2,
+                     rational2,
+                     relative2,
+                     true,
+                     rombergY,
+                     rationalY,
+                     relativeY,
+                     logSubst);
+
+    ASSERT_TRUE(TableFile::Write(FileMappedTest, { &Pol1, &Pol2 }));
+
+    std::shared_ptr<const TableFile> file = TableFile::Map(FileMappedTest);
+    ASSERT_TRUE(file != NULL);
+    ASSERT_EQ(file->GetNumberOfTables(), 2u);
+
+    std::shared_ptr<const Interpolant> Mapped1 = file->GetInterpolant(0);
+    std::shared_ptr<const Interpolant> Mapped2 = file->GetInterpolant(1);
+    file.reset();
+
+    // The tables keep the file mapped
+    EXPECT_TRUE(*Mapped1 == Pol1);
+    EXPECT_TRUE(*Mapped2 == Pol2);
+
+    int n_points = 1000;
+    for (int i = 0; i <= n_points; ++i)
+    {
+        double x1 = xmin + (xmax - xmin) * i / n_points;
+        double x2 = x2min + (x2max - x2min) * i / n_points;
+
+        EXPECT_EQ(Mapped1->Interpolate(x1), Pol1.Interpolate(x1));
+        EXPECT_EQ(Mapped1->FindLimit(X2(x1)), Pol1.FindLimit(X2(x1)));
+        EXPECT_EQ(Mapped2->Interpolate(x1, x2), Pol2.Interpolate(x1, x2));
+        EXPECT_EQ(Mapped2->FindLimit(x1, X_YY(x1, x2)), Pol2.FindLimit(x1, X_YY(x1, x2)));
+    }
+
+    // A changed table no longer reads from the file
+    Interpolant Copy(*Mapped1);
+    Copy.SetRomberg(romberg + 1);
+    Copy.SetIY(Copy.GetIY());
+    EXPECT_TRUE(Copy.GetIX() == Pol1.GetIX());
+    EXPECT_EQ(Copy.Interpolate(7.), Interpolant(max, xmin, xmax, X2, romberg + 1, rational, relative, true, rombergY, rationalY, relativeY, true).Interpolate(7.));
+}
+
+TEST(Mapped, Reject_Invalid_Files)
+{
+    Interpolant Pol1(max, xmin, xmax, X2, romberg, rational, relative, isLog, rombergY, rationalY, relativeY, logSubst);
+    ASSERT_TRUE(TableFile::Write(FileMappedTest, { &Pol1 }));
+
+    std::vector<char> content;
+    {
+        std::ifstream input(FileMappedTest.c_str(), std::ios::binary);
+        content.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    }
+
+    auto write = [](const std::vector<char>& data) {
+        std::ofstream output(FileMappedTest.c_str(), std::ios::binary);
+        output.write(data.data(), data.size());
+    };
+
+    // incomplete file
+    write(std::vector<char>(content.begin(), content.end() - 8));
+    EXPECT_TRUE(TableFile::Map(FileMappedTest) == NULL);
+
+    // other version
+    std::vector<char> other_version(content);
+    other_version[8] += 1;
+    write(other_version);
+    EXPECT_TRUE(TableFile::Map(FileMappedTest) == NULL);
+
+    // record outside of the file
+    std::vector<char> invalid_offset(content);
+    invalid_offset[64 + 7] = 1;
+    write(invalid_offset);
+    EXPECT_TRUE(TableFile::Map(FileMappedTest) == NULL);
+
+    // number of tables whose offsets overflow the size of the file
+    std::vector<char> overflowing_number(content);
+    overflowing_number[24 + 7] = 0x20;
+    write(overflowing_number);
+    EXPECT_TRUE(TableFile::Map(FileMappedTest) == NULL);
+
+    // wrong checksum of the index
+    std::vector<char> corrupt(content);
+    corrupt[32] ^= 1;
+    write(corrupt);
+    EXPECT_TRUE(TableFile::Map(FileMappedTest) == NULL);
+
+    // changed value, found when the table is used
+    std::vector<char> changed_value(content);
+    changed_value[content.size() - 64] ^= 1;
+    write(changed_value);
+    std::shared_ptr<const TableFile> changed_file = TableFile::Map(FileMappedTest);
+    ASSERT_TRUE(changed_file != NULL);
+    EXPECT_TRUE(changed_file->GetInterpolant(0) == NULL);
+    EXPECT_TRUE(changed_file->GetInterpolant(0) == NULL);
+    changed_file.reset();
+
+    write(content);
+    EXPECT_TRUE(TableFile::Map(FileMappedTest) != NULL);
+
+    // 2d tables from arrays keep their values and are not written
+    std::vector<double> x2 = { 1, 2, 3, 4, 5, 6 };
+    std::vector<std::vector<double> > y2(Pol1.GetIX().size(), x2);
+    Interpolant Array(Pol1.GetIX(), x2, y2, romberg, rational, relative, romberg, rational, relative);
+    EXPECT_FALSE(TableFile::Write(FileMappedTest, { &Array }));
+
+    std::remove(FileMappedTest.c_str());
+}
+
+TEST(Pack, Append_Merge_Prune)
+{
+    Interpolant Pol1(max, xmin, xmax, X2, romberg, rational, relative, isLog, rombergY, rationalY, relativeY, logSubst);
+    Interpolant Pol2(max,
+                     xmin,
+                     xmax,
+                     max2,
+                     x2min,
+                     x2max,
+                     X_YY,
+                     romberg,
+                     rational,
+                     relative,
+                     isLog,
+                     romberg2,
+                     rational2,
+                     relative2,
+                     isLog2,
+                     rombergY,
+                     rationalY,
+                     relativeY,
+                     logSubst);
+
+    std::string merged = "Merged_" + FilePackTest;
+    std::remove(FilePackTest.c_str());
+    std::remove(merged.c_str());
+
+    EXPECT_TRUE(TablePack::Open(FilePackTest) == NULL);
+
+    ASSERT_TRUE(TablePack::Append(FilePackTest, "first_1", { &Pol1 }));
+    ASSERT_TRUE(TablePack::Append(FilePackTest, "second_2", { &Pol2, &Pol1 }));
+
+    // A key is only stored once
+    ASSERT_TRUE(TablePack::Append(FilePackTest, "first_1", { &Pol2 }));
+
+    std::shared_ptr<const TablePack> pack = TablePack::Open(FilePackTest);
+    ASSERT_TRUE(pack != NULL);
+    EXPECT_EQ(pack->GetKeys(), std::vector<std::string>({ "first_1", "second_2" }));
+    EXPECT_TRUE(pack->Find("third_3") == NULL);
+
+    std::shared_ptr<const TableFile> second = pack->Find("second_2");
+    ASSERT_TRUE(second != NULL);
+    ASSERT_EQ(second->GetNumberOfTables(), 2u);
+    EXPECT_TRUE(*pack->Find("first_1")->GetInterpolant(0) == Pol1);
+    EXPECT_TRUE(*second->GetInterpolant(0) == Pol2);
+    EXPECT_TRUE(*second->GetInterpolant(1) == Pol1);
+
+    // An incomplete entry at the end is ignored and overwritten
+    size_t size = pack->GetSize();
+    {
+        std::ofstream output(FilePackTest.c_str(), std::ios::binary | std::ios::app);
+        output << "PROPENTR incomplete";
+    }
+    EXPECT_EQ(TablePack::Open(FilePackTest)->GetKeys().size(), 2u);
+    ASSERT_TRUE(TablePack::Append(FilePackTest, "third_3", { &Pol1 }));
+    EXPECT_EQ(TablePack::Open(FilePackTest)->GetKeys().size(), 3u);
+    EXPECT_TRUE(*TablePack::Open(FilePackTest)->Find("third_3")->GetInterpolant(0) == Pol1);
+
+    ASSERT_TRUE(TablePack::Merge(merged, { FilePackTest }));
+    EXPECT_EQ(TablePack::Open(merged)->GetKeys(), TablePack::Open(FilePackTest)->GetKeys());
+
+    ASSERT_TRUE(TablePack::Prune(merged, { "first", "third" }));
+    EXPECT_EQ(TablePack::Open(merged)->GetKeys(), std::vector<std::string>({ "second_2" }));
+    EXPECT_TRUE(*TablePack::Open(merged)->Find("second_2")->GetInterpolant(0) == Pol2);
+
+    // The tables of the replaced pack stay readable
+    EXPECT_EQ(pack->GetSize(), size);
+    EXPECT_TRUE(*second->GetInterpolant(0) == Pol2);
+
+    std::remove(FilePackTest.c_str());
+    std::remove(merged.c_str());
+    std::remove((FilePackTest + ".lock").c_str());
+    std::remove((merged + ".lock").c_str());
+}
+
+TEST(Quantile, Truncated_Exponential)
+{
+    // density exp(-a v) on [0, 1] with a = log(x)
+    auto cdf = [](double x, double v) {
+        double a = std::log(x);
+        return (1 - std::exp(-a * v)) / (1 - std::exp(-a));
+    };
+    auto quantile = [](double x, double u) {
+        double a = std::log(x);
+        return -std::log(1 - u * (1 - std::exp(-a))) / a;
+    };
+
+    for (double accuracy : { 1e-2, 1e-3, 1e-4 })
+    {
+        QuantileTable table(10, 2., 1e6, 10, quantile, cdf, accuracy, true);
+        EXPECT_LE(table.GetAccuracy(), accuracy);
+
+        QuantileTable table_copy(10, 2., 1e6, 10, quantile, cdf, accuracy, true);
+        EXPECT_TRUE(table == table_copy);
+
+        for (int i = 0; i <= 100; ++i)
+        {
+            double x = 2. * std::pow(5e5, i / 100.);
+
+            EXPECT_NEAR(table.Interpolate(x, 0.), 0., 1e-9);
+            EXPECT_NEAR(table.Interpolate(x, 1.), 1., 1e-9);
+
+            for (int j = 1; j < 100; ++j)
+            {
+                double u = j / 100.;
+                EXPECT_NEAR(cdf(x, table.Interpolate(x, u)), u, 2 * accuracy);
+            }
+        }
+    }
+}
+
+TEST(Alias, Frequencies)
+{
+    std::vector<double> weights = { 0.5, 3., 0., 1e-3, 2., 0.25, 7. };
+    double sum = 0;
+    for (double weight : weights)
+        sum += weight;
+
+    AliasTable table(weights);
+    EXPECT_EQ(table.GetSize(), weights.size());
+    EXPECT_TRUE(table == AliasTable(weights));
+
+    // Each index covers a fraction of the random numbers equal to its weight
+    int samples = 1000000;
+    std::vector<int> counts(weights.size(), 0);
+    for (int i = 0; i < samples; ++i)
+    {
+        counts[table.Sample((i + 0.5) / samples)]++;
+    }
+
+    for (unsigned int i = 0; i < weights.size(); ++i)
+    {
+        EXPECT_NEAR(static_cast<double>(counts[i]) / samples, weights[i] / sum, 1e-5);
+    }
+
+    EXPECT_LT(table.Sample(0.), weights.size());
+    EXPECT_LT(table.Sample(std::nextafter(1., 0.)), weights.size());
+}
+
+TEST(Scheduler, Dependencies)
+{
+    // Chain 0 -> 1 -> 2 with independent jobs 3..9 and job 10 after all
+    std::mutex mutex;
+    std::vector<int> order;
+    auto job = [&mutex, &order](int i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        std::lock_guard<std::mutex> lock(mutex);
+        order.push_back(i);
+    };
+
+    for (unsigned int n_threads : { 1u, 4u, 0u })
+    {
+        order.clear();
+
+        TableScheduler scheduler(n_threads);
+        EXPECT_GE(scheduler.GetNumberOfThreads(), 1u);
+
+        std::vector<TableScheduler::Job> all;
+        TableScheduler::Job previous = scheduler.Add(std::bind(job, 0));
+        all.push_back(previous);
+        for (int i = 1; i < 3; ++i)
+        {
+            previous = scheduler.Add(std::bind(job, i), { previous });
+            all.push_back(previous);
+        }
+        for (int i = 3; i < 10; ++i)
+        {
+            all.push_back(scheduler.Add(std::bind(job, i)));
+        }
+        scheduler.Add(std::bind(job, 10), all);
+        scheduler.Run();
+
+        ASSERT_EQ(order.size(), 11u);
+        auto position = [&order](int i) { return std::find(order.begin(), order.end(), i) - order.begin(); };
+        EXPECT_LT(position(0), position(1));
+        EXPECT_LT(position(1), position(2));
+        EXPECT_EQ(position(10), 10);
+
+        if (n_threads == 1)
+        {
+            for (int i = 0; i < 11; ++i)
+            {
+                EXPECT_EQ(order[i], i);
+            }
+        }
+    }
+}
+
+TEST(Scheduler, Exception)
+{
+    TableScheduler scheduler(3);
+    bool dependent_started = false;
+
+    TableScheduler::Job failing = scheduler.Add([]() { throw std::runtime_error("table failed"); });
+    scheduler.Add([&dependent_started]() { dependent_started = true; }, { failing });
+
+    EXPECT_THROW(scheduler.Run(), std::runtime_error);
+    EXPECT_FALSE(dependent_started);
+
+    // The scheduler is empty afterwards and can be used again
+    bool started = false;
+    scheduler.Add([&started]() { started = true; });
+    scheduler.Run();
+    EXPECT_TRUE(started);
+}
+
 int main(int argc, char** argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
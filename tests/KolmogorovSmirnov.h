@@ -0,0 +1,31 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Kolmogorov-Smirnov distance of two samples of the same size
+inline double KolmogorovSmirnovDistance(std::vector<double> sample1, std::vector<double> sample2)
+{
+    std::sort(sample1.begin(), sample1.end());
+    std::sort(sample2.begin(), sample2.end());
+
+    double distance = 0;
+    size_t i = 0, j = 0;
+    while (i < sample1.size() && j < sample2.size())
+    {
+        if (sample1[i] < sample2[j])
+            ++i;
+        else
+            ++j;
+        distance = std::max(distance, std::abs(double(i) - double(j)) / sample1.size());
+    }
+    return distance;
+}
+
+// Distance above which two samples of the given size are from different
+// distributions at a significance level of 1%
+inline double KolmogorovSmirnovCriticalDistance(int sample_size)
+{
+    return 1.63 * std::sqrt(2. / sample_size);
+}
@@ -8,6 +8,7 @@
 #include "PROPOSAL/crossection/factories/PhotonuclearFactory.h"
 #include "PROPOSAL/crossection/parametrization/PhotoQ2Integration.h"
 #include "PROPOSAL/crossection/parametrization/PhotoRealPhotonAssumption.h"
+#include "PROPOSAL/math/Integral.h"
 #include "PROPOSAL/math/RandomGenerator.h"
 #include "PROPOSAL/medium/Medium.h"
 #include "PROPOSAL/medium/MediumFactory.h"
@@ -954,6 +955,44 @@ TEST(PhotoQ2Integration, Test_of_e_Interpolant)
     }
 }
 
+TEST(PhotoRealPhotonAssumption, Test_of_dNdx_Table)
+{
+    // The 2d dNdx table is integrated cumulative in v, so it has to agree
+    // with a precise integration from the lower limit up to the top of the
+    // table. Energies close to the threshold are left out.
+    ParticleDef particle_def = MuMinusDef::Get();
+    auto medium = std::make_shared<const StandardRock>();
+    EnergyCutSettings ecuts(500, 0.05);
+
+    PhotoKokoulin param(particle_def, medium, ecuts, 1., true);
+
+    InterpolationDef InterpolDef;
+    PhotoInterpolant Photo_Interpolant(param, InterpolDef);
+
+    Integral integral(IROMB, IMAXS, 1e-3 * IPREC);
+    int nodes = InterpolDef.nodes_cross_section;
+
+    for (int i : {30, 50, 70, 99})
+    {
+        double energy = particle_def.mass * std::pow(InterpolDef.max_node_energy / particle_def.mass, i / (nodes - 1.));
+
+        param.SetCurrentComponent(0);
+        Parametrization::IntegralLimits limits = param.GetIntegralLimits(energy);
+        auto dndx = std::bind(&Parametrization::FunctionToDNdxIntegral, &param, energy, std::placeholders::_1);
+
+        double total = integral.Integrate(limits.vUp, limits.vMax, dndx, 4);
+
+        for (int j : {10, 50, 90, 99})
+        {
+            double v = limits.vUp * std::pow(limits.vMax / limits.vUp, j / (nodes - 1.));
+
+            EXPECT_NEAR(Photo_Interpolant.CalculateCumulativeCrossSection(energy, 0, v),
+                        integral.Integrate(limits.vUp, v, dndx, 4),
+                        1e-3 * total);
+        }
+    }
+}
+
 int main(int argc, char** argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
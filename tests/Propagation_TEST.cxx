@@ -8,6 +8,41 @@
 
 using namespace PROPOSAL;
 
+// Sector inside the detector, a sphere of 1 km around the origin
+Sector::Definition MakeSectorDefinition(const Medium& medium, ScatteringFactory::Enum scattering)
+{
+    Sector::Definition sector_def;
+    sector_def.location = Sector::ParticleLocation::InsideDetector;
+    sector_def.SetMedium(std::make_shared<Medium>(medium));
+    sector_def.SetGeometry(Sphere(Vector3D(), 1e5, 0).create());
+    sector_def.scattering_model = scattering;
+    sector_def.cut_settings     = EnergyCutSettings(500, 0.05);
+
+    return sector_def;
+}
+
+// Muon moving down the z axis
+DynamicData MakeMuon(double energy, const Vector3D& position)
+{
+    DynamicData mu(MuMinusDef::Get().particle_type);
+    mu.SetEnergy(energy);
+    mu.SetPosition(position);
+    mu.SetDirection(Vector3D(0, 0, -1));
+
+    return mu;
+}
+
+// Muons of 10 to 200 GeV starting at the origin
+std::vector<DynamicData> MakeMuons()
+{
+    std::vector<DynamicData> particles;
+    for (int i = 0; i < 20; ++i) {
+        particles.push_back(MakeMuon(1e4 * (i + 1), Vector3D(0, 0, 0)));
+    }
+
+    return particles;
+}
+
 TEST(Comparison, Comparison_equal)
 {
     Sector::Definition sector_def;
@@ -173,6 +208,175 @@ TEST(Propagation, Test_nan)
     }
 }
 
+TEST(Propagation, PropagateBatch)
+{
+    Sector::Definition sector_def = MakeSectorDefinition(Water(), ScatteringFactory::Moliere);
+    sector_def.do_continuous_randomization = true;
+
+    std::vector<Sector::Definition> sec_defs(1, sector_def);
+
+    InterpolationDef interpolation_def;
+    Propagator prop(MuMinusDef::Get(), sec_defs, Sphere(Vector3D(), 1e3, 0).create(), interpolation_def);
+
+    std::vector<DynamicData> particles = MakeMuons();
+
+    uint64_t seed = 42;
+    std::vector<Secondaries> serial = prop.PropagateBatch(particles, 1, seed, 100, 1e4);
+    std::vector<Secondaries> parallel = prop.PropagateBatch(particles, 3, seed, 100, 1e4);
+
+    ASSERT_EQ(serial.size(), particles.size());
+    ASSERT_EQ(parallel.size(), particles.size());
+
+    for (size_t i = 0; i < particles.size(); ++i) {
+        // the result only depends on the event, not on the thread
+        RandomStream random_stream(seed, 100 + i);
+        Secondaries single = prop.Propagate(particles[i], random_stream, 1e4);
+
+        ASSERT_EQ(single.GetNumberOfParticles(), serial[i].GetNumberOfParticles());
+        ASSERT_EQ(single.GetNumberOfParticles(), parallel[i].GetNumberOfParticles());
+        EXPECT_EQ(single.GetEnergy(), serial[i].GetEnergy());
+        EXPECT_EQ(single.GetEnergy(), parallel[i].GetEnergy());
+    }
+}
+
+TEST(Propagation, PropagateWavefront)
+{
+    Sector::Definition sector_def = MakeSectorDefinition(Water(), ScatteringFactory::Moliere);
+    sector_def.do_continuous_randomization      = true;
+    sector_def.do_continuous_energy_loss_output = true;
+
+    // a second sector, so particles change the sector while propagating
+    Sector::Definition sector_def_2 = sector_def;
+    sector_def_2.SetMedium(std::make_shared<Medium>(StandardRock()));
+    sector_def_2.SetGeometry(Sphere(Vector3D(0, 0, -3e3), 1e3, 0).create());
+
+    std::vector<Sector::Definition> sec_defs;
+    sec_defs.push_back(sector_def);
+    sec_defs.push_back(sector_def_2);
+
+    InterpolationDef interpolation_def;
+    Propagator prop(MuMinusDef::Get(), sec_defs, Sphere(Vector3D(), 1e3, 0).create(), interpolation_def);
+
+    std::vector<DynamicData> particles = MakeMuons();
+
+    uint64_t seed = 7;
+    std::vector<Secondaries> scalar = prop.PropagateBatch(particles, 1, seed, 0, 5e3);
+    std::vector<Secondaries> wavefront = prop.PropagateWavefront(particles, seed, 0, 5e3);
+
+    ASSERT_EQ(wavefront.size(), particles.size());
+
+    for (size_t i = 0; i < particles.size(); ++i) {
+        ASSERT_EQ(scalar[i].GetNumberOfParticles(), wavefront[i].GetNumberOfParticles());
+        for (unsigned int j = 0; j < scalar[i].GetNumberOfParticles(); ++j) {
+            EXPECT_EQ(scalar[i][j], wavefront[i][j]);
+        }
+    }
+}
+
+TEST(Propagation, LossSink)
+{
+    Sector::Definition sector_def = MakeSectorDefinition(Water(), ScatteringFactory::Moliere);
+    sector_def.do_continuous_energy_loss_output = true;
+
+    std::vector<Sector::Definition> sec_defs(1, sector_def);
+
+    InterpolationDef interpolation_def;
+    Propagator prop(MuMinusDef::Get(), sec_defs, Sphere(Vector3D(), 1e3, 0).create(), interpolation_def);
+
+    DynamicData mu = MakeMuon(1e5, Vector3D(0, 0, 0));
+
+    for (uint64_t event_id = 0; event_id < 10; ++event_id) {
+        Secondaries secondaries;
+        {
+            RandomStream stream(3, event_id);
+            RandomStreamScope scope(stream);
+            secondaries = prop.Propagate(mu, 5e3);
+        }
+
+        std::vector<DynamicData> losses;
+        LossFunctionSink::Function function = [&losses](const DynamicData& loss) { losses.push_back(loss); };
+        DynamicData final_state;
+        {
+            RandomStream stream(3, event_id);
+            RandomStreamScope scope(stream);
+            final_state = prop.Propagate(mu, function, 5e3);
+        }
+
+        ASSERT_EQ(secondaries.GetNumberOfParticles(), losses.size());
+        for (size_t i = 0; i < losses.size(); ++i) {
+            EXPECT_EQ(secondaries[i], losses[i]);
+        }
+        EXPECT_EQ(secondaries.back(), final_state);
+    }
+}
+
+TEST(Propagation, CrossingPlan)
+{
+    Sector::Definition sector_def = MakeSectorDefinition(Ice(), ScatteringFactory::NoScattering);
+
+    // nested layers and a volume with a higher hierarchy on the track
+    std::vector<Sector::Definition> sec_defs;
+    sec_defs.push_back(sector_def);
+    for (int i = 1; i < 5; ++i) {
+        Sector::Definition layer = sector_def;
+        layer.SetMedium(std::make_shared<Medium>(i % 2 ? Medium(StandardRock()) : Medium(Water())));
+        layer.SetGeometry(Sphere(Vector3D(), 10 * i, 10 * (i - 1)).create());
+        sec_defs.push_back(layer);
+    }
+    Sector::Definition block = sector_def;
+    block.SetMedium(std::make_shared<Medium>(Iron()));
+    Box box(Vector3D(0, 0, -25), 5, 5, 5);
+    box.SetHierarchy(1);
+    block.SetGeometry(box.create());
+    sec_defs.push_back(block);
+
+    // a denser volume of the same hierarchy across two layer borders, whose
+    // borders end the steps although the sector does not change
+    Sector::Definition overlap = sector_def;
+    overlap.SetMedium(std::make_shared<Medium>(Iron()));
+    overlap.SetGeometry(Box(Vector3D(0, 0, -15), 12, 12, 12).create());
+    sec_defs.push_back(overlap);
+
+    std::vector<Sector::Definition> all_sec_defs;
+    for (auto location : { Sector::ParticleLocation::InfrontDetector,
+             Sector::ParticleLocation::InsideDetector,
+             Sector::ParticleLocation::BehindDetector }) {
+        for (auto def : sec_defs) {
+            def.location = location;
+            all_sec_defs.push_back(def);
+        }
+    }
+
+    InterpolationDef interpolation_def;
+    Propagator prop(MuMinusDef::Get(), all_sec_defs, Sphere(Vector3D(), 20, 0).create(), interpolation_def);
+    Propagator prop_plan(prop);
+    prop_plan.SetCrossingPlan(true);
+
+    DynamicData mu = MakeMuon(1e6, Vector3D(0, 0, 3e3));
+
+    for (uint64_t event_id = 0; event_id < 20; ++event_id) {
+        RandomStream stream(11, event_id);
+        Secondaries secondaries = prop.Propagate(mu, stream, 6e3);
+        RandomStream stream_plan(11, event_id);
+        Secondaries secondaries_plan = prop_plan.Propagate(mu, stream_plan, 6e3);
+
+        ASSERT_EQ(secondaries.GetNumberOfParticles(), secondaries_plan.GetNumberOfParticles());
+        for (unsigned int i = 0; i < secondaries.GetNumberOfParticles(); ++i) {
+            EXPECT_EQ(secondaries[i].GetType(), secondaries_plan[i].GetType());
+            EXPECT_NEAR(secondaries[i].GetEnergy(), secondaries_plan[i].GetEnergy(),
+                1e-6 * secondaries[i].GetEnergy());
+            EXPECT_NEAR(secondaries[i].GetPropagatedDistance(),
+                secondaries_plan[i].GetPropagatedDistance(), 1e-6);
+        }
+        EXPECT_NEAR(secondaries.GetEntryPoint().GetPropagatedDistance(),
+            secondaries_plan.GetEntryPoint().GetPropagatedDistance(), 1e-6);
+        EXPECT_NEAR(secondaries.GetClosestApproachPoint().GetPropagatedDistance(),
+            secondaries_plan.GetClosestApproachPoint().GetPropagatedDistance(), 1e-6);
+        EXPECT_NEAR(secondaries.GetExitPoint().GetPropagatedDistance(),
+            secondaries_plan.GetExitPoint().GetPropagatedDistance(), 1e-6);
+    }
+}
+
 TEST(Propagation, particle_type)
 {
     std::string filename = "bin/TestFiles/Propagator_propagation.txt";
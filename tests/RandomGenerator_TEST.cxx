@@ -0,0 +1,109 @@
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "PROPOSAL/math/RandomGenerator.h"
+
+using namespace PROPOSAL;
+
+TEST(RandomStream, Philox_known_answer)
+{
+    // Known answer tests of the Random123 reference implementation
+    RandomStream::Counter zero_counter = { { 0, 0, 0, 0 } };
+    RandomStream::Key zero_key         = { { 0, 0 } };
+    RandomStream::Counter result       = RandomStream::Philox4x32(zero_counter, zero_key);
+
+    EXPECT_EQ(result[0], 0x6627e8d5u);
+    EXPECT_EQ(result[1], 0xe169c58du);
+    EXPECT_EQ(result[2], 0xbc57ac4cu);
+    EXPECT_EQ(result[3], 0x9b00dbd8u);
+
+    RandomStream::Counter pi_counter = { { 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 } };
+    RandomStream::Key pi_key         = { { 0xa4093822, 0x299f31d0 } };
+    result                           = RandomStream::Philox4x32(pi_counter, pi_key);
+
+    EXPECT_EQ(result[0], 0xd16cfe09u);
+    EXPECT_EQ(result[1], 0x94fdccebu);
+    EXPECT_EQ(result[2], 0x5001e420u);
+    EXPECT_EQ(result[3], 0x24126ea1u);
+}
+
+TEST(RandomStream, Range_and_mean)
+{
+    RandomStream stream(1234, 0);
+
+    int n      = 1000000;
+    double sum = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        double rnd = stream.RandomDouble();
+        ASSERT_GE(rnd, 0.);
+        ASSERT_LT(rnd, 1.);
+        sum += rnd;
+    }
+
+    EXPECT_NEAR(sum / n, 0.5, 5 * std::sqrt(1. / 12 / n));
+}
+
+TEST(RandomStream, Reproducible_per_event)
+{
+    RandomStream first(42, 7);
+    RandomStream second(42, 7);
+    RandomStream other_event(42, 8);
+    RandomStream other_seed(43, 7);
+
+    int equal_event = 0;
+    int equal_seed  = 0;
+    for (int i = 0; i < 1000; ++i)
+    {
+        double rnd = first.RandomDouble();
+        EXPECT_EQ(rnd, second.RandomDouble());
+        equal_event += (rnd == other_event.RandomDouble());
+        equal_seed += (rnd == other_seed.RandomDouble());
+    }
+    EXPECT_EQ(equal_event, 0);
+    EXPECT_EQ(equal_seed, 0);
+
+    first.Reset(42, 7);
+    second.Reset(42, 7);
+    EXPECT_EQ(first.RandomDouble(), second.RandomDouble());
+}
+
+TEST(RandomGenerator, Thread_stream)
+{
+    RandomStream reference(5, 3);
+    std::vector<double> expected(100);
+    for (auto& rnd : expected)
+    {
+        rnd = reference.RandomDouble();
+    }
+
+    auto draw = [](uint64_t event_id, std::vector<double>& result) {
+        RandomStream stream(5, event_id);
+        RandomStreamScope scope(stream);
+        for (auto& rnd : result)
+        {
+            rnd = RandomGenerator::Get().RandomDouble();
+        }
+    };
+
+    std::vector<double> result_a(100), result_b(100);
+    std::thread thread_a(draw, 3, std::ref(result_a));
+    std::thread thread_b(draw, 3, std::ref(result_b));
+    thread_a.join();
+    thread_b.join();
+
+    EXPECT_EQ(result_a, expected);
+    EXPECT_EQ(result_b, expected);
+
+    // without a stream the global generator is used again
+    EXPECT_TRUE(RandomGenerator::GetThreadStream() == NULL);
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -1,8 +1,12 @@
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 
 #include "gtest/gtest.h"
+#include "KolmogorovSmirnov.h"
 
+#include "PROPOSAL/Constants.h"
 #include "PROPOSAL/math/RandomGenerator.h"
 #include "PROPOSAL/medium/Medium.h"
 #include "PROPOSAL/medium/MediumFactory.h"
@@ -214,6 +218,110 @@ TEST(Scattering, Scatter)
     }
 }
 
+TEST(Scattering, Moliere_Quantile_Table)
+{
+    ParticleDef mu = MuMinusDef::Get();
+    InterpolationDef interpolation_def;
+    interpolation_def.quantile_accuracy = 1e-3;
+
+    // With one component, the table maps the random numbers like the exact
+    // solution, so the samples differ by the accuracy of the table only.
+    // With several components, the samples agree within the statistical
+    // fluctuations.
+    std::shared_ptr<const Medium> media[] = { std::make_shared<const StandardRock>(), std::make_shared<const Ice>() };
+
+    for (const auto& medium : media)
+    {
+        ScatteringMoliere table(mu, medium, interpolation_def);
+        ScatteringMoliere exact(mu, medium);
+        EXPECT_TRUE(table != exact);
+
+        const int statistics = 50000;
+        std::vector<double> angles_table(statistics), angles_exact(statistics), angles_other(statistics);
+
+        RandomGenerator::Get().SetSeed(1234);
+        for (double distance : { 1., 1e4 })
+        {
+            for (int i = 0; i < statistics; ++i)
+            {
+                double rnd[4];
+                for (double& r : rnd)
+                    r = RandomGenerator::Get().RandomDouble();
+
+                angles_table[i] = table.Scatter(distance, 1e5, 9e4, Vector3D(), Vector3D(0, 0, 1), rnd[0], rnd[1], rnd[2], rnd[3]).n_i_.GetX();
+                angles_exact[i] = exact.Scatter(distance, 1e5, 9e4, Vector3D(), Vector3D(0, 0, 1), rnd[0], rnd[1], rnd[2], rnd[3]).n_i_.GetX();
+                angles_other[i] = exact.Scatter(distance, 1e5, 9e4, Vector3D(), Vector3D(0, 0, 1)).n_i_.GetX();
+            }
+
+            if (medium->GetNumComponents() == 1)
+            {
+                EXPECT_LT(KolmogorovSmirnovDistance(angles_table, angles_exact), 2 * interpolation_def.quantile_accuracy);
+            }
+            EXPECT_LT(KolmogorovSmirnovDistance(angles_table, angles_other), KolmogorovSmirnovCriticalDistance(statistics) + interpolation_def.quantile_accuracy);
+        }
+    }
+}
+
+TEST(Scattering, Scatter_Batch)
+{
+    ParticleDef mu = MuMinusDef::Get();
+    std::shared_ptr<const Medium> medium = std::make_shared<const Ice>();
+    EnergyCutSettings ecuts(500, 0.05);
+    Utility utility(mu, medium, ecuts, Utility::Definition(), InterpolationDef());
+
+    std::string parametrizations[] = { "Highland", "HighlandIntegral", "Moliere", "NoScattering" };
+
+    const size_t statistics = 1000;
+    std::vector<double> distance(statistics), energy_init(statistics), energy_final(statistics);
+    std::vector<Vector3D> position_init(statistics), direction_init(statistics);
+
+    RandomGenerator::Get().SetSeed(1234);
+    for (size_t i = 0; i < statistics; ++i)
+    {
+        // every tenth particle does not move
+        distance[i]     = i % 10 == 0 ? 0. : std::pow(10., 6. * RandomGenerator::Get().RandomDouble() - 1.);
+        energy_init[i]  = std::pow(10., 3. + 6. * RandomGenerator::Get().RandomDouble());
+        energy_final[i] = energy_init[i] * (1. - 0.5 * RandomGenerator::Get().RandomDouble());
+
+        position_init[i] = Vector3D(1e3 * RandomGenerator::Get().RandomDouble(), 0., -1e3);
+        direction_init[i].SetSphericalCoordinates(1., 2. * PI * RandomGenerator::Get().RandomDouble(), PI * RandomGenerator::Get().RandomDouble());
+        direction_init[i].CalculateCartesianFromSpherical();
+    }
+    direction_init[1] = Vector3D(0, 0, 1);
+    direction_init[2] = Vector3D(0, 0, -1);
+
+    for (const std::string& parametrization : parametrizations)
+    {
+        Scattering* scattering = ScatteringFactory::Get().CreateScattering(parametrization, mu, utility, InterpolationDef());
+
+        std::vector<Vector3D> position(position_init), direction(direction_init);
+        std::vector<RandomStream> streams, streams_batch;
+        std::vector<RandomStream*> stream_pointers;
+        for (size_t i = 0; i < statistics; ++i)
+        {
+            streams.push_back(RandomStream(1234, i));
+            streams_batch.push_back(RandomStream(1234, i));
+        }
+        for (RandomStream& stream : streams_batch)
+            stream_pointers.push_back(&stream);
+
+        scattering->Scatter(statistics, distance.data(), energy_init.data(), energy_final.data(), position.data(), direction.data(), stream_pointers.data());
+
+        // The batch gives exactly the results of the single particle Scatter
+        for (size_t i = 0; i < statistics; ++i)
+        {
+            RandomStreamScope scope(streams[i]);
+            Directions directions = scattering->Scatter(distance[i], energy_init[i], energy_final[i], position_init[i], direction_init[i]);
+
+            EXPECT_TRUE(position[i] == position_init[i] + distance[i] * directions.u_) << parametrization << " " << i;
+            EXPECT_TRUE(direction[i] == directions.n_i_) << parametrization << " " << i;
+            EXPECT_EQ(streams[i].RandomDouble(), streams_batch[i].RandomDouble());
+        }
+
+        delete scattering;
+    }
+}
+
 int main(int argc, char** argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
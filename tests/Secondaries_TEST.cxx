@@ -0,0 +1,181 @@
+#include <cmath>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "PROPOSAL/Secondaries.h"
+
+using namespace PROPOSAL;
+
+namespace {
+
+DynamicData MakeLoss(int i)
+{
+    Vector3D direction(0, std::sin(0.1 * i), std::cos(0.1 * i));
+    direction.CalculateSphericalCoordinates();
+
+    return DynamicData(static_cast<int>(InteractionType::Brems),
+        Vector3D(i, 2. * i, 3. * i), direction, 100. + i, 200. + i, 1e-9 * i, 10. * i);
+}
+
+} // namespace
+
+TEST(Columns, Roundtrip)
+{
+    Secondaries secondaries;
+
+    for (int i = 0; i < 100; ++i)
+        secondaries.push_back(MakeLoss(i));
+
+    ASSERT_EQ(secondaries.GetNumberOfParticles(), 100u);
+
+    for (int i = 0; i < 100; ++i)
+        EXPECT_EQ(secondaries[i], MakeLoss(i));
+
+    EXPECT_EQ(secondaries.back(), MakeLoss(99));
+}
+
+TEST(Columns, Views)
+{
+    Secondaries secondaries;
+
+    for (int i = 0; i < 50; ++i)
+        secondaries.push_back(MakeLoss(i));
+
+    ColumnView<double> energy = secondaries.GetColumn(Secondaries::Energy);
+    ColumnView<double> z      = secondaries.GetColumn(Secondaries::Z);
+    ColumnView<int> type      = secondaries.GetTypeColumn();
+
+    ASSERT_EQ(energy.size(), 50u);
+    ASSERT_EQ(type.size(), 50u);
+
+    for (int i = 0; i < 50; ++i)
+    {
+        EXPECT_EQ(energy[i], 100. + i);
+        EXPECT_EQ(z[i], 3. * i);
+        EXPECT_EQ(type[i], static_cast<int>(InteractionType::Brems));
+    }
+
+    EXPECT_EQ(secondaries.GetEnergy(), std::vector<double>(energy.begin(), energy.end()));
+}
+
+TEST(Columns, Append_and_reuse)
+{
+    Secondaries a, b;
+
+    for (int i = 0; i < 30; ++i)
+        a.push_back(MakeLoss(i));
+    for (int i = 30; i < 70; ++i)
+        b.push_back(MakeLoss(i));
+
+    a.append(b);
+
+    ASSERT_EQ(a.GetNumberOfParticles(), 70u);
+    for (int i = 0; i < 70; ++i)
+        EXPECT_EQ(a[i], MakeLoss(i));
+
+    // clear keeps the arena, the columns are written in place again
+    const double* arena = a.GetColumn(Secondaries::X).data();
+    a.clear();
+    EXPECT_EQ(a.GetNumberOfParticles(), 0u);
+
+    for (int i = 0; i < 70; ++i)
+        a.push_back(MakeLoss(i + 1));
+
+    EXPECT_EQ(a.GetColumn(Secondaries::X).data(), arena);
+    EXPECT_EQ(a[69], MakeLoss(70));
+}
+
+TEST(Columns, Query)
+{
+    Secondaries secondaries;
+
+    for (int i = 0; i < 10; ++i)
+    {
+        DynamicData loss = MakeLoss(i);
+        secondaries.push_back(loss);
+        secondaries.emplace_back(static_cast<int>(InteractionType::Epair), loss.GetPosition(),
+            loss.GetDirection(), loss.GetEnergy(), loss.GetParentParticleEnergy(), loss.GetTime(),
+            loss.GetPropagatedDistance());
+    }
+
+    Secondaries epair = secondaries.Query(static_cast<int>(InteractionType::Epair));
+
+    ASSERT_EQ(epair.GetNumberOfParticles(), 10u);
+    for (int i = 0; i < 10; ++i)
+    {
+        EXPECT_EQ(epair[i].GetType(), static_cast<int>(InteractionType::Epair));
+        EXPECT_EQ(epair[i].GetEnergy(), 100. + i);
+    }
+}
+
+TEST(Sink, Function_from_temporary)
+{
+    // The sink copies the function, the lambda is a temporary
+    std::vector<DynamicData> losses;
+    LossFunctionSink sink([&losses](const DynamicData& loss) { losses.push_back(loss); });
+
+    for (int i = 0; i < 10; ++i)
+        sink.push_back(MakeLoss(i));
+
+    ASSERT_EQ(losses.size(), 10u);
+    for (int i = 0; i < 10; ++i)
+        EXPECT_EQ(losses[i], MakeLoss(i));
+}
+
+TEST(Decay, Products_in_place)
+{
+    std::shared_ptr<ParticleDef> mu(new ParticleDef(MuMinusDef::Get()));
+    Secondaries secondaries(mu);
+
+    for (int i = 0; i < 20; ++i)
+    {
+        if (i % 4 == 1)
+        {
+            DynamicData decay = MakeLoss(i);
+            decay.SetType(static_cast<int>(InteractionType::Decay));
+            decay.SetEnergy(1e4 + i);
+            secondaries.push_back(decay);
+        } else
+        {
+            secondaries.push_back(MakeLoss(i));
+        }
+    }
+
+    secondaries.DoDecay();
+
+    // every muon decays into three particles, the other losses keep their order
+    ASSERT_EQ(secondaries.GetNumberOfParticles(), 15u + 3u * 5u);
+
+    unsigned int idx = 0;
+    for (int i = 0; i < 20; ++i)
+    {
+        if (i % 4 == 1)
+        {
+            double energy = 0;
+            for (int j = 0; j < 3; ++j, ++idx)
+            {
+                EXPECT_NE(secondaries[idx].GetType(), static_cast<int>(InteractionType::Decay));
+                EXPECT_EQ(secondaries[idx].GetPosition(), MakeLoss(i).GetPosition());
+                energy += secondaries[idx].GetEnergy();
+            }
+            EXPECT_NEAR(energy, 1e4 + i, 1e-6 * energy);
+        } else
+        {
+            EXPECT_EQ(secondaries[idx++], MakeLoss(i));
+        }
+    }
+
+    // without decays nothing changes
+    Secondaries copy(mu);
+    copy.append(secondaries);
+    secondaries.DoDecay();
+    for (unsigned int i = 0; i < secondaries.GetNumberOfParticles(); ++i)
+        EXPECT_EQ(secondaries[i], copy[i]);
+}
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -1,14 +1,72 @@
 
 #include "gtest/gtest.h"
 #include <algorithm>
+#include <cstdlib>
+#include <new>
 
 #include "PROPOSAL/PROPOSAL.h"
 #include <string>
 using namespace PROPOSAL;
 
+// Count the heap allocations while count_allocations is set. All forms of
+// the global operators are replaced, so every new is paired with a delete
+// of this file. The operators are not inlined, otherwise the compiler sees
+// the memory of a new released by free.
+bool count_allocations = false;
+size_t number_of_allocations = 0;
+
+__attribute__((noinline)) void* CountedAllocate(std::size_t size)
+{
+    if (count_allocations)
+        ++number_of_allocations;
+
+    void* ptr = std::malloc(size ? size : 1);
+    if (ptr == NULL)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+__attribute__((noinline)) void CountedRelease(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void* operator new(std::size_t size) { return CountedAllocate(size); }
+void* operator new[](std::size_t size) { return CountedAllocate(size); }
+void operator delete(void* ptr) noexcept { CountedRelease(ptr); }
+void operator delete[](void* ptr) noexcept { CountedRelease(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { CountedRelease(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { CountedRelease(ptr); }
+
 std::string PATH_TO_TABLES = "~/.local/share/PROPOSAL/tables";
 /* std::string PATH_TO_TABLES = ""; */
 
+// Sector inside the detector, a sphere of 1 km around the origin
+Sector::Definition MakeSectorDefinition(const Medium& medium, ScatteringFactory::Enum scattering)
+{
+    Sector::Definition sector_def;
+    sector_def.location = Sector::ParticleLocation::InsideDetector;
+    sector_def.SetMedium(std::make_shared<Medium>(medium));
+    sector_def.SetGeometry(Sphere(Vector3D(), 1e5, 0).create());
+    sector_def.scattering_model            = scattering;
+    sector_def.cut_settings                = EnergyCutSettings(500, 0.05);
+    sector_def.do_continuous_randomization = true;
+    sector_def.do_exact_time_calculation   = true;
+
+    return sector_def;
+}
+
+// Muon at the origin moving down the z axis
+DynamicData MakeMuon(double energy)
+{
+    DynamicData mu(MuMinusDef::Get().particle_type);
+    mu.SetEnergy(energy);
+    mu.SetPosition(Vector3D(0, 0, 0));
+    mu.SetDirection(Vector3D(0, 0, -1));
+
+    return mu;
+}
+
 ParticleDef getParticleDef(const std::string& name)
 {
     if (name == "MuMinus") {
@@ -367,6 +425,84 @@ TEST(Sector, Propagate)
     }
 }
 
+TEST(Sector, AllocationFree)
+{
+    Sector::Definition sector_def = MakeSectorDefinition(Water(), ScatteringFactory::Moliere);
+    sector_def.do_continuous_energy_loss_output = true;
+
+    InterpolationDef interpolation_def;
+    Sector sector(MuMinusDef::Get(), sector_def, interpolation_def);
+
+    std::vector<Sector::Definition> sec_defs(1, sector_def);
+    Propagator prop(MuMinusDef::Get(), sec_defs, Sphere(Vector3D(), 1e3, 0).create(), interpolation_def);
+
+    DynamicData mu = MakeMuon(1e5);
+
+    Secondaries losses;
+    losses.reserve(100000);
+
+    RandomStream stream(1, 0);
+    RandomStreamScope scope(stream);
+
+    // warm up, so every buffer has reached its final size
+    for (int i = 0; i < 10; ++i) {
+        losses.clear();
+        sector.Propagate(mu, 1e4, 0., losses);
+        losses.clear();
+        prop.Propagate(mu, static_cast<LossSink&>(losses), 1e4);
+    }
+
+    number_of_allocations = 0;
+    count_allocations = true;
+    for (int i = 0; i < 100; ++i) {
+        losses.clear();
+        sector.Propagate(mu, 1e4, 0., losses);
+        losses.clear();
+        prop.Propagate(mu, static_cast<LossSink&>(losses), 1e4);
+    }
+    count_allocations = false;
+
+    EXPECT_EQ(number_of_allocations, 0u);
+    EXPECT_GT(losses.GetNumberOfParticles(), 0u);
+}
+
+TEST(Sector, ParallelTables)
+{
+    Sector::Definition sector_def = MakeSectorDefinition(Ice(), ScatteringFactory::HighlandIntegral);
+
+    InterpolationDef interpolation_def;
+    Sector serial(MuMinusDef::Get(), sector_def, interpolation_def);
+
+    interpolation_def.number_of_threads = 4;
+    Sector parallel(MuMinusDef::Get(), sector_def, interpolation_def);
+
+    EXPECT_TRUE(serial == parallel);
+
+    // The same random numbers give the same losses, if all tables agree
+    DynamicData mu = MakeMuon(0);
+
+    auto propagate = [&mu](Sector& sector) {
+        RandomStream stream(3, 0);
+        RandomStreamScope scope(stream);
+
+        std::vector<double> losses;
+        for (int i = 0; i < 20; ++i)
+        {
+            mu.SetEnergy(std::pow(10., 3 + 0.3 * i));
+            for (auto& loss : sector.Propagate(mu, 1e4, 0.).GetSecondaries())
+            {
+                losses.push_back(loss.GetEnergy());
+                losses.push_back(loss.GetPosition().GetX());
+            }
+        }
+        return losses;
+    };
+
+    std::vector<double> losses = propagate(serial);
+    EXPECT_GT(losses.size(), 0u);
+    EXPECT_TRUE(propagate(parallel) == losses);
+}
+
 int main(int argc, char** argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
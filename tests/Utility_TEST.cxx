@@ -1,8 +1,23 @@
 
 #include "gtest/gtest.h"
 
+#include <cstdio>
+#include <cstdlib>
+#include <dirent.h>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <unistd.h>
+
+#include "PROPOSAL/Constants.h"
+#include "PROPOSAL/math/Integral.h"
+#include "PROPOSAL/math/Interpolant.h"
+#include "PROPOSAL/math/RandomGenerator.h"
 #include "PROPOSAL/medium/Medium.h"
 #include "PROPOSAL/propagation_utility/PropagationUtility.h"
+#include "PROPOSAL/propagation_utility/PropagationUtilityIntegral.h"
+#include "PROPOSAL/propagation_utility/PropagationUtilityInterpolant.h"
+#include "PROPOSAL/methods.h"
 
 using namespace PROPOSAL;
 
@@ -68,6 +83,211 @@ TEST(Copyconstructor, Copyconstructor2) {
     EXPECT_TRUE(C == D);
 }
 
+TEST(UpperLimit, Inverse_Tables) {
+    ParticleDef mu = MuMinusDef::Get();
+    InterpolationDef interpolation_def;
+    Utility utility(mu, std::make_shared<Ice>(), EnergyCutSettings(500, 0.05),
+                    Utility::Definition(), interpolation_def);
+
+    UtilityIntegralDisplacement displacement_integral(utility);
+    UtilityIntegralInteraction interaction_integral(utility);
+    UtilityIntegralDecay decay_integral(utility);
+    UtilityInterpolantDisplacement displacement_interpolant(utility, interpolation_def);
+    UtilityInterpolantInteraction interaction_interpolant(utility, interpolation_def);
+    UtilityInterpolantDecay decay_interpolant(utility, interpolation_def);
+
+    UtilityDecorator* integrals[] = {&displacement_integral, &interaction_integral,
+                                     &decay_integral};
+    UtilityDecorator* interpolants[] = {&displacement_interpolant, &interaction_interpolant,
+                                        &decay_interpolant};
+
+    // The final energy from the inverse tables agrees with the root of
+    // the integral
+    for (int i = 0; i < 3; ++i) {
+        for (double ei : {1e3, 1e5, 1e7, 1e9}) {
+            double total = integrals[i]->Calculate(ei, mu.low, 0.);
+            for (double fraction : {0.1, 0.5, 0.9}) {
+                double rnd = fraction * total;
+
+                integrals[i]->Calculate(ei, mu.low, rnd);
+                double ef_integral = integrals[i]->GetUpperLimit(ei, rnd);
+
+                interpolants[i]->Calculate(ei, mu.low, rnd);
+                double ef_interpolant = interpolants[i]->GetUpperLimit(ei, rnd);
+
+                EXPECT_NEAR(ef_interpolant, ef_integral, 1e-2 * ef_integral);
+                EXPECT_LE(ef_interpolant, ei);
+                EXPECT_GE(ef_interpolant, mu.low);
+            }
+        }
+    }
+}
+
+TEST(Tables, Cumulative_Sweep) {
+    ParticleDef mu = MuMinusDef::Get();
+    InterpolationDef interpolation_def;
+    Utility utility(mu, std::make_shared<Ice>(), EnergyCutSettings(500, 0.05),
+                    Utility::Definition(), interpolation_def);
+
+    UtilityIntegralDisplacement displacement_integral(utility);
+    UtilityIntegralScattering scattering_integral(utility);
+    UtilityInterpolantDisplacement displacement_interpolant(utility, interpolation_def);
+    UtilityInterpolantScattering scattering_interpolant(utility, interpolation_def);
+
+    // The displacement table is accumulated from the lower end of the
+    // energy range, the scattering table from the upper one. At the nodes,
+    // both agree with a precise integration up to the limit.
+    Integral integral(IROMB, IMAXS, 1e-3 * IPREC2);
+    double max = interpolation_def.max_node_energy;
+
+    for (double node : {0.5, 10.5, 100.5, 500.5, 999.5}) {
+        double energy = mu.low * std::pow(max / mu.low, node / interpolation_def.nodes_propagate);
+        double displacement = integral.Integrate(energy, mu.low,
+            [&](double e) { return displacement_integral.FunctionToIntegral(e); }, 4);
+
+        EXPECT_NEAR(displacement_interpolant.GetInterpolant()->Interpolate(energy),
+                    displacement, 1e-5 * std::abs(displacement));
+    }
+
+    for (double node : {0.5, 10.5, 100.5, 199.5}) {
+        double energy = mu.low * std::pow(max / mu.low, node / interpolation_def.nodes_continous_randomization);
+        double scattering = integral.Integrate(energy, max,
+            [&](double e) { return scattering_integral.FunctionToIntegral(e); }, 4);
+
+        EXPECT_NEAR(scattering_interpolant.GetInterpolant()->Interpolate(energy),
+                    scattering, 1e-4 * std::abs(scattering));
+    }
+
+    // The tables do not depend on the number of threads
+    interpolation_def.number_of_threads = 3;
+    UtilityInterpolantDisplacement displacement_threads(utility, interpolation_def);
+    UtilityInterpolantScattering scattering_threads(utility, interpolation_def);
+
+    EXPECT_TRUE(*displacement_interpolant.GetInterpolant() == *displacement_threads.GetInterpolant());
+    EXPECT_TRUE(*scattering_interpolant.GetInterpolant() == *scattering_threads.GetInterpolant());
+}
+
+TEST(Tables, Cache_Files) {
+    ParticleDef mu = MuMinusDef::Get();
+    InterpolationDef interpolation_def;
+    Utility utility(mu, std::make_shared<Ice>(), EnergyCutSettings(500, 0.05),
+                    Utility::Definition(), interpolation_def);
+    UtilityInterpolantDisplacement memory(utility, interpolation_def);
+
+    char directory[] = "/tmp/proposal_tables_XXXXXX";
+    ASSERT_TRUE(mkdtemp(directory) != NULL);
+    interpolation_def.path_to_tables = directory;
+
+    auto read_file = [](const std::string& path) {
+        std::ifstream input(path.c_str(), std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    };
+
+    for (bool binary : {true, false}) {
+        interpolation_def.do_binary_tables = binary;
+        std::string path = std::string(directory) + "/";
+
+        UtilityInterpolantDisplacement written(utility, interpolation_def);
+
+        std::string filename;
+        DIR* dir = opendir(directory);
+        while (dirent* entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            if (name.find("displacement_") == 0 && name.find(binary ? ".tbl" : ".txt") == name.size() - 4) {
+                filename = path + name;
+            }
+        }
+        closedir(dir);
+        ASSERT_FALSE(filename.empty());
+
+        std::string content = read_file(filename);
+
+        // A corrupt file is detected and replaced
+        std::string corrupt = content;
+        corrupt[corrupt.size() / 2] ^= 1;
+        std::ofstream(filename.c_str(), std::ios::binary) << corrupt;
+
+        UtilityInterpolantDisplacement rebuilt(utility, interpolation_def);
+        UtilityInterpolantDisplacement read(utility, interpolation_def);
+
+        EXPECT_EQ(read_file(filename), content);
+
+        // Text tables written before the checksum was introduced are read
+        std::unique_ptr<UtilityInterpolantDisplacement> legacy;
+        if (!binary) {
+            std::string without_checksum = content.substr(0, content.rfind("checksum "));
+            std::ofstream(filename.c_str(), std::ios::binary) << without_checksum;
+
+            legacy.reset(new UtilityInterpolantDisplacement(utility, interpolation_def));
+            EXPECT_EQ(read_file(filename), without_checksum);
+        }
+
+        for (int i = 0; i <= 100; ++i) {
+            double energy = mu.low * std::pow(1e10, i / 100.);
+            double value = memory.GetInterpolant()->Interpolate(energy);
+
+            EXPECT_EQ(written.GetInterpolant()->Interpolate(energy), value);
+            EXPECT_EQ(rebuilt.GetInterpolant()->Interpolate(energy), value);
+            EXPECT_EQ(read.GetInterpolant()->Interpolate(energy), value);
+            if (legacy) {
+                EXPECT_EQ(legacy->GetInterpolant()->Interpolate(energy), value);
+            }
+        }
+    }
+
+    DIR* dir = opendir(directory);
+    while (dirent* entry = readdir(dir)) {
+        std::remove((std::string(directory) + "/" + entry->d_name).c_str());
+    }
+    closedir(dir);
+    rmdir(directory);
+}
+
+TEST(StochasticLoss, Alias_Tables) {
+    ParticleDef mu = MuMinusDef::Get();
+    InterpolationDef interpolation_def;
+    interpolation_def.channel_accuracy = 1e-2;
+    InterpolationDef interpolation_def_exact;
+
+    Utility utility(mu, std::make_shared<Ice>(), EnergyCutSettings(500, 0.05),
+                    Utility::Definition(), interpolation_def);
+    Utility utility_exact(mu, std::make_shared<Ice>(), EnergyCutSettings(500, 0.05),
+                          Utility::Definition(), interpolation_def_exact);
+
+    // The interaction types are chosen with the same frequencies as by
+    // summing up the rates of all cross sections
+    RandomGenerator::Get().SetSeed(1234);
+    int samples = 100000;
+
+    for (double energy : {3e2, 1e3, 1e5, 1e7, 1e9}) {
+        std::map<int, int> counts, counts_exact;
+
+        for (int i = 0; i < samples; ++i) {
+            double rnd1 = RandomGenerator::Get().RandomDouble();
+            double rnd2 = RandomGenerator::Get().RandomDouble();
+            double rnd3 = RandomGenerator::Get().RandomDouble();
+
+            std::pair<double, int> loss = utility.StochasticLoss(energy, rnd1, rnd2, rnd3);
+            EXPECT_GE(loss.first, 0.);
+            EXPECT_LE(loss.first, energy);
+            counts[loss.second]++;
+
+            rnd1 = RandomGenerator::Get().RandomDouble();
+            rnd2 = RandomGenerator::Get().RandomDouble();
+            rnd3 = RandomGenerator::Get().RandomDouble();
+
+            counts_exact[utility_exact.StochasticLoss(energy, rnd1, rnd2, rnd3).second]++;
+        }
+
+        for (const auto& count : counts_exact) {
+            double expected = count.second;
+            EXPECT_NEAR(counts[count.first], expected,
+                        6 * std::sqrt(2 * expected) + interpolation_def.channel_accuracy * expected);
+        }
+        EXPECT_EQ(counts.size(), counts_exact.size());
+    }
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();